@@ -5,55 +5,287 @@ ASMParser::ASMParser(string filename)
   // Specify a text file containing MIPS assembly instructions. Function
   // checks syntactic correctness of file and creates a list of Instructions.
 {
-  Instruction i;
   myFormatCorrect = true;
+  myIndex = 0;
+  myBlockCount = 0;
+
+  // the file is split into chunks of lines parsed on threads of their own.
+  // a file that cannot be opened has no lines
+  readChunks(filename);
+  int count = getChunkCount();
+  myChunks.assign(count, Chunk());
+
+  // first pass: find the labels and count the instructions of each chunk,
+  // then give every label definition the address of the instruction that
+  // follows it, the instructions of the chunks before counted in
+  runChunks(0);
+  int numInstructions = 0;
+  for(int k = 0; k < count; k++){
+    myChunks[k].first = numInstructions;
+    for(int l = 0; l < (int)myChunks[k].labels.size(); l++)
+      myLabels[myChunks[k].labels[l].first] =
+        TextBaseAddress + 4*(numInstructions + myChunks[k].labels[l].second);
+    numInstructions += myChunks[k].count;
+  }
+
+  // labels that are used but never defined are given synthetic
+  // addresses past the end of the program
+  myLabelAddress = TextBaseAddress + 4*numInstructions;
+
+  // second pass: parse each instruction. the instructions are kept up to
+  // the first line that fails, and the synthetic addresses each chunk gave
+  // out from 0 are moved past those of the chunks before
+  runChunks(1);
+  for(int k = 0; k < count; k++){
+    Chunk &chunk = myChunks[k];
+    for(int u = 0; u < (int)chunk.undefined.size(); u++){
+      Instruction &i = chunk.instructions[chunk.undefined[u]];
+      i.setValues(i.getOpcode(), i.getRS(), i.getRT(), i.getRD(),
+                  i.getImmediate() + myLabelAddress);
+      i.setEncoding(encode(i));
+    }
+    myLabelAddress += chunk.undefinedAddress;
+    myInstructions.insert(myInstructions.end(), chunk.instructions.begin(),
+                          chunk.instructions.end());
+    if(chunk.failed){
+      myFormatCorrect = false;
+      break;
+    }
+  }
 
-  myLabelAddress = 0x400000;
+  myChunks.clear();
+  myText.clear();
+}
 
-  ifstream in;
-  in.open(filename.c_str());
-  if(in.bad()){
-    myFormatCorrect = false;
+
+void ASMParser::parseChunk(int k, int pass)
+  // Parses chunk k of the file: the first pass finds its labels and counts
+  // its instructions, and the second, with every label known, parses its
+  // instructions.
+{
+  Chunk &chunk = myChunks[k];
+  size_t pos = myChunkStarts[k];
+  size_t end = myChunkStarts[k+1];
+  string line;
+
+  if(pass == 0){
+    chunk.count = 0;
+    while(getLine(pos, end, line)){
+      string body;
+      string label = getLabel(line, body);
+      if(label.length() != 0)
+        chunk.labels.push_back(make_pair(label, chunk.count));
+      if(label.length() == 0 || !isBlank(body))
+        chunk.count++;
+    }
+    return;
   }
-  else{
-    string line;
-    while( getline(in, line)){
-      string opcode("");
-      string operand[80];
-      int operand_count = 0;
-
-      getTokens(line, opcode, operand, operand_count);
-
-      if(opcode.length() == 0 && operand_count != 0){
-	// No opcode but operands
-	myFormatCorrect = false;
-    break;
-      }
 
-      Opcode o = opcodes.getOpcode(opcode);
+  chunk.undefinedAddress = 0;
+  chunk.failed = false;
+  chunk.instructions.reserve(chunk.count);
+  while(getLine(pos, end, line)){
+    string body;
+    string label = getLabel(line, body);
+    if(label.length() != 0 && isBlank(body))
+      continue;   // a line holding only a label definition
+
+    Instruction i;
+    int pc = TextBaseAddress + 4*(chunk.first + (int)chunk.instructions.size());
+    if(!parseLine(body, i, pc, chunk)){
+      chunk.failed = true;
+      break;
+    }
+    i.setAssembly(line);
+    i.setEncoding(encode(i));
+    chunk.instructions.push_back(i);
+  }
+}
 
-      if(o == UNDEFINED){
-	// invalid opcode specified
-	myFormatCorrect = false;
-	break;
-      }
 
-              bool success = getOperands(i, o, operand, operand_count);
-      if(!success){
-	myFormatCorrect = false;
-	break;
-      }
+bool ASMParser::parseLine(string line, Instruction &i, int pc, Chunk &chunk)
+  // Parses one line of assembly code into i, at address pc, with chunk's
+  // undefined labels.  Returns false if the line is not a valid instruction.
+{
+  string opcode("");
+  string operand[80];
+  int operand_count = 0;
 
-      i.setAssembly(line);
-      string encoding = encode(i);
-      i.setEncoding(encoding);
+  getTokens(line, opcode, operand, operand_count);
 
-      myInstructions.push_back(i);
+  if(opcode.length() == 0 && operand_count != 0){
+    // No opcode but operands
+    return false;
+  }
 
-    }
+  Opcode o = opcodes.getOpcode(opcode);
+
+  if(o == UNDEFINED){
+    // invalid opcode specified
+    return false;
   }
 
+  return getOperands(i, o, operand, operand_count, pc, chunk);
+}
+
+ASMParser::ASMParser()
+  // Creates a parser with no instructions, for encoding instructions that
+  // were built or changed elsewhere.
+{
+  myFormatCorrect = true;
+  myLabelAddress = TextBaseAddress;
   myIndex = 0;
+  myBlockCount = 0;
+}
+
+
+bool ASMParser::parseBlock(const string &text, vector<Instruction> &instructions)
+  // Parses text, whole lines that follow those of the blocks parsed before,
+  // and appends their instructions to instructions.  Returns false at the
+  // first line that is not a supported instruction.  Branches to labels
+  // not defined yet are parsed again by finishBlocks.
+{
+  // the block is parsed as the one chunk of a file of its own, its labels
+  // added to those of the blocks before
+  myText = text;
+  myChunkStarts.assign(1, 0);
+  myChunkStarts.push_back(myText.size());
+  myChunks.assign(1, Chunk());
+  Chunk &chunk = myChunks[0];
+
+  parseChunk(0, 0);
+  chunk.first = myBlockCount;
+  for(int l = 0; l < (int)chunk.labels.size(); l++){
+    myLabels[chunk.labels[l].first] =
+      TextBaseAddress + 4*(myBlockCount + chunk.labels[l].second);
+    myLabelDefinitions[chunk.labels[l].first]++;
+  }
+  myBlockCount += chunk.count;
+
+  // remember every branch or jump to a label, since the label may only be
+  // defined, or defined again, later in the file
+  parseChunk(0, 1);
+  vector<bool> undefined(chunk.instructions.size(), false);
+  for(int u = 0; u < (int)chunk.undefined.size(); u++)
+    undefined[chunk.undefined[u]] = true;
+  for(int k = 0; k < (int)chunk.instructions.size(); k++){
+    if(!opcodes.isIMMLabel(chunk.instructions[k].getOpcode()))
+      continue;
+    LabelUse use;
+    use.line = chunk.instructions[k].getAssembly();
+    use.label = getLabelUse(use.line);
+    if(use.label.length() == 0)
+      continue;
+    use.index = chunk.first + k;
+    use.undefined = undefined[k];
+    myLabelUses.push_back(use);
+  }
+
+  instructions.insert(instructions.end(), chunk.instructions.begin(),
+                      chunk.instructions.end());
+  if(chunk.failed)
+    myFormatCorrect = false;
+
+  myChunks.clear();
+  myText.clear();
+  return myFormatCorrect;
+}
+
+
+void ASMParser::finishBlocks(vector<pair<int, Instruction> > &changed)
+  // Once the last block is parsed, gives the instructions of the blocks
+  // whose labels were not defined when they were parsed, or were defined
+  // again after them, parsed again with the labels of the whole file.
+{
+  // labels never defined get synthetic addresses past the end of the
+  // program, in the order they are used, as when parsing the whole file
+  myLabelAddress = TextBaseAddress + 4*myBlockCount;
+  Chunk chunk;
+  chunk.first = 0;
+  chunk.undefinedAddress = 0;
+  for(int u = 0; u < (int)myLabelUses.size(); u++){
+    LabelUse &use = myLabelUses[u];
+    if(!use.undefined && myLabelDefinitions[use.label] < 2)
+      continue;
+
+    string body;
+    getLabel(use.line, body);
+    Instruction i;
+    int before = chunk.undefined.size();
+    parseLine(body, i, TextBaseAddress + 4*use.index, chunk);
+    if((int)chunk.undefined.size() > before)
+      i.setValues(i.getOpcode(), i.getRS(), i.getRT(), i.getRD(),
+                  i.getImmediate() + myLabelAddress);
+    i.setAssembly(use.line);
+    i.setEncoding(encode(i));
+    changed.push_back(make_pair(use.index, i));
+  }
+  myLabelUses.clear();
+}
+
+
+string ASMParser::getLabelUse(string line)
+  // Returns the label an instruction parsed from line branches or jumps
+  // to, or an empty string if it has none.
+{
+  string body;
+  getLabel(line, body);
+
+  string opcode("");
+  string operand[80];
+  int operand_count = 0;
+  getTokens(body, opcode, operand, operand_count);
+
+  Opcode o = opcodes.getOpcode(opcode);
+  int imm_p = opcodes.IMMposition(o);
+  if(o == UNDEFINED || !opcodes.isIMMLabel(o) || imm_p < 0 || imm_p >= operand_count
+     || isNumberString(operand[imm_p]))
+    return string("");
+  return operand[imm_p];
+}
+
+
+string ASMParser::describeLine(string line, bool &instruction, string &use)
+  // Describes one line of a file: returns the label it defines, or an
+  // empty string, and sets instruction to whether it holds an instruction
+  // and use to the label that instruction branches or jumps to, if any.
+{
+  string body;
+  string label = getLabel(line, body);
+  instruction = (label.length() == 0 || !isBlank(body));
+  use = instruction ? getLabelUse(line) : string("");
+  return label;
+}
+
+
+void ASMParser::setLabels(const map<string, int> &labels)
+  // Sets the labels of the file that parseLineAt parses lines of, each
+  // with the index of the instruction it labels.
+{
+  myLabels.clear();
+  map<string, int>::const_iterator it;
+  for(it = labels.begin(); it != labels.end(); it++)
+    myLabels[it->first] = TextBaseAddress + 4*it->second;
+}
+
+
+bool ASMParser::parseLineAt(string line, int index, Instruction &i)
+  // Parses line into i as the instruction at index index of the file
+  // whose labels were set with setLabels, as parsing the whole file
+  // would.  Returns false if the line is not a supported instruction or
+  // uses a label that is not one of them.
+{
+  // undefined labels get addresses that depend on the whole file
+  string body;
+  getLabel(line, body);
+  Chunk chunk;
+  chunk.first = 0;
+  chunk.undefinedAddress = 0;
+  if(!parseLine(body, i, TextBaseAddress + 4*index, chunk) || !chunk.undefined.empty())
+    return false;
+  i.setAssembly(line);
+  i.setEncoding(encode(i));
+  return true;
 }
 
 
@@ -123,6 +355,8 @@ void ASMParser::getTokens(string line,
       i++;
     }
 
+    // nothing more to split without operands
+    if (numOperands == 0) return;
 
     idx = operand[numOperands-1].find('(');
     string::size_type idx2 = operand[numOperands-1].find(')');
@@ -147,6 +381,50 @@ void ASMParser::getTokens(string line,
     return;
 }
 
+string ASMParser::getLabel(string line, string &body)
+  // If line begins with a label definition such as "loop:", returns the label
+  // name and stores the rest of the line in body. Otherwise, returns an empty
+  // string and stores the whole line in body.
+{
+    body = line;
+
+    // a ':' inside a comment does not define a label
+    string::size_type idx = line.find('#');
+    string::size_type colon = line.find(':');
+    if (colon == string::npos || (idx != string::npos && idx < colon))
+	return string("");
+
+    int p = 0;
+    while (p < (int)colon && isWhitespace(line.at(p)))
+	p++;
+    string label = line.substr(p, colon - p);
+    if (label.length() == 0)
+	return label;
+
+    // a label is a single token starting with a letter or underscore
+    if (!isAlpha(label.at(0)) && label.at(0) != '_')
+	return string("");
+    for (int i = 0; i < (int)label.length(); i++)
+	if (isWhitespace(label.at(i)))
+	    return string("");
+
+    body = line.substr(colon+1);
+    return label;
+}
+
+bool ASMParser::isBlank(string s)
+  // Returns true if s holds nothing but whitespace and comments
+{
+    for (int i = 0; i < (int)s.length(); i++)
+    {
+	if (s.at(i) == '#')
+	    return true;
+	if (!isWhitespace(s.at(i)) && s.at(i) != '\r')
+	    return false;
+    }
+    return true;
+}
+
 bool ASMParser::isNumberString(string s)
   // Returns true if s represents a valid decimal integer
 {
@@ -195,9 +473,12 @@ int ASMParser::cvtNumString2Number(string s)
 
 
 bool ASMParser::getOperands(Instruction &i, Opcode o,
-			    string *operand, int operand_count)
+			    string *operand, int operand_count,
+			    int pc, Chunk &chunk)
   // Given an Opcode, a string representing the operands, and the number of operands,
   // breaks operands apart and stores fields into Instruction.
+  // Branches to labels are relative to pc; undefined labels take addresses
+  // counted in chunk.
 {
 
   if(operand_count != opcodes.numOperands(o))
@@ -241,9 +522,20 @@ bool ASMParser::getOperands(Instruction &i, Opcode o,
     }
     else{
       if(opcodes.isIMMLabel(o)){  // Can the operand be a label?
-	// Assign the immediate field an address
-	imm = myLabelAddress;
-	myLabelAddress += 4;  // increment the label generator
+	map<string, int>::iterator label = myLabels.find(operand[imm_p]);
+	if(label == myLabels.end()){
+	  // Assign the immediate field an address, counted from the start
+	  // of the chunk until the chunks before have been counted
+	  imm = chunk.undefinedAddress;
+	  chunk.undefinedAddress += 4;  // increment the label generator
+	  chunk.undefined.push_back(chunk.instructions.size());
+	}
+	else if(opcodes.getInstType(o) == JTYPE)
+	  imm = label->second;   // jumps hold the target address
+	else{
+	  // branches hold the word offset from the following instruction
+	  imm = (label->second - (pc + 4)) / 4;
+	}
       }
       else  // There is an error
 	return false;
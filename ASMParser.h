@@ -16,6 +16,7 @@ using namespace std;
 #include <stdlib.h>
 #include <bitset>
 #include <stdexcept>
+#include <map>
 
 /* This class reads in a MIPS assembly file and checks its syntax.  If
  * the file is syntactically correct, this class will retain a list
@@ -30,6 +31,10 @@ class ASMParser : public Parser{
   // checks syntactic correctness of file and creates a list of Instructions.
   ASMParser(string filename);
 
+  // Creates a parser with no instructions, for encoding instructions that
+  // were built or changed elsewhere.
+  ASMParser();
+
   // Returns true if the file specified was syntactically correct.  Otherwise,
   // returns false.
   bool isFormatCorrect() { return myFormatCorrect; };
@@ -37,6 +42,39 @@ class ASMParser : public Parser{
   // Iterator that returns the next Instruction in the list of Instructions.
   Instruction getNextInstruction();
 
+  // Returns the address of each label defined in the file
+  map<string, int> getLabels() { return myLabels; };
+
+  // Given a valid instruction, returns a string representing the 32 bit MIPS
+  // binary encoding of that instruction.
+  string encode(Instruction i);
+
+  // Parses text, whole lines that follow those of the blocks parsed before,
+  // and appends their instructions to instructions.  Returns false at the
+  // first line that is not a supported instruction.  Branches to labels
+  // not defined yet are parsed again by finishBlocks.
+  bool parseBlock(const string &text, vector<Instruction> &instructions);
+
+  // Once the last block is parsed, gives the instructions of the blocks
+  // whose labels were not defined when they were parsed, or were defined
+  // again after them, parsed again with the labels of the whole file.
+  void finishBlocks(vector<pair<int, Instruction> > &changed);
+
+  // Describes one line of a file: returns the label it defines, or an
+  // empty string, and sets instruction to whether it holds an instruction
+  // and use to the label that instruction branches or jumps to, if any.
+  string describeLine(string line, bool &instruction, string &use);
+
+  // Sets the labels of the file that parseLineAt parses lines of, each
+  // with the index of the instruction it labels.
+  void setLabels(const map<string, int> &labels);
+
+  // Parses line into i as the instruction at index index of the file
+  // whose labels were set with setLabels, as parsing the whole file
+  // would.  Returns false if the line is not a supported instruction or
+  // uses a label that is not one of them.
+  bool parseLineAt(string line, int index, Instruction &i);
+
  private:
   vector<Instruction> myInstructions;      // list of Instructions
   int myIndex;                             // iterator index
@@ -49,7 +87,57 @@ class ASMParser : public Parser{
 
   RegisterTable registers;                 // encodings for registers
   OpcodeTable opcodes;                     // encodings of opcodes
-  int myLabelAddress;   // Used to assign labels addresses
+  int myLabelAddress;   // Used to assign undefined labels addresses
+  map<string, int> myLabels;               // address of each defined label
+
+  // what parsing a chunk of the file's lines finds: its label definitions,
+  // each with the number of instructions before it in the chunk, and its
+  // number of instructions; then the instructions up to the first line
+  // that fails, if any, and which of them were given addresses for
+  // undefined labels, counted from the start of the chunk
+  struct Chunk{
+    vector<pair<string, int> > labels;
+    int count;
+    int first;             // instructions in the chunks before
+    vector<Instruction> instructions;
+    vector<int> undefined;
+    int undefinedAddress;  // address the chunk's next undefined label gets
+    bool failed;
+  };
+  vector<Chunk> myChunks;
+
+  // when parsing a block at a time: the instructions parsed so far, and
+  // the index, line and label of each that branches or jumps to a label
+  int myBlockCount;
+  struct LabelUse{
+    int index;
+    string line;
+    string label;
+    bool undefined;      // the label was not defined yet
+  };
+  vector<LabelUse> myLabelUses;
+  map<string, int> myLabelDefinitions;   // how often each label is defined
+
+  // Returns the label an instruction parsed from line branches or jumps
+  // to, or an empty string if it has none.
+  string getLabelUse(string line);
+
+  // Parses chunk k of the file: the first pass finds its labels and counts
+  // its instructions, and the second, with every label known, parses its
+  // instructions.
+  void parseChunk(int k, int pass);
+
+  // Parses one line of assembly code into i, at address pc, with chunk's
+  // undefined labels.  Returns false if the line is not a valid instruction.
+  bool parseLine(string line, Instruction &i, int pc, Chunk &chunk);
+
+  // If line begins with a label definition such as "loop:", returns the label
+  // name and stores the rest of the line in body. Otherwise, returns an empty
+  // string and stores the whole line in body.
+  string getLabel(string line, string &body);
+
+  // Returns true if s holds nothing but whitespace and comments
+  bool isBlank(string s);
 
   // Decomposes a line of assembly code into strings for the opcode field and operands,
   // checking for syntax errors and counting the number of operands.
@@ -57,7 +145,10 @@ class ASMParser : public Parser{
 
   // Given an Opcode, a string representing the operands, and the number of operands,
   // breaks operands apart and stores fields into Instruction.
-  bool getOperands(Instruction &i, Opcode o, string *operand, int operand_count);
+  // Branches to labels are relative to pc; undefined labels take addresses
+  // counted in chunk.
+  bool getOperands(Instruction &i, Opcode o, string *operand, int operand_count,
+                   int pc, Chunk &chunk);
 
 
   // Returns true if character is white space
@@ -84,11 +175,6 @@ class ASMParser : public Parser{
   // Converts a string to an integer.  Assumes s is something like "-231" and produces -231
   int  cvtNumString2Number(string s);
 
-
-  // Given a valid instruction, returns a string representing the 32 bit MIPS binary encoding
-  // of that instruction.
-  string encode(Instruction i);
-
   // Given a number and width, returns a width-wide binary representation of that number
   // e.g., if width is 8, it would return an 8-bit binary representation
   string convertToBinary(int number, int width);
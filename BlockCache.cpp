@@ -0,0 +1,122 @@
+// aalok sathe
+#include "BlockCache.h"
+
+BlockCache::BlockCache(int capacity)
+/* Creates an empty cache holding at most capacity blocks */
+{
+    myCapacity = capacity > 0 ? capacity : 1;
+    myHits = myMisses = myBytes = 0;
+}
+
+
+const BlockTiming *BlockCache::find(const vector<int> &key)
+/* Returns the timing stored for key, or NULL if there is none. A block
+ * that is found becomes the most recently used.
+ */
+{
+    map<vector<int>, Blocks::iterator>::iterator found = myIndex.find(key);
+    if (found == myIndex.end())
+    {
+        myMisses++;
+        return NULL;
+    }
+
+    myHits++;
+    myBlocks.splice(myBlocks.begin(), myBlocks, found->second);
+    return &found->second->second;
+}
+
+
+void BlockCache::insert(const vector<int> &key, const BlockTiming &timing)
+/* Stores timing for key, forgetting the least recently used block if the
+ * cache is full.
+ */
+{
+    if (myIndex.find(key) != myIndex.end())
+        return;
+
+    if (myIndex.size() >= myCapacity)
+    {
+        Blocks::iterator last = --myBlocks.end();
+        myBytes -= getSize(last->first, last->second);
+        myIndex.erase(last->first);
+        myBlocks.erase(last);
+    }
+
+    myBlocks.push_front(make_pair(key, timing));
+    myIndex.insert(make_pair(key, myBlocks.begin()));
+    myBytes += getSize(key, timing);
+}
+
+
+void BlockCache::printStatistics()
+/* Prints the hits, misses and hit rate, and how many blocks are held in
+ * about how much memory.
+ */
+{
+    long accesses = myHits + myMisses;
+    cout << "Block cache: " << myHits << " hits, " << myMisses << " misses, hit rate "
+         << (accesses ? 100.0 * myHits / accesses : 0) << "%, "
+         << myIndex.size() << " blocks in about " << (myBytes + 1023) / 1024
+         << " KB" << endl;
+}
+
+
+void BlockCache::save(Checkpoint &checkpoint)
+/* Appends the blocks, least recently used last, and the hits and misses
+ * to checkpoint.
+ */
+{
+    checkpoint.putInt(myHits);
+    checkpoint.putInt(myMisses);
+    checkpoint.putInt(myBlocks.size());
+    for (Blocks::iterator it = myBlocks.begin(); it != myBlocks.end(); it++)
+    {
+        const BlockTiming &timing = it->second;
+        checkpoint.putInts(it->first);
+        checkpoint.putInt(timing.length);
+        checkpoint.putInt(timing.ticks);
+        checkpoint.putInts(timing.completions, true);
+        checkpoint.putInts(timing.records);
+        checkpoint.putInts(timing.exitState);
+    }
+}
+
+
+bool BlockCache::load(Checkpoint &checkpoint)
+/* Replaces the blocks, hits and misses with what save appended. Returns
+ * false if the checkpoint is damaged.
+ */
+{
+    myBlocks.clear();
+    myIndex.clear();
+    myBytes = 0;
+    myHits = checkpoint.getInt();
+    myMisses = checkpoint.getInt();
+
+    // inserting least recently used first puts them back in order
+    vector<pair<vector<int>, BlockTiming> > blocks(max((int64_t)0, checkpoint.getInt()));
+    for (unsigned int k = 0; k < blocks.size() and checkpoint.isValid(); k++)
+    {
+        BlockTiming &timing = blocks[k].second;
+        checkpoint.getInts(blocks[k].first);
+        timing.length = checkpoint.getInt();
+        timing.ticks = checkpoint.getInt();
+        checkpoint.getInts(timing.completions, true);
+        checkpoint.getInts(timing.records);
+        checkpoint.getInts(timing.exitState);
+    }
+    for (int k = blocks.size() - 1; k >= 0; k--)
+        insert(blocks[k].first, blocks[k].second);
+    return checkpoint.isValid();
+}
+
+
+long BlockCache::getSize(const vector<int> &key, const BlockTiming &timing)
+/* Returns the bytes held by key and timing */
+{
+    // the key is held twice, in the list and in the index
+    long ints = 2*key.size() + timing.completions.size() + timing.records.size()
+                + timing.exitState.size();
+    return ints * sizeof(int) + sizeof(BlockTiming) + 2*sizeof(vector<int>);
+}
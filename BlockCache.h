@@ -0,0 +1,88 @@
+// aalok sathe
+#ifndef _BLOCK_CACHE_H_
+#define _BLOCK_CACHE_H_
+
+using namespace std;
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <map>
+#include "Checkpoint.h"
+
+
+/* What simulating a basic block from one pipeline state did: how many
+ * instructions the block has, how many clock ticks it took, when each of
+ * its instructions completed and what was recorded for it, and the state
+ * of the pipeline when the block was over.
+ */
+struct BlockTiming
+{
+    int length;                 // instructions in the block
+    int ticks;                  // clock ticks from entering to leaving it
+    vector<int> completions;    // completion time of each instruction,
+                                // counted from entering the block
+    vector<int> records;        // what the model recorded for each one
+    vector<int> exitState;      // the state the block left the pipeline in
+};
+
+
+/* This class remembers the timing of basic blocks, keyed on everything
+ * that decides it: the state of the pipeline when the block is entered and
+ * the instructions that come into the pipeline until it is left. It holds
+ * at most a fixed number of blocks; when it is full, the block used least
+ * recently is forgotten.
+ */
+class BlockCache{
+
+ public:
+
+  /* Creates an empty cache holding at most capacity blocks */
+  BlockCache(int capacity);
+
+  /* Returns the timing stored for key, or NULL if there is none. A block
+   * that is found becomes the most recently used.
+   */
+  const BlockTiming *find(const vector<int> &key);
+
+  /* Stores timing for key, forgetting the least recently used block if the
+   * cache is full.
+   */
+  void insert(const vector<int> &key, const BlockTiming &timing);
+
+  /* Prints the hits, misses and hit rate, and how many blocks are held in
+   * about how much memory.
+   */
+  void printStatistics();
+
+  /* Appends the blocks, least recently used last, and the hits and misses
+   * to checkpoint.
+   */
+  void save(Checkpoint &checkpoint);
+
+  /* Replaces the blocks, hits and misses with what save appended. Returns
+   * false if the checkpoint is damaged.
+   */
+  bool load(Checkpoint &checkpoint);
+
+
+ private:
+
+  // the blocks, most recently used first, and where each key's block is
+  typedef list<pair<vector<int>, BlockTiming> > Blocks;
+  Blocks myBlocks;
+  map<vector<int>, Blocks::iterator> myIndex;
+
+  unsigned int myCapacity;
+  long myHits;
+  long myMisses;
+
+  // bytes held by the keys and timings of the blocks in the cache
+  long myBytes;
+
+  /* Returns the bytes held by key and timing */
+  long getSize(const vector<int> &key, const BlockTiming &timing);
+
+};
+
+#endif
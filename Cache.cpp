@@ -0,0 +1,169 @@
+// aalok sathe
+#include "Cache.h"
+
+const unsigned int Cache::INVALID_TAG;
+
+Cache::Cache(int size, int lineSize, int ways, ReplacementPolicy policy)
+/* Creates an empty cache of size bytes made of lineSize-byte lines, with
+ * ways lines per set, replacing lines according to policy.
+ */
+{
+    myLineSize = lineSize > 0 ? lineSize : 4;
+    myWays = ways > 0 ? ways : 1;
+    mySets = size / (myLineSize * myWays);
+    if (mySets < 1)
+        mySets = 1;
+
+    myPolicy = canReplace(myWays, policy) ? policy : LRU;
+
+    myTags.assign(mySets * myWays, INVALID_TAG);
+    myLastUse.assign(mySets * myWays, 0);
+    myTreeBits.assign(mySets, 0);
+    myClock = 0;
+
+    myHits = myMisses = 0;
+}
+
+
+bool Cache::canReplace(int ways, ReplacementPolicy policy)
+/* Returns whether a set of ways lines can be replaced by policy:
+ * pseudo-LRU needs a power of two ways, at most 64. A cache made with
+ * ways policy cannot handle uses LRU.
+ */
+{
+    // pseudo-LRU needs a full binary tree over the ways, with a bit of
+    // one word per node
+    if (policy == PLRU)
+        return ways >= 1 and ways <= 64 and (ways & (ways - 1)) == 0;
+    return true;
+}
+
+
+bool Cache::access(unsigned int addr)
+/* Looks up the line holding address addr. Returns true on a hit. On a
+ * miss, the line is brought in, replacing a line of its set if needed.
+ */
+{
+    unsigned int line = addr / myLineSize;
+    int set = line % mySets;
+    unsigned int tag = line / mySets;
+
+    unsigned int *tags = &myTags[set * myWays];
+    for (int w = 0; w < myWays; w++)
+    {
+        if (tags[w] == tag)
+        {
+            myHits++;
+            touch(set, w);
+            return true;
+        }
+    }
+
+    myMisses++;
+    int victim = getVictim(set);
+    tags[victim] = tag;
+    touch(set, victim);
+    return false;
+}
+
+
+void Cache::touch(int set, int way)
+/* Marks way of set as the most recently used */
+{
+    if (myPolicy == LRU)
+    {
+        myLastUse[set * myWays + way] = ++myClock;
+        return;
+    }
+
+    // walk from the root to the leaf of way, pointing every node on the
+    // path away from it. node k has children 2k+1 and 2k+2
+    uint64_t &bits = myTreeBits[set];
+    int node = 0;
+    for (int half = myWays / 2; half >= 1; half /= 2)
+    {
+        bool right = (way & half) != 0;
+        if (right)
+            bits &= ~((uint64_t)1 << node);   // replace on the left next
+        else
+            bits |= (uint64_t)1 << node;      // replace on the right next
+        node = 2*node + (right ? 2 : 1);
+    }
+}
+
+
+int Cache::getVictim(int set)
+/* Returns the way of set to replace */
+{
+    // an empty way is always used first
+    unsigned int *tags = &myTags[set * myWays];
+    for (int w = 0; w < myWays; w++)
+        if (tags[w] == INVALID_TAG)
+            return w;
+
+    if (myPolicy == LRU)
+    {
+        uint64_t *lastUse = &myLastUse[set * myWays];
+        int victim = 0;
+        for (int w = 1; w < myWays; w++)
+            if (lastUse[w] < lastUse[victim])
+                victim = w;
+        return victim;
+    }
+
+    // follow the tree bits from the root down to a leaf
+    uint64_t bits = myTreeBits[set];
+    int node = 0, way = 0;
+    for (int half = myWays / 2; half >= 1; half /= 2)
+    {
+        bool right = (bits >> node) & 1;
+        if (right)
+            way += half;
+        node = 2*node + (right ? 2 : 1);
+    }
+    return way;
+}
+
+
+void Cache::save(Checkpoint &checkpoint)
+/* Appends the lines present, their replacement state and the hits and
+ * misses to checkpoint.
+ */
+{
+    checkpoint.putInt(myTags.size());
+    for (unsigned int k = 0; k < myTags.size(); k++)
+        checkpoint.putInt(myTags[k] == INVALID_TAG ? -1 : (int64_t)myTags[k]);
+    for (unsigned int k = 0; k < myLastUse.size(); k++)
+        checkpoint.putInt((int64_t)myLastUse[k]);
+    checkpoint.putInt((int64_t)myClock);
+    checkpoint.putInt(myTreeBits.size());
+    for (unsigned int k = 0; k < myTreeBits.size(); k++)
+        checkpoint.putInt(myTreeBits[k]);
+    checkpoint.putInt(myHits);
+    checkpoint.putInt(myMisses);
+}
+
+
+bool Cache::load(Checkpoint &checkpoint)
+/* Reads back what save appended, into a cache of the same shape.
+ * Returns false if the shape differs.
+ */
+{
+    if (checkpoint.getInt() != (int64_t)myTags.size())
+        return false;
+    for (unsigned int k = 0; k < myTags.size(); k++)
+    {
+        int64_t tag = checkpoint.getInt();
+        myTags[k] = (tag < 0) ? INVALID_TAG : tag;
+    }
+    for (unsigned int k = 0; k < myLastUse.size(); k++)
+        myLastUse[k] = (uint64_t)checkpoint.getInt();
+    myClock = (uint64_t)checkpoint.getInt();
+    if (checkpoint.getInt() != (int64_t)myTreeBits.size())
+        return false;
+    for (unsigned int k = 0; k < myTreeBits.size(); k++)
+        myTreeBits[k] = checkpoint.getInt();
+    myHits = checkpoint.getInt();
+    myMisses = checkpoint.getInt();
+    return checkpoint.isValid();
+}
@@ -0,0 +1,93 @@
+// aalok sathe
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+using namespace std;
+
+#include <vector>
+#include <stdint.h>
+#include "Checkpoint.h"
+
+
+// The ways a cache can choose which line of a set to replace
+enum ReplacementPolicy{
+    LRU,    // least recently used
+    PLRU    // tree pseudo-LRU; needs a power of two ways
+};
+
+
+/* This class models one level of a set-associative cache. It only keeps
+ * track of which lines are present, not of their data, so that it can tell
+ * whether an access hits or misses. All lines of all sets are kept in flat
+ * arrays, one entry per way, so a lookup touches a single run of memory.
+ */
+class Cache{
+
+ public:
+
+  /* Creates an empty cache of size bytes made of lineSize-byte lines, with
+   * ways lines per set, replacing lines according to policy.
+   */
+  Cache(int size, int lineSize, int ways, ReplacementPolicy policy);
+
+  /* Looks up the line holding address addr. Returns true on a hit. On a
+   * miss, the line is brought in, replacing a line of its set if needed.
+   */
+  bool access(unsigned int addr);
+
+  /* Returns whether a set of ways lines can be replaced by policy:
+   * pseudo-LRU needs a power of two ways, at most 64. A cache made with
+   * ways policy cannot handle uses LRU.
+   */
+  static bool canReplace(int ways, ReplacementPolicy policy);
+
+  /* Returns the number of accesses that hit */
+  long getHits() { return myHits; };
+
+  /* Returns the number of accesses that missed */
+  long getMisses() { return myMisses; };
+
+  /* Appends the lines present, their replacement state and the hits and
+   * misses to checkpoint.
+   */
+  void save(Checkpoint &checkpoint);
+
+  /* Reads back what save appended, into a cache of the same shape.
+   * Returns false if the shape differs.
+   */
+  bool load(Checkpoint &checkpoint);
+
+
+ private:
+
+  int mySets;
+  int myWays;
+  int myLineSize;
+  ReplacementPolicy myPolicy;
+
+  // tag of the line in each way of each set, at [set*myWays + way]. a way
+  // holding no line has the tag INVALID_TAG
+  static const unsigned int INVALID_TAG = 0xFFFFFFFF;
+  vector<unsigned int> myTags;
+
+  // LRU: the access count at which each way was last used. the count is
+  // 64 bits wide, since a long run makes more than 2^32 accesses
+  vector<uint64_t> myLastUse;
+  uint64_t myClock;
+
+  // PLRU: one bit per internal node of a binary tree over the ways of a set,
+  // pointing towards the half to replace next
+  vector<uint64_t> myTreeBits;
+
+  long myHits;
+  long myMisses;
+
+  /* Marks way of set as the most recently used */
+  void touch(int set, int way);
+
+  /* Returns the way of set to replace */
+  int getVictim(int set);
+
+};
+
+#endif
@@ -0,0 +1,283 @@
+// aalok sathe
+#include "Checkpoint.h"
+#include <cstdio>
+
+Checkpoint::Checkpoint()
+/* Creates an empty checkpoint to put state into */
+{
+    myPosition = 0;
+    myValid = true;
+}
+
+
+void Checkpoint::putInt(int64_t value)
+/* Appends value */
+{
+    // fold the sign into the lowest bit, so small negative values are short
+    uint64_t bits = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    while (bits >= 0x80)
+    {
+        myData.push_back((unsigned char)(bits | 0x80));
+        bits >>= 7;
+    }
+    myData.push_back((unsigned char)bits);
+}
+
+
+void Checkpoint::putInts(const vector<int> &values, bool delta)
+/* Appends the size of values, then each value, or with delta each
+ * value's difference from the one before it.
+ */
+{
+    putInt(values.size());
+    int previous = 0;
+    for (unsigned int k = 0; k < values.size(); k++)
+    {
+        putInt(delta ? (int64_t)values[k] - previous : values[k]);
+        previous = values[k];
+    }
+}
+
+
+void Checkpoint::putString(const string &text)
+/* Appends the size of text, then its characters */
+{
+    putInt(text.size());
+    myData.insert(myData.end(), text.begin(), text.end());
+}
+
+
+void Checkpoint::putWord(uint32_t word)
+/* Appends word as four bytes, lowest first, for values that are seldom
+ * small, like instruction encodings.
+ */
+{
+    for (int b = 0; b < 4; b++)
+        myData.push_back((unsigned char)(word >> (8*b)));
+}
+
+
+int64_t Checkpoint::getInt()
+/* Returns the next value, as put by putInt. Reading past the end returns
+ * 0 and makes the checkpoint invalid.
+ */
+{
+    uint64_t bits = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (myPosition >= myData.size())
+        {
+            myValid = false;
+            return 0;
+        }
+        unsigned char byte = myData[myPosition++];
+        bits |= (uint64_t)(byte & 0x7F) << shift;
+        if (not (byte & 0x80))
+            break;
+    }
+    return (int64_t)(bits >> 1) ^ -(int64_t)(bits & 1);
+}
+
+
+void Checkpoint::getInts(vector<int> &values, bool delta)
+/* Reads values as put by putInts */
+{
+    int64_t size = getInt();
+    values.clear();
+    if (size < 0 or size > (int64_t)(myData.size() - myPosition))
+    {
+        myValid = false;
+        return;
+    }
+    values.reserve(size);
+    int previous = 0;
+    for (int64_t k = 0; k < size; k++)
+    {
+        previous = (delta ? previous : 0) + getInt();
+        values.push_back(previous);
+    }
+}
+
+
+string Checkpoint::getString()
+/* Returns the next text, as put by putString */
+{
+    int64_t size = getInt();
+    if (size < 0 or size > (int64_t)(myData.size() - myPosition))
+    {
+        myValid = false;
+        return "";
+    }
+    string text(myData.begin() + myPosition, myData.begin() + myPosition + size);
+    myPosition += size;
+    return text;
+}
+
+
+uint32_t Checkpoint::getWord()
+/* Returns the next word, as put by putWord */
+{
+    if (myPosition > myData.size() or myData.size() - myPosition < 4)
+    {
+        myValid = false;
+        myPosition = myData.size();
+        return 0;
+    }
+    uint32_t word = 0;
+    for (int b = 0; b < 4; b++)
+        word |= (uint32_t)myData[myPosition++] << (8*b);
+    return word;
+}
+
+
+bool Checkpoint::read(string file)
+/* Replaces the contents with those of file and checks its checksum.
+ * Returns false if the file cannot be read or is damaged.
+ */
+{
+    vector<unsigned char> data;
+    FILE *in = fopen(file.c_str(), "rb");
+    if (in == NULL)
+    {
+        myData.clear();
+        myPosition = 0;
+        myValid = false;
+        return false;
+    }
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        data.insert(data.end(), buffer, buffer + got);
+    fclose(in);
+
+    return load(data, 0, data.size());
+}
+
+
+bool Checkpoint::load(const vector<unsigned char> &data, size_t start, size_t length)
+/* Replaces the contents with the length bytes of data from start, a
+ * sealed checkpoint, and checks its checksum. Returns false if they are
+ * damaged.
+ */
+{
+    myData.clear();
+    myPosition = 0;
+    myValid = false;
+
+    // the last eight bytes are the checksum of the ones before
+    if (length < 8 or start > data.size() or length > data.size() - start)
+        return false;
+    myData.assign(data.begin() + start, data.begin() + start + length);
+    unsigned int body = length - 8;
+    uint64_t stored = 0;
+    for (int b = 0; b < 8; b++)
+        stored |= (uint64_t)myData[body + b] << (8*b);
+    if (stored != getChecksum(myData, body))
+    {
+        myData.clear();
+        return false;
+    }
+
+    myData.resize(body);
+    myValid = true;
+    return true;
+}
+
+
+void Checkpoint::seal(vector<unsigned char> &data)
+/* Appends the checksum and swaps the bytes into data, leaving the
+ * checkpoint empty.
+ */
+{
+    uint64_t sum = getChecksum(myData, myData.size());
+    for (int b = 0; b < 8; b++)
+        myData.push_back((unsigned char)(sum >> (8*b)));
+
+    data.swap(myData);
+    myData.clear();
+    myPosition = 0;
+    myValid = true;
+}
+
+
+uint64_t Checkpoint::getChecksum(const vector<unsigned char> &data,
+                                 unsigned int length)
+/* Returns the FNV-1a hash of the first length bytes of data */
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned int k = 0; k < length; k++)
+    {
+        hash ^= data[k];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+CheckpointWriter::CheckpointWriter()
+/* Creates a writer with no write in progress */
+{
+    myRunning = false;
+    myFailed = false;
+}
+
+
+CheckpointWriter::~CheckpointWriter()
+/* Waits for the write in progress, if any */
+{
+    wait();
+}
+
+
+void CheckpointWriter::write(string file, Checkpoint &checkpoint)
+/* Seals checkpoint and starts writing it to file, leaving checkpoint
+ * empty. Waits first for the previous write, which is only still going
+ * if checkpoints are taken faster than they can be written.
+ */
+{
+    wait();
+    myFile = file;
+    checkpoint.seal(myData);
+
+    // without a thread, write it right away
+    if (pthread_create(&myThread, NULL, run, this) == 0)
+        myRunning = true;
+    else
+        run(this);
+}
+
+
+bool CheckpointWriter::wait()
+/* Waits for the write in progress, if any. Returns false if any write
+ * so far failed.
+ */
+{
+    if (myRunning)
+        pthread_join(myThread, NULL);
+    myRunning = false;
+    return not myFailed;
+}
+
+
+void *CheckpointWriter::run(void *writer)
+/* The body of the writing thread; writer is the CheckpointWriter */
+{
+    CheckpointWriter *self = (CheckpointWriter *)writer;
+    string temporary = self->myFile + ".tmp";
+
+    FILE *out = fopen(temporary.c_str(), "wb");
+    bool written = (out != NULL);
+    if (out != NULL)
+    {
+        if (not self->myData.empty())
+            written = (fwrite(&self->myData[0], 1, self->myData.size(), out)
+                       == self->myData.size());
+        written = (fclose(out) == 0) and written;
+    }
+    if (written)
+        written = (rename(temporary.c_str(), self->myFile.c_str()) == 0);
+
+    if (not written)
+        self->myFailed = true;
+    return NULL;
+}
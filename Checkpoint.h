@@ -0,0 +1,135 @@
+// aalok sathe
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+
+
+/* This class holds the state of a simulation as a compact run of bytes, to
+ * be written to a file and read back to resume exactly where it was taken.
+ * Numbers are stored as variable-length integers, seven bits to a byte with
+ * the sign folded into the lowest bit, so the small numbers that make up
+ * most of the state take one byte; vectors that only grow, like completion
+ * times, can store the differences between entries instead. A checksum at
+ * the end of the file catches files that were cut short or damaged.
+ */
+class Checkpoint{
+
+ public:
+
+  /* Creates an empty checkpoint to put state into */
+  Checkpoint();
+
+  /* Appends value */
+  void putInt(int64_t value);
+
+  /* Appends the size of values, then each value, or with delta each
+   * value's difference from the one before it.
+   */
+  void putInts(const vector<int> &values, bool delta = false);
+
+  /* Appends the size of text, then its characters */
+  void putString(const string &text);
+
+  /* Appends word as four bytes, lowest first, for values that are seldom
+   * small, like instruction encodings.
+   */
+  void putWord(uint32_t word);
+
+  /* Returns the next value, as put by putInt. Reading past the end returns
+   * 0 and makes the checkpoint invalid.
+   */
+  int64_t getInt();
+
+  /* Reads values as put by putInts */
+  void getInts(vector<int> &values, bool delta = false);
+
+  /* Returns the next text, as put by putString */
+  string getString();
+
+  /* Returns the next word, as put by putWord */
+  uint32_t getWord();
+
+  /* Returns true once every value has been read */
+  bool isAtEnd() { return myPosition >= myData.size(); };
+
+  /* Returns false if anything was read past the end */
+  bool isValid() { return myValid; };
+
+  /* Replaces the contents with those of file and checks its checksum.
+   * Returns false if the file cannot be read or is damaged.
+   */
+  bool read(string file);
+
+  /* Replaces the contents with the length bytes of data from start, a
+   * sealed checkpoint, and checks its checksum. Returns false if they are
+   * damaged.
+   */
+  bool load(const vector<unsigned char> &data, size_t start, size_t length);
+
+  /* Appends the checksum and swaps the bytes into data, leaving the
+   * checkpoint empty.
+   */
+  void seal(vector<unsigned char> &data);
+
+  /* Returns the FNV-1a hash of the first length bytes of data */
+  static uint64_t getChecksum(const vector<unsigned char> &data, unsigned int length);
+
+
+ private:
+
+  vector<unsigned char> myData;
+  unsigned int myPosition;
+  bool myValid;
+
+};
+
+
+/* This class writes checkpoints to files on a thread of its own, so that
+ * the simulation goes on while they are written. A file is first written
+ * under a temporary name and then renamed, so that a crash while writing
+ * leaves the previous checkpoint in place.
+ */
+class CheckpointWriter{
+
+ public:
+
+  /* Creates a writer with no write in progress */
+  CheckpointWriter();
+
+  /* Waits for the write in progress, if any */
+  ~CheckpointWriter();
+
+  /* Seals checkpoint and starts writing it to file, leaving checkpoint
+   * empty. Waits first for the previous write, which is only still going
+   * if checkpoints are taken faster than they can be written.
+   */
+  void write(string file, Checkpoint &checkpoint);
+
+  /* Waits for the write in progress, if any. Returns false if any write
+   * so far failed.
+   */
+  bool wait();
+
+
+ private:
+
+  /* The body of the writing thread; writer is the CheckpointWriter */
+  static void *run(void *writer);
+
+  pthread_t myThread;
+  bool myRunning;
+  bool myFailed;
+
+  // the file being written and its contents
+  string myFile;
+  vector<unsigned char> myData;
+
+};
+
+#endif
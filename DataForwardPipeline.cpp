@@ -1,13 +1,37 @@
 // aalok sathe
 #include "DataForwardPipeline.h"
 
-DataForwardPipeline::DataForwardPipeline(string inputFile)
-: Pipeline(inputFile) 
+DataForwardPipeline::DataForwardPipeline(string inputFile, SimOptions options)
+: Pipeline(inputFile, options) 
 /* Default constructor for the DataForwardPipeline class.
  * Uses the inherited constructor, and only sets the header title
  * to something else. Additionally initializes appropriate ValueSchedule
  * items into a map according to the pipeline model.
  */
+{
+    initializeModel();
+}
+
+
+DataForwardPipeline::DataForwardPipeline(const vector<Instruction> &program, SimOptions options)
+: Pipeline(program, options)
+/* Constructs the model with program, instructions already parsed, as
+ * Pipeline does.
+ */
+{
+    initializeModel();
+}
+
+
+DataForwardPipeline::DataForwardPipeline(DataForwardPipeline *whole, int first)
+: Pipeline(whole, first)
+/* Constructs a part of whole, as Pipeline does */
+{
+    initializeModel();
+}
+
+void DataForwardPipeline::initializeModel()
+/* Sets up what this model adds to Pipeline, for the constructors */
 {
     myOutput.myPipelineType = "FORWARDING";
    
@@ -51,8 +75,7 @@ bool DataForwardPipeline::checkControlDelay(int i)
 {
     if (i > 0)
     {
-        Instruction prevInst = myInstructions.at(i-1);
-        InstFunc prevFunc = myOpcodes.getInstFunc(prevInst.getOpcode());
+        InstFunc prevFunc = myOpcodes.getInstFunc(getOpcode(i-1));
         if (prevFunc == CONTROL_I and myPipeline[i-1] == DECODE+1)
             return true;
     }
@@ -68,18 +91,16 @@ bool DataForwardPipeline::checkStallDelay(int i)
  */
 {
     // get the current instruction, its function, and when its data is needed
-    Instruction curInst = myInstructions.at(i);
-    InstFunc curFunc = myOpcodes.getInstFunc(curInst.getOpcode());
+    InstFunc curFunc = myOpcodes.getInstFunc(getOpcode(i));
     PipelineStages reqd = myDataSchedule[curFunc].required;
 
 
     // see if there's any RAW dependency of this instruction on a prior instruction
     // and if so, check for potential data hazard stalls required. 
-    int prev = myDependencyChecker.getPrevDep(i, RAW);
+    int prev = getProducer(i);
     if (prev>=0 and myPipeline[i]+1 == reqd)
     {
-        Instruction depInst = myInstructions.at(prev);
-        InstFunc depFunc = myOpcodes.getInstFunc(depInst.getOpcode());
+        InstFunc depFunc = myOpcodes.getInstFunc(getOpcode(prev));
         PipelineStages prod = myDataSchedule[depFunc].produced;
 
         // no delay if value is needed after it is produced
@@ -29,12 +29,35 @@ class DataForwardPipeline: public Pipeline{
    * the name of a MIPS machine instruction file.  If the input file is
    * not a valid input file (due to syntactical errors or unsupported
    * instructions being specified), the format is considered incorrect.
+   * options are passed on to the Pipeline constructor.
    */
-  DataForwardPipeline(string inputFile);
+  DataForwardPipeline(string inputFile, SimOptions options = SimOptions());
+
+  /* Constructs the model with program, instructions already parsed, as
+   * Pipeline does.
+   */
+  DataForwardPipeline(const vector<Instruction> &program, SimOptions options = SimOptions());
+
+  /* Returns a part of this model, as Pipeline::makePart does */
+  Pipeline *makePart(int first) { return new DataForwardPipeline(this, first); };
+
+  /* Returns the number of clock ticks the instruction after a control
+   * instruction is held back by: one, as checkControlDelay stalls it once.
+   */
+  int getControlDelay() { return 1; };
+
+
+ protected:
+
+ /* Constructs a part of whole, as Pipeline does */
+  DataForwardPipeline(DataForwardPipeline *whole, int first);
 
 
  private:
 
+ /* Sets up what this model adds to Pipeline, for the constructors */
+  void initializeModel();
+
  /* Although Pipeline::checkHazards is virtual, reuse it here since no
   * modiciation is necessary for this pipeline model
   */
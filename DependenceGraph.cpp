@@ -0,0 +1,72 @@
+// aalok sathe
+#include "DependenceGraph.h"
+#include <algorithm>
+
+DependenceGraph::DependenceGraph(int numNodes, const vector<Dependence> &deps,
+                                 const vector<int> &weights)
+/* Builds the graph of numNodes instructions from deps, giving the edge
+ * of deps[d] the weight weights[d].
+ */
+{
+    // count the edges leaving each node, and turn the counts into the
+    // offset each node's edges start at
+    myOffsets.assign(numNodes + 1, 0);
+    for (unsigned int d = 0; d < deps.size(); d++)
+        myOffsets[deps[d].previousInstructionNumber + 1]++;
+    for (int i = 0; i < numNodes; i++)
+        myOffsets[i+1] += myOffsets[i];
+
+    // place each edge in the next free slot of its node
+    myTargets.resize(deps.size());
+    myWeights.resize(deps.size());
+    myTypes.resize(deps.size());
+    vector<int> next(myOffsets.begin(), myOffsets.end() - 1);
+    for (unsigned int d = 0; d < deps.size(); d++)
+    {
+        int e = next[deps[d].previousInstructionNumber]++;
+        myTargets[e] = deps[d].currentInstructionNumber;
+        myWeights[e] = weights[d];
+        myTypes[e] = deps[d].dependenceType;
+    }
+}
+
+
+int DependenceGraph::getLongestPath(const vector<int> &tail, vector<int> &chain)
+/* Finds the longest weighted path through the graph, where a path ending
+ * at instruction i also counts tail[i]. Returns its length and stores
+ * the instructions on it, in order, in chain.
+ */
+{
+    int n = getNumNodes();
+    chain.clear();
+    if (n == 0)
+        return 0;
+
+    // every edge goes from an earlier instruction to a later one, so the
+    // instructions in order are already a topological order
+    vector<int> dist(n, 0), pred(n, -1);
+    int best = 0, bestLength = dist[0] + tail[0];
+    for (int i = 0; i < n; i++)
+    {
+        if (dist[i] + tail[i] > bestLength)
+        {
+            best = i;
+            bestLength = dist[i] + tail[i];
+        }
+        for (int e = myOffsets[i]; e < myOffsets[i+1]; e++)
+        {
+            int t = myTargets[e];
+            if (dist[i] + myWeights[e] > dist[t])
+            {
+                dist[t] = dist[i] + myWeights[e];
+                pred[t] = i;
+            }
+        }
+    }
+
+    for (int i = best; i >= 0; i = pred[i])
+        chain.push_back(i);
+    reverse(chain.begin(), chain.end());
+
+    return bestLength;
+}
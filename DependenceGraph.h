@@ -0,0 +1,67 @@
+// aalok sathe
+#ifndef _DEPENDENCE_GRAPH_H_
+#define _DEPENDENCE_GRAPH_H_
+
+using namespace std;
+
+#include <vector>
+#include "DependencyChecker.h"
+
+
+/* This class holds the dependences between a sequence of instructions as a
+ * directed graph in compressed sparse row (CSR) form. The instructions are
+ * the nodes, and each dependence is an edge from the earlier instruction to
+ * the later one, weighted with the number of clock ticks the later one has
+ * to start after the earlier one. The edges leaving a node are stored next
+ * to each other, so the whole graph is three flat arrays built in time
+ * linear in the number of instructions and dependences.
+ */
+class DependenceGraph{
+
+ public:
+
+  /* Builds the graph of numNodes instructions from deps, giving the edge
+   * of deps[d] the weight weights[d].
+   */
+  DependenceGraph(int numNodes, const vector<Dependence> &deps,
+                  const vector<int> &weights);
+
+  /* Returns the number of instructions */
+  int getNumNodes() { return myOffsets.size() - 1; };
+
+  /* Returns the number of dependences */
+  int getNumEdges() { return myTargets.size(); };
+
+  /* The edges leaving instruction i are numbered from beginEdge(i) up to,
+   * but not including, endEdge(i).
+   */
+  int beginEdge(int i) { return myOffsets[i]; };
+  int endEdge(int i) { return myOffsets[i+1]; };
+
+  /* Returns the later instruction of edge e */
+  int getTarget(int e) { return myTargets[e]; };
+
+  /* Returns the weight of edge e */
+  int getWeight(int e) { return myWeights[e]; };
+
+  /* Returns the kind of dependence edge e stands for */
+  DependenceType getType(int e) { return myTypes[e]; };
+
+  /* Finds the longest weighted path through the graph, where a path ending
+   * at instruction i also counts tail[i]. Returns its length and stores
+   * the instructions on it, in order, in chain.
+   */
+  int getLongestPath(const vector<int> &tail, vector<int> &chain);
+
+
+ private:
+
+  // edges leaving node i are at [myOffsets[i], myOffsets[i+1])
+  vector<int> myOffsets;
+  vector<int> myTargets;
+  vector<int> myWeights;
+  vector<DependenceType> myTypes;
+
+};
+
+#endif
@@ -1,9 +1,13 @@
 // aalok sathe
 #include "DependencyChecker.h"
+#include <unistd.h>
+#include <algorithm>
+
+const unsigned int DependencyChecker::HI_REGISTER;
 
 DependencyChecker::DependencyChecker(int numRegisters)
-/* Creates RegisterInfo entries for each of the 32 registers and creates lists for
- * dependencies and instructions.
+/* Creates RegisterInfo entries for each of the 32 registers and the HI
+ * register, and creates lists for dependencies and instructions.
  */
 {
   RegisterInfo r;
@@ -12,6 +16,8 @@ DependencyChecker::DependencyChecker(int numRegisters)
   for(int i = 0; i < numRegisters; i++){
     myCurrentState.insert(make_pair(i, r));
   }
+  myCurrentState.insert(make_pair(HI_REGISTER, r));
+  myEarlier = 0;
 
   // myCurrentInstr = 0; // start with current instr no. = 0
 }
@@ -23,23 +29,510 @@ void DependencyChecker::addInstruction(Instruction i)
  * are added to the list of dependences.
  */
 {
-  InstType iType = i.getInstType();
+  myProgram.push_back(i);
+  myPcs.push_back(myProgram.size() - 1);
+  checkInstruction(myPcs.size() - 1);
+}
+
+
+void DependencyChecker::checkInstruction(int curr)
+/* Checks instruction curr, as addInstruction does */
+{
+  vector<pair<unsigned int, AccessType> > accesses;
+  getAccesses(getInstruction(curr), accesses);
+  for (unsigned int a = 0; a < accesses.size(); a++)
+  {
+    if (accesses[a].second == READ)
+      checkForReadDependence(accesses[a].first, curr);
+    else
+      checkForWriteDependence(accesses[a].first, curr);
+  }
+}
+
+
+void DependencyChecker::addInstructions(const vector<Instruction> &instructions)
+/* Adds instructions in order, as addInstruction would one at a time. Long
+ * runs are split into segments checked on threads of their own, each
+ * against only its own instructions; the accesses before each segment
+ * then settle the dependences on registers it uses before setting them.
+ */
+{
+  int first = myPcs.size();
+  for (unsigned int k = 0; k < instructions.size(); k++)
+    myPcs.push_back(myProgram.size() + k);
+  myProgram.insert(myProgram.end(), instructions.begin(), instructions.end());
+  checkInstructions(first);
+}
+
+
+void DependencyChecker::addInstructions(const vector<Instruction> &program,
+                                        const vector<int> &pcs)
+/* Adds the instructions at indices pcs of program, in order, as
+ * addInstructions would; program is kept once, however often its
+ * instructions are run.
+ */
+{
+  int first = myPcs.size();
+  int base = myProgram.size();
+  myProgram.insert(myProgram.end(), program.begin(), program.end());
+  myPcs.reserve(first + pcs.size());
+  for (unsigned int k = 0; k < pcs.size(); k++)
+    myPcs.push_back(base + pcs[k]);
+  checkInstructions(first);
+}
+
+
+void DependencyChecker::checkInstructions(int first)
+/* Checks the instructions from first on, whose indices into myProgram
+ * have just been added to myPcs. Long runs are split into segments
+ * checked on threads of their own.
+ */
+{
+  // segments shorter than this are not worth a thread
+  const int shortest = 1 << 14;
+  int n = myPcs.size() - first;
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int count = min((long)n / shortest, max(1L, cores));
+  if (count < 2)
+  {
+    for (int k = first; k < first + n; k++)
+      checkInstruction(k);
+    return;
+  }
+
+  vector<Segment> segments(count);
+  vector<pthread_t> threads(count);
+  vector<bool> started(count, false);
+  for (int s = 0; s < count; s++)
+  {
+    segments[s].checker = this;
+    segments[s].begin = first + (long)n * s / count;
+    segments[s].end = first + (long)n * (s + 1) / count;
+  }
+  for (int s = 1; s < count; s++)
+    started[s] = (pthread_create(&threads[s], NULL, startSegment, &segments[s]) == 0);
+  for (int s = 0; s < count; s++)
+  {
+    if (started[s])
+      pthread_join(threads[s], NULL);
+    else
+      checkSegment(segments[s]);
+  }
+
+  // in order, each segment's first access to a register follows the last
+  // access of the segments before, which make up myCurrentState
+  for (int s = 0; s < count; s++)
+  {
+    vector<Dependence> &found = segments[s].dependences;
+    for (unsigned int k = 0; k < found.size(); k++)
+    {
+      Dependence d = found[k];
+      if (d.dependenceType == D_UNDEFINED
+          and not getDependence(myCurrentState[d.registerNumber], d.registerNumber,
+                                (AccessType)d.previousInstructionNumber,
+                                d.currentInstructionNumber, d))
+        continue;
+      addDependence(d);
+    }
+    for (unsigned int reg = 0; reg < segments[s].last.size(); reg++)
+      if (segments[s].last[reg].accessType != A_UNDEFINED)
+        myCurrentState[reg] = segments[s].last[reg];
+  }
+}
+
+
+void DependencyChecker::addInstructions(const vector<Instruction> &program,
+                                        const vector<int> &pcs,
+                                        const vector<Dependence> &dependences)
+/* Adds the instructions at indices pcs of program, whose dependences are
+ * already known, e.g. read from a trace: dependences are the ones adding
+ * them would find, numbered from the first of pcs, in the same order.
+ */
+{
+  int first = myPcs.size();
+  int base = myProgram.size();
+  myProgram.insert(myProgram.end(), program.begin(), program.end());
+  myPcs.reserve(first + pcs.size());
+  for (unsigned int k = 0; k < pcs.size(); k++)
+    myPcs.push_back(base + pcs[k]);
+
+  for (unsigned int k = 0; k < dependences.size(); k++)
+  {
+    Dependence d = dependences[k];
+    d.previousInstructionNumber += first;
+    d.currentInstructionNumber += first;
+    addDependence(d);
+  }
+
+  // only the last access to each register is left to find, for any
+  // instructions added after these
+  vector<pair<unsigned int, AccessType> > accesses;
+  for (unsigned int k = first; k < myPcs.size(); k++)
+  {
+    accesses.clear();
+    getAccesses(getInstruction(k), accesses);
+    for (unsigned int a = 0; a < accesses.size(); a++)
+    {
+      RegisterInfo &last = myCurrentState[accesses[a].first];
+      last.accessType = accesses[a].second;
+      last.lastInstructionToAccess = k;
+    }
+  }
+}
+
+
+void DependencyChecker::seed(const vector<RegisterInfo> &state)
+/* Starts the checker, which has no instructions yet, from state: the
+ * last access to each register before the first instruction it will be
+ * given, numbered from that instruction (so below 0), as when a run is
+ * checked from the middle. The dependences on those earlier accesses are
+ * only counted (getEarlierCount), since there is no instruction here to
+ * refer them to.
+ */
+{
+  for (unsigned int reg = 0; reg < state.size() and reg <= HI_REGISTER; reg++)
+    myCurrentState[reg] = state[reg];
+}
+
+
+vector<RegisterInfo> DependencyChecker::getRegisterState(int k)
+/* Returns the last access to each register before instruction k, indexed
+ * by register and numbered from k (so below 0), for seed.
+ */
+{
+  vector<RegisterInfo> state(HI_REGISTER + 1);
+  int left = HI_REGISTER + 1;
+  vector<pair<unsigned int, AccessType> > accesses;
+  for (int j = k - 1; j >= 0 and left > 0; j--)
+  {
+    accesses.clear();
+    getAccesses(getInstruction(j), accesses);
+    for (int a = accesses.size() - 1; a >= 0; a--)
+    {
+      RegisterInfo &last = state[accesses[a].first];
+      if (last.accessType != A_UNDEFINED)
+        continue;
+      last.accessType = accesses[a].second;
+      last.lastInstructionToAccess = j - k;
+      left--;
+    }
+  }
+  return state;
+}
+
+
+void DependencyChecker::swap(DependencyChecker &other)
+/* Exchanges the instructions and dependences of this checker with
+ * other's, without copying them.
+ */
+{
+  myCurrentState.swap(other.myCurrentState);
+  myDependences.swap(other.myDependences);
+  myProgram.swap(other.myProgram);
+  myPcs.swap(other.myPcs);
+  std::swap(myEarlier, other.myEarlier);
+  myDependenceMap.swap(other.myDependenceMap);
+}
+
+
+int DependencyChecker::replaceInstructions(int first, int removed,
+                                           const vector<Instruction> &added,
+                                           int horizon)
+/* Replaces the removed instructions from first with added, as if they
+ * had been added in their place. Only added and, after them, the first
+ * access to each register they or the removed ones access are checked;
+ * the other dependences are kept, renumbered. Returns one past the last
+ * instruction after added whose dependences on the instructions fewer
+ * than horizon before it changed, or one past added if none did.
+ */
+{
+  int oldEnd = first + removed;
+  int newEnd = first + added.size();
+  int shift = newEnd - oldEnd;
+  int n = myPcs.size();
+
+  // the registers the edit touches
+  vector<pair<unsigned int, AccessType> > accesses;
+  vector<bool> touched(HI_REGISTER + 1, false);
+  for (int k = 0; k < removed + (int)added.size(); k++)
+  {
+    Instruction inst = (k < removed) ? getInstruction(first + k) : added[k - removed];
+    accesses.clear();
+    getAccesses(inst, accesses);
+    for (unsigned int a = 0; a < accesses.size(); a++)
+      touched[accesses[a].first] = true;
+  }
+  int left = 0;
+  for (unsigned int reg = 0; reg < touched.size(); reg++)
+    if (touched[reg])
+      left++;
+
+  // the last access to each of them before the edit
+  vector<RegisterInfo> last(HI_REGISTER + 1);
+  vector<bool> pending = touched;
+  int count = left;
+  for (int k = first - 1; k >= 0 and count > 0; k--)
+  {
+    accesses.clear();
+    getAccesses(getInstruction(k), accesses);
+    for (int a = accesses.size() - 1; a >= 0; a--)
+    {
+      unsigned int reg = accesses[a].first;
+      if (not pending[reg])
+        continue;
+      last[reg].lastInstructionToAccess = k;
+      last[reg].accessType = accesses[a].second;
+      pending[reg] = false;
+      count--;
+    }
+  }
+
+  // added, checked as addInstruction would
+  vector<Dependence> found;
+  for (unsigned int k = 0; k < added.size(); k++)
+  {
+    Instruction inst = added[k];
+    accesses.clear();
+    getAccesses(inst, accesses);
+    for (unsigned int a = 0; a < accesses.size(); a++)
+    {
+      unsigned int reg = accesses[a].first;
+      Dependence d;
+      if (getDependence(last[reg], reg, accesses[a].second, first + k, d))
+        found.push_back(d);
+      last[reg].lastInstructionToAccess = first + k;
+      last[reg].accessType = accesses[a].second;
+    }
+  }
+
+  // after the edit, only the first access to each touched register may
+  // depend on another instruction than before; the instruction's other
+  // accesses keep their dependences
+  map<int, vector<Dependence> > changed;
+  int settled = newEnd;
+  pending = touched;
+  for (int k = oldEnd; k < n and left > 0; k++)
+  {
+    accesses.clear();
+    getAccesses(getInstruction(k), accesses);
+    bool firstAccess = false;
+    for (unsigned int a = 0; a < accesses.size(); a++)
+      if (pending[accesses[a].first])
+        firstAccess = true;
+    if (not firstAccess)
+      continue;
+
+    vector<Dependence> before = getInstructionDependences(k);
+    vector<Dependence> &after = changed[k];
+    map<unsigned int, AccessType> here;
+    for (unsigned int a = 0; a < accesses.size(); a++)
+    {
+      unsigned int reg = accesses[a].first;
+      AccessType access = accesses[a].second;
+      Dependence d;
+      if (here.find(reg) != here.end())
+      {
+        RegisterInfo self;
+        self.lastInstructionToAccess = k + shift;
+        self.accessType = here[reg];
+        if (getDependence(self, reg, access, k + shift, d))
+          after.push_back(d);
+      }
+      else if (pending[reg])
+      {
+        if (getDependence(last[reg], reg, access, k + shift, d))
+          after.push_back(d);
+      }
+      else
+      {
+        for (unsigned int b = 0; b < before.size(); b++)
+        {
+          if (before[b].registerNumber != reg or before[b].previousInstructionNumber >= k)
+            continue;
+          d = before[b];
+          if (d.previousInstructionNumber >= oldEnd)
+            d.previousInstructionNumber += shift;
+          d.currentInstructionNumber = k + shift;
+          after.push_back(d);
+          break;
+        }
+      }
+      here[reg] = access;
+    }
+    for (unsigned int a = 0; a < accesses.size(); a++)
+    {
+      if (pending[accesses[a].first])
+        left--;
+      pending[accesses[a].first] = false;
+    }
+
+    // the pipeline models only tell dependences on instructions that may
+    // still be in the pipeline apart by distance
+    bool same = (before.size() == after.size());
+    for (unsigned int b = 0; same and b < before.size(); b++)
+      same = (before[b].dependenceType == after[b].dependenceType
+              and min(horizon, k - before[b].previousInstructionNumber)
+                  == min(horizon, k + shift - after[b].previousInstructionNumber));
+    if (not same)
+      settled = max(settled, k + shift + 1);
+  }
+
+  // the instructions, which are the program in order, and their
+  // dependences by instruction, renumbered
+  myProgram.erase(myProgram.begin() + first, myProgram.begin() + oldEnd);
+  myProgram.insert(myProgram.begin() + first, added.begin(), added.end());
+  myPcs.resize(n + shift);
+  for (int k = first; k < (shift != 0 ? n + shift : newEnd); k++)
+    myPcs[k] = k;
+  myDependenceMap.erase(myDependenceMap.lower_bound(first),
+                        myDependenceMap.lower_bound(oldEnd));
+  if (shift != 0)
+  {
+    map<int, list<Dependence> >::iterator from = myDependenceMap.lower_bound(oldEnd);
+    vector<pair<int, list<Dependence> > > moved(from, myDependenceMap.end());
+    myDependenceMap.erase(from, myDependenceMap.end());
+    for (unsigned int m = 0; m < moved.size(); m++)
+    {
+      list<Dependence>::iterator d;
+      for (d = moved[m].second.begin(); d != moved[m].second.end(); d++)
+      {
+        if (d->previousInstructionNumber >= oldEnd)
+          d->previousInstructionNumber += shift;
+        d->currentInstructionNumber += shift;
+      }
+      myDependenceMap.insert(myDependenceMap.end(),
+                             make_pair(moved[m].first + shift, moved[m].second));
+    }
+  }
+  for (unsigned int f = 0; f < found.size(); f++)
+    myDependenceMap[found[f].currentInstructionNumber].push_back(found[f]);
+  map<int, vector<Dependence> >::iterator c;
+  for (c = changed.begin(); c != changed.end(); c++)
+  {
+    if (c->second.empty())
+      myDependenceMap.erase(c->first + shift);
+    else
+      myDependenceMap[c->first + shift].assign(c->second.begin(), c->second.end());
+  }
+
+  // and in the order they were found
+  list<Dependence>::iterator it = myDependences.begin();
+  while (it != myDependences.end() and it->currentInstructionNumber < first)
+    it++;
+  while (it != myDependences.end() and it->currentInstructionNumber < oldEnd)
+    it = myDependences.erase(it);
+  myDependences.insert(it, found.begin(), found.end());
+  int lastChanged = changed.empty() ? -1 : changed.rbegin()->first;
+  while (it != myDependences.end() and (shift != 0 or it->currentInstructionNumber <= lastChanged))
+  {
+    int curr = it->currentInstructionNumber;
+    c = changed.find(curr);
+    if (c != changed.end())
+    {
+      while (it != myDependences.end() and it->currentInstructionNumber == curr)
+        it = myDependences.erase(it);
+      myDependences.insert(it, c->second.begin(), c->second.end());
+      changed.erase(c);
+      continue;
+    }
+    if (it->previousInstructionNumber >= oldEnd)
+      it->previousInstructionNumber += shift;
+    it->currentInstructionNumber += shift;
+    it++;
+  }
+
+  // instructions that had no dependences before have no place in the
+  // order yet
+  for (c = changed.begin(); c != changed.end(); c++)
+  {
+    int curr = c->first + shift;
+    it = myDependences.begin();
+    while (it != myDependences.end() and it->currentInstructionNumber < curr)
+      it++;
+    myDependences.insert(it, c->second.begin(), c->second.end());
+  }
+
+  // the last access to each register after the last instruction
+  for (unsigned int reg = 0; reg <= HI_REGISTER; reg++)
+  {
+    RegisterInfo &state = myCurrentState[reg];
+    if (state.lastInstructionToAccess >= oldEnd)
+      state.lastInstructionToAccess += shift;
+    else if (touched[reg])
+      state = last[reg];
+  }
+  return settled;
+}
+
+
+void DependencyChecker::checkSegment(Segment &segment)
+/* Checks the instructions of segment on their own */
+{
+  segment.last.assign(HI_REGISTER + 1, RegisterInfo());
+  vector<pair<unsigned int, AccessType> > accesses;
+  for (int curr = segment.begin; curr < segment.end; curr++)
+  {
+    accesses.clear();
+    getAccesses(getInstruction(curr), accesses);
+    for (unsigned int a = 0; a < accesses.size(); a++)
+    {
+      unsigned int reg = accesses[a].first;
+      RegisterInfo &last = segment.last[reg];
+      Dependence d;
+      if (last.accessType == A_UNDEFINED)
+      {
+        // left for the accesses before the segment to settle
+        d.dependenceType = D_UNDEFINED;
+        d.registerNumber = reg;
+        d.previousInstructionNumber = accesses[a].second;
+        d.currentInstructionNumber = curr;
+        segment.dependences.push_back(d);
+      }
+      else if (getDependence(last, reg, accesses[a].second, curr, d))
+        segment.dependences.push_back(d);
+      last.accessType = accesses[a].second;
+      last.lastInstructionToAccess = curr;
+    }
+  }
+}
+
+
+void *DependencyChecker::startSegment(void *segment)
+/* The body of a thread checking a segment; segment is its Segment */
+{
+  Segment *checked = (Segment *)segment;
+  checked->checker->checkSegment(*checked);
+  return NULL;
+}
+
+
+void DependencyChecker::getAccesses(Instruction &inst,
+                                    vector<pair<unsigned int, AccessType> > &accesses)
+/* Lists the registers inst accesses into accesses, in the order it
+ * accesses them: the registers it reads, then the one it writes.
+ */
+{
+  InstType iType = inst.getInstType();
 
   switch(iType){
 
       case RTYPE:
         {
-            Opcode opc = i.getOpcode();
+            Opcode opc = inst.getOpcode();
 
             // check for validity of each register position
             // and process according to known roles (src or dest).
             // dest registers are written to, and source, read from.
             if (myOpcodeTable.RSposition(opc) >= 0) // src
-                checkForReadDependence(i.getRS());
+                accesses.push_back(make_pair((unsigned int)inst.getRS(), READ));
             if (myOpcodeTable.RTposition(opc) >= 0) // src
-                checkForReadDependence(i.getRT());
+                accesses.push_back(make_pair((unsigned int)inst.getRT(), READ));
+            if (opc == MFHI)                        // HI is an implicit src
+                accesses.push_back(make_pair(HI_REGISTER, READ));
             if (myOpcodeTable.RDposition(opc) >= 0) // dest
-                checkForWriteDependence(i.getRD());
+                accesses.push_back(make_pair((unsigned int)inst.getRD(), WRITE));
+            if (opc == MULT)                        // HI/LO are implicit dest
+                accesses.push_back(make_pair(HI_REGISTER, WRITE));
 
             break;
 
@@ -47,21 +540,21 @@ void DependencyChecker::addInstruction(Instruction i)
 
       case ITYPE:
         {
-            Opcode opc = i.getOpcode();
+            Opcode opc = inst.getOpcode();
 
             // check for validity of each register position
             // and process according to known roles (src or dest).
             // dest registers are written to, and source, read from.
-            if(myOpcodeTable.RTposition(opc) >= 0) // check if RT is being used 
-            {
-                if (not(myOpcodeTable.isIMMLabel(opc)))
-                    checkForWriteDependence(i.getRT()); // there's no immlabel so dest
-                else
-                    checkForReadDependence(i.getRT());  // immlabel so it's a src
-            }
+            // sources are read before the destination is written, so
+            // that e.g. "addi $1, $1, 4" does not depend on itself
+            bool rtUsed = myOpcodeTable.RTposition(opc) >= 0;
+            if (rtUsed and myOpcodeTable.isIMMLabel(opc))   // immlabel so it's a src
+                accesses.push_back(make_pair((unsigned int)inst.getRT(), READ));
             if (myOpcodeTable.RSposition(opc) >= 0) // always src, if it exists
-                checkForReadDependence(i.getRS());
-            
+                accesses.push_back(make_pair((unsigned int)inst.getRS(), READ));
+            if (rtUsed and not(myOpcodeTable.isIMMLabel(opc)))  // there's no immlabel so dest
+                accesses.push_back(make_pair((unsigned int)inst.getRT(), WRITE));
+
             break;
 
         }
@@ -74,95 +567,97 @@ void DependencyChecker::addInstruction(Instruction i)
             break;
 
   }
+}
 
-  myInstructions.push_back(i);
 
+bool DependencyChecker::getDependence(const RegisterInfo &last, unsigned int reg,
+                                      AccessType access, int curr, Dependence &d)
+/* Given the last access to register reg before instruction curr accesses
+ * it with access, last, sets d to the dependence that makes. Returns
+ * false if it makes none.
+ */
+{
+  // reads only depend on writes, since we don't care about RAR; writes
+  // depend on any access
+  if (last.accessType == A_UNDEFINED or (access == READ and last.accessType == READ))
+    return false;
+
+  d.registerNumber = reg;
+  d.previousInstructionNumber = last.lastInstructionToAccess;
+  d.currentInstructionNumber = curr;
+  if (access == READ)
+    d.dependenceType = RAW;
+  else
+    // if previous atype is READ, it is an WAR dependence otherwise WAW
+    d.dependenceType = (last.accessType == READ) ? WAR : WAW;
+  return true;
 }
 
 
-void DependencyChecker::checkForReadDependence(unsigned int reg)
+void DependencyChecker::addDependence(const Dependence &d)
+/* Stores dependence d of instruction d.currentInstructionNumber, or only
+ * counts it if it is on an instruction before the first.
+ */
+{
+  if (d.previousInstructionNumber < 0)
+  {
+    myEarlier++;
+    return;
+  }
+  myDependences.push_back(d);
+
+  map<int, list<Dependence> >::iterator deps = myDependenceMap.find(d.currentInstructionNumber);
+  if (deps == myDependenceMap.end())
+  {
+    list<Dependence> l;
+    l.push_back(d);
+    myDependenceMap.insert(myDependenceMap.end(), make_pair(d.currentInstructionNumber, l));
+  }
+  else
+    deps->second.push_back(d);
+}
+
+
+void DependencyChecker::checkForReadDependence(unsigned int reg, int curr)
   /* Determines if a read data dependence occurs when reg is read by the current
-   * instruction.  If so, adds an entry to the list of dependences. Also updates
+   * instruction, curr.  If so, adds an entry to the list of dependences. Also updates
    * the appropriate RegisterInfo entry regardless of dependence detection.
    */
 {
   // get the current state of the register in question
   RegisterInfo reginfo = myCurrentState[reg];
-  AccessType atype = reginfo.accessType;
 
-  // if access type was WRITE then we have some kind of dependence,
-  // because we don't care about RAR
-  if (atype == WRITE)
-  {
-    // initialize and populate the values of a dependence structure
-    Dependence d;
-    d.registerNumber = reg;
-    d.previousInstructionNumber = reginfo.lastInstructionToAccess;
-    d.currentInstructionNumber = myInstructions.size();
-    d.dependenceType = RAW;
-
-    // store the detected dependence
-    myDependences.push_back(d);
-    
-    map<int, list<Dependence> >::iterator deps = myDependenceMap.find(myInstructions.size());
-    if (deps == myDependenceMap.end())
-    {
-      list<Dependence> l;
-      l.push_back(d);
-      myDependenceMap.insert(make_pair(myInstructions.size(), l));
-    }
-    else
-      deps->second.push_back(d);
- 
-  }
+  // if access type was WRITE then we have a RAW dependence
+  Dependence d;
+  if (getDependence(reginfo, reg, READ, curr, d))
+    addDependence(d);
 
   // update most recent access of this register
   reginfo.accessType = READ;
-  reginfo.lastInstructionToAccess = myInstructions.size();
+  reginfo.lastInstructionToAccess = curr;
   myCurrentState[reg] = reginfo;
   
 }
 
 
-void DependencyChecker::checkForWriteDependence(unsigned int reg)
+void DependencyChecker::checkForWriteDependence(unsigned int reg, int curr)
   /* Determines if a write data dependence occurs when reg is written by the current
-   * instruction.  If so, adds an entry to the list of dependences. Also updates
+   * instruction, curr.  If so, adds an entry to the list of dependences. Also updates
    * the appropriate RegisterInfo entry regardless of dependence detection.
    */
 {
     // get the current state of the register in question
     RegisterInfo reginfo = myCurrentState[reg];
-    AccessType atype = reginfo.accessType;
 
     // if access type was either READ or WRITE (some access, not A_UNDEFINED),
     // then we have some kind of dependence
-    if (atype == WRITE or atype == READ)
-    {
-      // initialize and populate the values of a dependence structure
-      Dependence d;
-      d.registerNumber = reg;
-      d.previousInstructionNumber = reginfo.lastInstructionToAccess;
-      d.currentInstructionNumber = myInstructions.size();
-      // if previous atype is READ, it is an WAR dependence otherwise WAW
-      d.dependenceType = (atype == READ) ? WAR : WAW;
-
-      myDependences.push_back(d);
-   
-      map<int, list<Dependence> >::iterator deps = myDependenceMap.find(myInstructions.size());
-      if (deps == myDependenceMap.end())
-      {
-        list<Dependence> l;
-        l.push_back(d);
-        myDependenceMap.insert(make_pair(myInstructions.size(), l));
-      }
-      else
-        deps->second.push_back(d);
-    }
+    Dependence d;
+    if (getDependence(reginfo, reg, WRITE, curr, d))
+      addDependence(d);
 
-    
     // update most recent access of this register
     reginfo.accessType = WRITE;
-    reginfo.lastInstructionToAccess = myInstructions.size();
+    reginfo.lastInstructionToAccess = curr;
     myCurrentState[reg] = reginfo;
 }
 
@@ -173,12 +668,9 @@ void DependencyChecker::printDependences()
    */
 {
   // First, print all instructions
-  vector<Instruction>::iterator viter;
-  int i = 0;
   cout << "INSTRUCTIONS:" << endl;
-  for(viter = myInstructions.begin(); viter != myInstructions.end(); viter++){
-    cout << i << ": " << (*viter).getAssembly() << endl;
-    i++;
+  for(unsigned int i = 0; i < myPcs.size(); i++){
+    cout << i << ": " << getInstruction(i).getAssembly() << endl;
   }
 
   // Second, print all dependences
@@ -199,7 +691,10 @@ void DependencyChecker::printDependences()
       break;
     }
 
-    cout << "$" << (*diter).registerNumber << " \t";
+    if ((*diter).registerNumber == HI_REGISTER)
+      cout << "HI \t";
+    else
+      cout << "$" << (*diter).registerNumber << " \t";
     cout << "(" << (*diter).previousInstructionNumber << ", ";
     cout << (*diter).currentInstructionNumber << ")" << endl;
   }
@@ -207,11 +702,12 @@ void DependencyChecker::printDependences()
 }
 
 
-vector<string> DependencyChecker::getStringDependences(DependenceType depType)
+vector<string> DependencyChecker::getStringDependences(DependenceType depType,
+                                                       int offset)
  /* Returns a vector of strings of dependences all of a certain kind (depType).
   * Useful for if a program wants to use this class to find out and report
   * dependences, without providing it direct access to the internal data
-  * representation.
+  * representation. The instructions are numbered from offset.
   */
 {
     // initialize a vector of lines with a dependency each to return
@@ -249,10 +745,10 @@ vector<string> DependencyChecker::getStringDependences(DependenceType depType)
       // add the literal instruction encoding to the output
       int prev = (*diter).previousInstructionNumber;
       int curr = (*diter).currentInstructionNumber;
-      ss << prev << ' '
-         << myInstructions.at(prev).getAssembly() << " and "
-         << curr << ' '
-         << myInstructions.at(curr).getAssembly();
+      ss << prev + offset << ' '
+         << myProgram.at(myPcs.at(prev)).getAssembly() << " and "
+         << curr + offset << ' '
+         << myProgram.at(myPcs.at(curr)).getAssembly();
 
       lines.push_back(ss.str());
 
@@ -269,14 +765,111 @@ int DependencyChecker::getPrevDep(int i, DependenceType depType)
   */
 {
     // retrieve the list of dependenes of instruction at i
-    list<Dependence> deps = myDependenceMap[i];
+    map<int, list<Dependence> >::iterator deps = myDependenceMap.find(i);
+    if (deps == myDependenceMap.end())
+        return -1;
     list<Dependence>::iterator it;
 
     // find the depType dependence, if any, and exit
-    for (it = deps.begin(); it != deps.end(); it++) 
+    for (it = deps->second.begin(); it != deps->second.end(); it++) 
         if (it->dependenceType == depType)
             return it->previousInstructionNumber;
 
     // no dependence of queried type exists
     return -1;
 }
+
+
+bool DependencyChecker::hasDependence(int prev, int curr, DependenceType depType)
+/* Given the indices of two instructions, prev and curr, returns true if
+ * curr has a dependence of depType on prev.
+ */
+{
+    map<int, list<Dependence> >::iterator deps = myDependenceMap.find(curr);
+    if (deps == myDependenceMap.end())
+        return false;
+
+    list<Dependence>::iterator it;
+    for (it = deps->second.begin(); it != deps->second.end(); it++)
+        if (it->dependenceType == depType and it->previousInstructionNumber == prev)
+            return true;
+
+    return false;
+}
+
+
+vector<Dependence> DependencyChecker::getDependences(DependenceType depType)
+ /* Returns all dependences of a certain kind (depType), in the order they
+  * were found.
+  */
+{
+    vector<Dependence> deps;
+
+    list<Dependence>::iterator diter;
+    for (diter = myDependences.begin(); diter != myDependences.end(); diter++)
+        if (diter->dependenceType == depType)
+            deps.push_back(*diter);
+
+    return deps;
+}
+
+
+vector<Dependence> DependencyChecker::getInstructionDependences(int i)
+/* Returns the dependences instruction i has on earlier instructions, of
+ * any kind, in the order they were found.
+ */
+{
+    vector<Dependence> deps;
+    map<int, list<Dependence> >::iterator found = myDependenceMap.find(i);
+    if (found != myDependenceMap.end())
+        deps.assign(found->second.begin(), found->second.end());
+    return deps;
+}
+
+
+void DependencyChecker::getRegisters(Instruction &inst, int src[2], int &dst)
+/* Finds the registers inst reads into src (up to two, -1 if unused) and
+ * writes into dst (-1 if none). HI is numbered HI_REGISTER. $0 is left
+ * out, since it always reads as zero and writing it has no effect.
+ */
+{
+    Opcode opc = inst.getOpcode();
+    src[0] = src[1] = dst = -1;
+
+    switch (inst.getInstType())
+    {
+        case RTYPE:
+            if (myOpcodeTable.RSposition(opc) >= 0)
+                src[0] = inst.getRS();
+            if (myOpcodeTable.RTposition(opc) >= 0)
+                src[1] = inst.getRT();
+            if (myOpcodeTable.RDposition(opc) >= 0)
+                dst = inst.getRD();
+            if (opc == MULT)
+                dst = HI_REGISTER;
+            else if (opc == MFHI)
+                src[0] = HI_REGISTER;
+            break;
+
+        case ITYPE:
+            if (myOpcodeTable.RSposition(opc) >= 0)
+                src[0] = inst.getRS();
+            if (myOpcodeTable.RTposition(opc) >= 0)
+            {
+                if (myOpcodeTable.isIMMLabel(opc))
+                    src[1] = inst.getRT();
+                else
+                    dst = inst.getRT();
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    for (int j = 0; j < 2; j++)
+        if (src[j] == 0 or src[j] > (int)HI_REGISTER)
+            src[j] = -1;
+    if (dst == 0 or dst > (int)HI_REGISTER)
+        dst = -1;
+}
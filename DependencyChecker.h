@@ -10,6 +10,7 @@ using namespace std;
 #include <string>
 #include <sstream>
 #include <vector>
+#include <pthread.h>
 #include "Instruction.h"
 #include "OpcodeTable.h"
 
@@ -64,16 +65,22 @@ struct Dependence {
 /* This class keeps track of a sequence of instructions and determines data
  * dependencies that occur between the instructions due to register usage.  Instructions
  * are numbered and those numbers are used to keep track of which instructions
- * are used in a dependence.
+ * are used in a dependence. The sequence is kept as a program, each of whose
+ * instructions is stored once, and the index into it of each instruction of
+ * the sequence, so that a long executed run costs an int per instruction.
  */
 class DependencyChecker {
  public:
 
-  /* Creates RegisterInfo entries for each of the 32 registers and creates lists for
-   * dependencies and instructions.
+  /* Creates RegisterInfo entries for each of the 32 registers and the HI
+   * register, and creates lists for dependencies and instructions.
    */
   DependencyChecker(int numRegisters = 32);
 
+  // MULT writes the HI and LO registers and MFHI reads HI; the pair is
+  // tracked as one more register with this number
+  static const unsigned int HI_REGISTER = NumRegisters;
+
   /* Adds an instruction to the list of instructions and checks to see if that
    * instruction results in any new data dependencies.  If new data dependencies
    * are created with the addition of this instruction, appropriate entries
@@ -81,6 +88,61 @@ class DependencyChecker {
    */
   void addInstruction(Instruction i);
 
+  /* Adds instructions in order, as addInstruction would one at a time. Long
+   * runs are split into segments checked on threads of their own, each
+   * against only its own instructions; the accesses before each segment
+   * then settle the dependences on registers it uses before setting them.
+   */
+  void addInstructions(const vector<Instruction> &instructions);
+
+  /* Adds the instructions at indices pcs of program, in order, as
+   * addInstructions would; program is kept once, however often its
+   * instructions are run.
+   */
+  void addInstructions(const vector<Instruction> &program, const vector<int> &pcs);
+
+  /* Adds the instructions at indices pcs of program, whose dependences are
+   * already known, e.g. read from a trace: dependences are the ones adding
+   * them would find, numbered from the first of pcs, in the same order.
+   */
+  void addInstructions(const vector<Instruction> &program, const vector<int> &pcs,
+                       const vector<Dependence> &dependences);
+
+  /* Starts the checker, which has no instructions yet, from state: the
+   * last access to each register before the first instruction it will be
+   * given, numbered from that instruction (so below 0), as when a run is
+   * checked from the middle. The dependences on those earlier accesses are
+   * only counted (getEarlierCount), since there is no instruction here to
+   * refer them to.
+   */
+  void seed(const vector<RegisterInfo> &state);
+
+  /* Returns the last access to each register before instruction k, indexed
+   * by register and numbered from k (so below 0), for seed.
+   */
+  vector<RegisterInfo> getRegisterState(int k);
+
+  /* Returns the number of dependences on instructions before the first,
+   * found from the state given to seed.
+   */
+  int getEarlierCount() { return myEarlier; };
+
+  /* Exchanges the instructions and dependences of this checker with
+   * other's, without copying them.
+   */
+  void swap(DependencyChecker &other);
+
+  /* Replaces the removed instructions from first with added, as if they
+   * had been added in their place. Only added and, after them, the first
+   * access to each register they or the removed ones access are checked;
+   * the other dependences are kept, renumbered. Returns one past the last
+   * instruction after added whose dependences on the instructions fewer
+   * than horizon before it changed, or one past added if none did. The
+   * instructions must be the program in order, as the lines of a file are.
+   */
+  int replaceInstructions(int first, int removed, const vector<Instruction> &added,
+                          int horizon);
+
   /* Prints out the sequence of instructions followed by the sequence of data
    * dependencies.
    */
@@ -89,9 +151,9 @@ class DependencyChecker {
  /* Returns a vector of strings of dependences all of a certain kind (depType).
   * Useful for if a program wants to use this class to find out and report
   * dependences, without providing it direct access to the internal data
-  * representation.
+  * representation. The instructions are numbered from offset.
   */
-  vector<string> getStringDependences(DependenceType depType);
+  vector<string> getStringDependences(DependenceType depType, int offset = 0);
 
  /* Given an index of an instruction, returns the index of the most recent
   * instruction, if any, that had a dependence of depType with it. Returns
@@ -99,23 +161,94 @@ class DependencyChecker {
   */ 
   int getPrevDep(int i, DependenceType depType);
 
+ /* Given the indices of two instructions, prev and curr, returns true if
+  * curr has a dependence of depType on prev.
+  */
+  bool hasDependence(int prev, int curr, DependenceType depType);
+
+ /* Returns all dependences of a certain kind (depType), in the order they
+  * were found.
+  */
+  vector<Dependence> getDependences(DependenceType depType);
+
+ /* Returns the dependences instruction i has on earlier instructions, of
+  * any kind, in the order they were found.
+  */
+  vector<Dependence> getInstructionDependences(int i);
+
+ /* Finds the registers inst reads into src (up to two, -1 if unused) and
+  * writes into dst (-1 if none). HI is numbered HI_REGISTER. $0 is left
+  * out, since it always reads as zero and writing it has no effect.
+  */
+  void getRegisters(Instruction &inst, int src[2], int &dst);
+
+ /* Lists the registers inst accesses into accesses, in the order it
+  * accesses them: the registers it reads, then the one it writes.
+  */
+  void getAccesses(Instruction &inst, vector<pair<unsigned int, AccessType> > &accesses);
 
  private:
+
+  /* Given the last access to register reg before instruction curr accesses
+   * it with access, last, sets d to the dependence that makes. Returns
+   * false if it makes none.
+   */
+  static bool getDependence(const RegisterInfo &last, unsigned int reg,
+                            AccessType access, int curr, Dependence &d);
+
+  /* Stores dependence d of instruction d.currentInstructionNumber, or only
+   * counts it if it is on an instruction before the first.
+   */
+  void addDependence(const Dependence &d);
+
+  /* What checking a segment of the instructions on its own finds: the
+   * dependences within it, in order, with the accesses to registers it does
+   * not access before in their places (as dependences of type D_UNDEFINED,
+   * the access type kept in previousInstructionNumber), and the last access
+   * in it to each register.
+   */
+  struct Segment{
+    DependencyChecker *checker;
+    int begin, end;          // its instructions, by number
+    vector<Dependence> dependences;
+    vector<RegisterInfo> last;
+  };
+
+  /* Checks the instructions from first on, whose indices into myProgram
+   * have just been added to myPcs. Long runs are split into segments
+   * checked on threads of their own.
+   */
+  void checkInstructions(int first);
+
+  /* Checks instruction curr, as addInstruction does */
+  void checkInstruction(int curr);
+
+  /* Returns instruction k of the sequence */
+  Instruction &getInstruction(int k) { return myProgram[myPcs[k]]; };
+
+  /* Checks the instructions of segment on their own */
+  void checkSegment(Segment &segment);
+
+  /* The body of a thread checking a segment; segment is its Segment */
+  static void *startSegment(void *segment);
+
   /* Determines if a read data dependence occurs when reg is read by the current
-   * instruction.  If so, adds an entry to the list of dependences. Also updates
+   * instruction, curr.  If so, adds an entry to the list of dependences. Also updates
    * the appropriate RegisterInfo entry regardless of dependence detection.
    */
-  void checkForReadDependence(unsigned int reg);
+  void checkForReadDependence(unsigned int reg, int curr);
 
   /* Determines if a write data dependence occurs when reg is written by the current
-   * instruction.  If so, adds an entry to the list of dependences. Also updates
+   * instruction, curr.  If so, adds an entry to the list of dependences. Also updates
    * the appropriate RegisterInfo entry regardless of dependence detection.
    */
-  void checkForWriteDependence(unsigned int reg);
+  void checkForWriteDependence(unsigned int reg, int curr);
 
   map<unsigned int, RegisterInfo> myCurrentState;
   list<Dependence> myDependences;
-  vector<Instruction> myInstructions;
+  vector<Instruction> myProgram;     // each instruction once
+  vector<int> myPcs;                 // the sequence, as indices into myProgram
+  int myEarlier;                     // dependences before the first
   OpcodeTable myOpcodeTable;
   map<int, list<Dependence> > myDependenceMap; // stores all dependences of a particular
                                                // instruction given by instr index 
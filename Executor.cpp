@@ -0,0 +1,198 @@
+// aalok sathe
+#include "Executor.h"
+
+Executor::Executor(vector<Instruction> &program)
+/* Predecodes the static program so that executing an instruction does not
+ * need any table lookups. Execution starts at the first instruction.
+ */
+{
+    int n = program.size();
+    myProgram.resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        DecodedInst &d = myProgram[i];
+        d.op = program[i].getOpcode();
+        d.imm = program[i].getImmediate();
+
+        // unused register fields hold NumRegisters; point them at $0 so
+        // that no register access can fall outside the register file
+        d.rs = program[i].getRS() < NumRegisters ? program[i].getRS() : 0;
+        d.rt = program[i].getRT() < NumRegisters ? program[i].getRT() : 0;
+        d.rd = program[i].getRD() < NumRegisters ? program[i].getRD() : 0;
+
+        // resolve control targets to instruction indices. jumps hold the
+        // target address, branches the word offset from the next instruction
+        d.target = -1;
+        if (d.op == J)
+        {
+            int offset = d.imm - TextBaseAddress;
+            if (offset >= 0 and offset % 4 == 0 and offset / 4 < n)
+                d.target = offset / 4;
+        }
+        else if (d.op == BEQ)
+        {
+            long target = (long)i + 1 + d.imm;
+            if (target >= 0 and target < n)
+                d.target = (int)target;
+        }
+    }
+
+    for (int r = 0; r < NumRegisters; r++)
+        myRegisters[r] = 0;
+    myHI = myLO = 0;
+
+    myPC = 0;
+    myLastPage = 0;
+    myLastPageData = NULL;
+}
+
+
+long Executor::run(long maxSteps)
+/* Executes instructions until control leaves the program or maxSteps
+ * more instructions have been executed. May be called again to continue
+ * where the previous call stopped. Returns the number of instructions
+ * executed by this call.
+ */
+{
+    int n = myProgram.size();
+    long steps = 0;
+
+    // grow the trace once up front rather than while executing
+    if (maxSteps > 0 and maxSteps <= (1L << 24))
+        myTrace.reserve(myTrace.size() + maxSteps);
+
+    int pc = myPC;
+    while (pc >= 0 and pc < n and steps < maxSteps)
+    {
+        myTrace.push_back(pc);
+        pc = step(pc);
+        steps++;
+    }
+
+    myPC = pc;
+    return steps;
+}
+
+
+long Executor::runInOrder()
+/* Executes every instruction of the program once, in the order they are
+ * written, without following branches or jumps. This gives the register
+ * values a program simulated as written would compute, e.g., to find the
+ * addresses its loads access. Returns the number of instructions executed.
+ */
+{
+    int n = myProgram.size();
+    myTrace.reserve(myTrace.size() + n);
+
+    for (int pc = 0; pc < n; pc++)
+    {
+        myTrace.push_back(pc);
+        step(pc);
+    }
+
+    myPC = n;
+    return n;
+}
+
+
+int Executor::step(int pc)
+/* Executes the instruction at index pc and returns the index of the
+ * instruction that follows it.
+ */
+{
+    const DecodedInst &d = myProgram[pc];
+    int32_t *r = myRegisters;
+    int next = pc + 1;
+
+    switch (d.op)
+    {
+        case ADD:
+            r[d.rd] = (int32_t)((uint32_t)r[d.rs] + (uint32_t)r[d.rt]);
+            break;
+        case ADDI:
+            r[d.rt] = (int32_t)((uint32_t)r[d.rs] + (uint32_t)d.imm);
+            break;
+        case SUB:
+            r[d.rd] = (int32_t)((uint32_t)r[d.rs] - (uint32_t)r[d.rt]);
+            break;
+        case MULT:
+        {
+            int64_t product = (int64_t)r[d.rs] * (int64_t)r[d.rt];
+            myHI = (int32_t)(product >> 32);
+            myLO = (int32_t)product;
+            break;
+        }
+        case MFHI:
+            r[d.rd] = myHI;
+            break;
+        case SRL:
+            r[d.rd] = (int32_t)((uint32_t)r[d.rt] >> (d.imm & 31));
+            break;
+        case SRA:
+            r[d.rd] = r[d.rt] >> (d.imm & 31);
+            break;
+        case SLTI:
+            r[d.rt] = r[d.rs] < d.imm ? 1 : 0;
+            break;
+        case LW:
+        {
+            uint32_t addr = (uint32_t)r[d.rs] + (uint32_t)d.imm;
+            myLoadAddresses.push_back(addr);
+            r[d.rt] = loadWord(addr);
+            break;
+        }
+        case J:
+            next = d.target;
+            break;
+        case BEQ:
+            if (r[d.rs] == r[d.rt])
+                next = d.target;
+            break;
+        default:
+            break;
+    }
+
+    // $0 always reads as zero, whatever was written to it
+    r[0] = 0;
+    return next;
+}
+
+
+int Executor::loadWord(unsigned int addr)
+/* Returns the word stored at address addr in memory. Memory that has
+ * never been written holds 0.
+ */
+{
+    unsigned int word = addr >> 2;
+    unsigned int page = word / PAGE_WORDS;
+
+    if (myLastPageData == NULL or page != myLastPage)
+    {
+        map<unsigned int, vector<int32_t> >::iterator it = myMemory.find(page);
+        if (it == myMemory.end())
+            return 0;
+        myLastPage = page;
+        myLastPageData = &(it->second[0]);
+    }
+
+    return myLastPageData[word % PAGE_WORDS];
+}
+
+
+void Executor::storeWord(unsigned int addr, int value)
+/* Stores value at address addr in memory, e.g., to give a program its
+ * input data before running it.
+ */
+{
+    unsigned int word = addr >> 2;
+    unsigned int page = word / PAGE_WORDS;
+
+    vector<int32_t> &data = myMemory[page];
+    if (data.empty())
+        data.resize(PAGE_WORDS, 0);
+
+    myLastPage = page;
+    myLastPageData = &data[0];
+    myLastPageData[word % PAGE_WORDS] = value;
+}
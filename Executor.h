@@ -0,0 +1,126 @@
+// aalok sathe
+#ifndef _EXECUTOR_H_
+#define _EXECUTOR_H_
+
+using namespace std;
+
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "Instruction.h"
+#include "OpcodeTable.h"
+
+
+/* This class functionally executes a program made of supported MIPS
+ * instructions. It keeps a register file, the HI and LO registers and a
+ * sparse word-addressed memory, and resolves branches and jumps using the
+ * real values in those registers. The sequence of instructions it executes,
+ * given as indices into the static program, is the dynamic instruction
+ * stream that the pipeline models simulate.
+ */
+class Executor{
+
+ public:
+
+  /* Predecodes the static program so that executing an instruction does not
+   * need any table lookups. Execution starts at the first instruction.
+   */
+  Executor(vector<Instruction> &program);
+
+  /* Executes instructions until control leaves the program or maxSteps
+   * more instructions have been executed. May be called again to continue
+   * where the previous call stopped. Returns the number of instructions
+   * executed by this call.
+   */
+  long run(long maxSteps);
+
+  /* Executes every instruction of the program once, in the order they are
+   * written, without following branches or jumps. This gives the register
+   * values a program simulated as written would compute, e.g., to find the
+   * addresses its loads access. Returns the number of instructions executed.
+   */
+  long runInOrder();
+
+  /* Returns true if the program has run to completion, i.e., control has
+   * left the program.
+   */
+  bool isFinished() { return myPC < 0 or myPC >= (int)myProgram.size(); };
+
+  /* Returns the dynamic instruction stream executed so far; each entry is
+   * the index of an instruction in the static program.
+   */
+  const vector<int> &getTrace() { return myTrace; };
+
+  /* Returns the address accessed by each load executed so far, in the
+   * order the loads were executed.
+   */
+  const vector<unsigned int> &getLoadAddresses() { return myLoadAddresses; };
+
+  /* Returns the current value of register r */
+  int getRegister(int r) { return myRegisters[r]; };
+
+  /* Returns the current value of the HI register */
+  int getHI() { return myHI; };
+
+  /* Returns the current value of the LO register */
+  int getLO() { return myLO; };
+
+  /* Returns the word stored at address addr in memory. Memory that has
+   * never been written holds 0.
+   */
+  int loadWord(unsigned int addr);
+
+  /* Stores value at address addr in memory, e.g., to give a program its
+   * input data before running it.
+   */
+  void storeWord(unsigned int addr, int value);
+
+
+ private:
+
+  /* A predecoded instruction holding only what is needed to execute it.
+   * branch and jump targets are resolved to indices into the program, or
+   * -1 if they lead out of the program.
+   */
+  struct DecodedInst
+  {
+      Opcode op;
+      int rs;
+      int rt;
+      int rd;
+      int imm;
+      int target;
+  };
+
+  // the predecoded static program
+  vector<DecodedInst> myProgram;
+
+  // index of the next instruction to execute
+  int myPC;
+
+  // the architectural register state
+  int32_t myRegisters[NumRegisters];
+  int32_t myHI;
+  int32_t myLO;
+
+  // memory is kept in pages allocated when first written to. the most
+  // recently used page is remembered since accesses tend to be close
+  static const int PAGE_WORDS = 1024;
+  map<unsigned int, vector<int32_t> > myMemory;
+  unsigned int myLastPage;
+  int32_t *myLastPageData;
+
+  // the dynamic instruction stream executed so far
+  vector<int> myTrace;
+
+  // the address of each load executed so far
+  vector<unsigned int> myLoadAddresses;
+
+  /* Executes the instruction at index pc and returns the index of the
+   * instruction that follows it.
+   */
+  int step(int pc);
+
+};
+
+#endif
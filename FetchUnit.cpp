@@ -0,0 +1,108 @@
+// aalok sathe
+#include "FetchUnit.h"
+
+FetchUnit::FetchUnit(SimOptions &options, const vector<unsigned int> &pcs)
+    : myPCs(pcs), myCache(options.memLatency)
+/* Creates a fetch unit for the instruction stream whose instruction
+ * addresses, in the order they are to be fetched, are pcs. The cache,
+ * fetch block size, buffer depth and miss latency come from options.
+ */
+{
+    myCache.addLevel("L1 instruction cache",
+                     Cache(options.icache.size, options.icache.lineSize,
+                           options.icache.ways, options.replacement), 1);
+    myLineSize = max(4, options.icache.lineSize);
+    myBlockSize = max(4, options.fetchWidth);
+    myDepth = max(1, options.fetchBuffer);
+
+    myFetched = myArrived = 0;
+    myArrivalTime = myNextFetchTime = 0;
+}
+
+
+int FetchUnit::fetch(int t, int consumed)
+/* Lets the fetch unit work in clock tick t, when the pipeline has taken
+ * consumed instructions out of the fetch buffer so far. Returns how many
+ * instructions of the stream have arrived in the buffer by tick t,
+ * counting the ones already consumed.
+ */
+{
+    if (t >= myArrivalTime)
+        myArrived = myFetched;
+
+    int n = myPCs.size();
+    int space = myDepth - (myFetched - consumed);
+    if (t < myNextFetchTime or myFetched >= n or space <= 0)
+        return myArrived;
+
+    // read instructions of the block the next one is in, as long as they
+    // follow each other in the stream; look up each cache line touched
+    unsigned int block = myPCs[myFetched] / myBlockSize;
+    unsigned int line = myPCs[myFetched] / myLineSize;
+    int latency = myCache.access(myPCs[myFetched]);
+    myFetched++;
+    space--;
+    while (space > 0 and myFetched < n
+           and myPCs[myFetched] == myPCs[myFetched-1] + 4
+           and myPCs[myFetched] / myBlockSize == block)
+    {
+        if (myPCs[myFetched] / myLineSize != line)
+        {
+            line = myPCs[myFetched] / myLineSize;
+            latency = max(latency, myCache.access(myPCs[myFetched]));
+        }
+        myFetched++;
+        space--;
+    }
+
+    // a hit arrives in this same tick; a miss when it has been served
+    latency = max(1, latency);
+    myArrivalTime = t + latency - 1;
+    myNextFetchTime = t + latency;
+    if (latency == 1)
+        myArrived = myFetched;
+
+    return myArrived;
+}
+
+
+int FetchUnit::getNextFetchTime(int t, int consumed)
+/* Returns the first clock tick after t in which the fetch unit will put
+ * more instructions in the buffer if the pipeline consumes none, or 0 if
+ * it cannot until the pipeline consumes some.
+ */
+{
+    if (myArrived < myFetched)
+        return max(t + 1, myArrivalTime);
+    if (myFetched < (int)myPCs.size() and myFetched - consumed < myDepth)
+        return max(t + 1, myNextFetchTime);
+    return 0;
+}
+
+
+void FetchUnit::save(Checkpoint &checkpoint)
+/* Appends the state of the cache, fetch buffer and fetching to
+ * checkpoint.
+ */
+{
+    myCache.save(checkpoint);
+    checkpoint.putInt(myFetched);
+    checkpoint.putInt(myArrived);
+    checkpoint.putInt(myArrivalTime);
+    checkpoint.putInt(myNextFetchTime);
+}
+
+
+bool FetchUnit::load(Checkpoint &checkpoint)
+/* Reads back what save appended, into a fetch unit of the same shape.
+ * Returns false if the shape differs.
+ */
+{
+    if (not myCache.load(checkpoint))
+        return false;
+    myFetched = checkpoint.getInt();
+    myArrived = checkpoint.getInt();
+    myArrivalTime = checkpoint.getInt();
+    myNextFetchTime = checkpoint.getInt();
+    return checkpoint.isValid();
+}
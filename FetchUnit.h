@@ -0,0 +1,79 @@
+// aalok sathe
+#ifndef _FETCH_UNIT_H_
+#define _FETCH_UNIT_H_
+
+using namespace std;
+
+#include <vector>
+#include "SimOptions.h"
+#include "MemoryHierarchy.h"
+
+
+/* This class models the front end of a pipeline: an instruction cache, a
+ * fetch unit that reads one aligned block of a fixed number of bytes each
+ * clock tick, and a fetch buffer of a fixed number of instructions that the
+ * FETCH stage takes instructions from. A block ends early where the
+ * instruction stream leaves the sequential order, e.g., at a taken branch,
+ * since the next instructions then come from another block. A block that
+ * misses in the instruction cache only arrives in the buffer once the miss
+ * is served, and no other block is fetched meanwhile.
+ */
+class FetchUnit{
+
+ public:
+
+  /* Creates a fetch unit for the instruction stream whose instruction
+   * addresses, in the order they are to be fetched, are pcs. The cache,
+   * fetch block size, buffer depth and miss latency come from options.
+   */
+  FetchUnit(SimOptions &options, const vector<unsigned int> &pcs);
+
+  /* Lets the fetch unit work in clock tick t, when the pipeline has taken
+   * consumed instructions out of the fetch buffer so far. Returns how many
+   * instructions of the stream have arrived in the buffer by tick t,
+   * counting the ones already consumed.
+   */
+  int fetch(int t, int consumed);
+
+  /* Returns the first clock tick after t in which the fetch unit will put
+   * more instructions in the buffer if the pipeline consumes none, or 0 if
+   * it cannot until the pipeline consumes some.
+   */
+  int getNextFetchTime(int t, int consumed);
+
+  /* Prints the instruction cache hits and misses */
+  void printStatistics() { myCache.printStatistics(); };
+
+  /* Appends the state of the cache, fetch buffer and fetching to
+   * checkpoint.
+   */
+  void save(Checkpoint &checkpoint);
+
+  /* Reads back what save appended, into a fetch unit of the same shape.
+   * Returns false if the shape differs.
+   */
+  bool load(Checkpoint &checkpoint);
+
+
+ private:
+
+  // address of each instruction of the stream
+  vector<unsigned int> myPCs;
+
+  MemoryHierarchy myCache;
+  int myLineSize;
+  int myBlockSize;
+  int myDepth;
+
+  // instructions read from the cache so far, and how many of them are in
+  // the buffer; the rest arrive at myArrivalTime
+  int myFetched;
+  int myArrived;
+  int myArrivalTime;
+
+  // the first clock tick the next block may be fetched in
+  int myNextFetchTime;
+
+};
+
+#endif
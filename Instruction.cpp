@@ -62,7 +62,8 @@ void Instruction::setValues(Opcode op, Register rs, Register rt, Register rd, in
 InstType Instruction::getInstType()
 // Returns the type of instruction
 {
-  OpcodeTable opTable;
+  // the table is only read, so it is built once rather than on every call
+  static OpcodeTable opTable;
   if(myOpcode == UNDEFINED)
     return INVALID;
 
@@ -6,6 +6,10 @@
 #include "RegisterTable.h"
 #include <sstream>
 
+// Address at which the first instruction of a program is placed; each
+// following instruction occupies the next word
+const int TextBaseAddress = 0x400000;
+
 // This class provides an internal representation for a MIPS assembly instruction.
 // Any of the fields can be queried.  Additionally, the class stores a 32 bit binary
 // encoding of the MIPS instruction.
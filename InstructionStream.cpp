@@ -0,0 +1,165 @@
+// aalok sathe
+#include "InstructionStream.h"
+#include "ASMParser.h"
+#include "MachLangParser.h"
+
+InstructionStream::InstructionStream(string inputFile)
+  : myBlocks(4), myBatches(4)
+/* Starts reading inputFile, a MIPS assembly file if its extension is
+ * "asm" or a MIPS machine instruction file if it is "mach".
+ */
+{
+    myFile = NULL;
+    myParser = NULL;
+    myFormatCorrect = false;
+    myReading = false;
+    myDecoding = false;
+
+    string ext = inputFile.substr(inputFile.find_last_of('.')+1);
+    if (ext == "asm")
+        myParser = new ASMParser();
+    else if (ext == "mach")
+        myParser = new MachLangParser();
+    else
+        return;
+
+    // a file that cannot be opened has no lines
+    myFormatCorrect = true;
+    myFile = fopen(inputFile.c_str(), "rb");
+
+    // the decoder takes the blocks from the reader, so it only runs if the
+    // reader does; without them, getBatch does their work
+    myReading = (pthread_create(&myReader, NULL, runReader, this) == 0);
+    if (myReading)
+        myDecoding = (pthread_create(&myDecoder, NULL, runDecoder, this) == 0);
+}
+
+
+InstructionStream::~InstructionStream()
+/* Stops the reader and decoder, if they are still going */
+{
+    stop();
+    if (myFile != NULL)
+        fclose(myFile);
+    delete myParser;
+}
+
+
+void InstructionStream::stop()
+/* Closes both rings, which stops the reader and decoder early if the
+ * stream is not read to its end, and waits for them to finish.
+ */
+{
+    myBatches.close();
+    myBlocks.close();
+    if (myDecoding)
+        pthread_join(myDecoder, NULL);
+    if (myReading)
+        pthread_join(myReader, NULL);
+    myDecoding = false;
+    myReading = false;
+}
+
+
+bool InstructionStream::getBatch(vector<Instruction> &batch)
+/* Swaps the next batch of instructions into batch, waiting for it to be
+ * decoded. Returns false once every batch has been taken.
+ */
+{
+    if (myDecoding)
+        return myBatches.pop(batch);
+
+    // decode here, after the first line that fails there is nothing more
+    string block;
+    if (myParser == NULL or not myFormatCorrect)
+        return false;
+    if (not (myReading ? myBlocks.pop(block) : readBlock(block)))
+        return false;
+    batch.clear();
+    if (not myParser->parseBlock(block, batch))
+    {
+        myFormatCorrect = false;
+        myBlocks.close();
+    }
+    return true;
+}
+
+
+void InstructionStream::getChanges(vector<pair<int, Instruction> > &changed)
+/* Once getBatch has returned false, gives the instructions of the
+ * batches that changed once the whole file was read, each with its
+ * index, e.g. branches to labels defined after them.
+ */
+{
+    stop();
+    changed.clear();
+    if (myParser != NULL and myFormatCorrect)
+        myParser->finishBlocks(changed);
+}
+
+
+bool InstructionStream::readBlock(string &block)
+/* Reads the next block of whole lines of the file into block. Returns
+ * false at the end of the file.
+ */
+{
+    block.swap(myRest);
+    myRest.clear();
+    if (myFile == NULL)
+        return false;
+
+    // read until the block holds at least one whole line; what follows its
+    // last newline starts the next block
+    char buffer[BLOCK_SIZE];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), myFile)) > 0)
+    {
+        size_t size = block.size();
+        block.append(buffer, got);
+        size_t newline = block.find_last_of('\n');
+        if (newline == string::npos or newline < size)
+            continue;
+        myRest.assign(block, newline + 1, string::npos);
+        block.erase(newline + 1);
+        return true;
+    }
+
+    // the last line need not end with a newline
+    return not block.empty();
+}
+
+
+void *InstructionStream::runReader(void *stream)
+/* The body of the reader thread; stream is the InstructionStream */
+{
+    InstructionStream *self = (InstructionStream *)stream;
+    string block;
+    while (self->readBlock(block))
+        if (not self->myBlocks.push(block))
+            break;
+    self->myBlocks.close();
+    return NULL;
+}
+
+
+void *InstructionStream::runDecoder(void *stream)
+/* The body of the decoder thread; stream is the InstructionStream */
+{
+    InstructionStream *self = (InstructionStream *)stream;
+    string block;
+    vector<Instruction> batch;
+    while (self->myBlocks.pop(block))
+    {
+        batch.clear();
+        bool correct = self->myParser->parseBlock(block, batch);
+        if (not correct)
+            self->myFormatCorrect = false;
+        if (not self->myBatches.push(batch) or not correct)
+            break;
+    }
+
+    // the reader stops too if this stopped early
+    self->myBlocks.close();
+    self->myBatches.close();
+    return NULL;
+}
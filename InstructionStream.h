@@ -0,0 +1,91 @@
+// aalok sathe
+#ifndef _INSTRUCTION_STREAM_H_
+#define _INSTRUCTION_STREAM_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <pthread.h>
+#include "Parser.h"
+#include "RingBuffer.h"
+
+
+/* This class reads the instructions of a MIPS assembly or machine
+ * instruction file as a pipeline of threads: a reader thread reads the
+ * file a block of whole lines at a time, a decoder thread parses each
+ * block into a batch of instructions, and the thread that made the stream
+ * takes the batches in order with getBatch, e.g. to check their
+ * dependences, while the next ones are read and decoded. The stages pass
+ * blocks and batches through RingBuffers of a few entries, so that each
+ * stage waits for the one after it rather than reading the whole file
+ * ahead, and the whole runs about as fast as its slowest stage.
+ */
+class InstructionStream{
+
+ public:
+
+  /* Starts reading inputFile, a MIPS assembly file if its extension is
+   * "asm" or a MIPS machine instruction file if it is "mach".
+   */
+  InstructionStream(string inputFile);
+
+  /* Stops the reader and decoder, if they are still going */
+  ~InstructionStream();
+
+  /* Swaps the next batch of instructions into batch, waiting for it to be
+   * decoded. Returns false once every batch has been taken.
+   */
+  bool getBatch(vector<Instruction> &batch);
+
+  /* Once getBatch has returned false, returns true if the file was
+   * syntactically correct and only contained supported instructions.
+   */
+  bool isFormatCorrect() { return myFormatCorrect; };
+
+  /* Once getBatch has returned false, gives the instructions of the
+   * batches that changed once the whole file was read, each with its
+   * index, e.g. branches to labels defined after them.
+   */
+  void getChanges(vector<pair<int, Instruction> > &changed);
+
+
+ private:
+
+  /* Reads the next block of whole lines of the file into block. Returns
+   * false at the end of the file.
+   */
+  bool readBlock(string &block);
+
+  /* Closes both rings, which stops the reader and decoder early if the
+   * stream is not read to its end, and waits for them to finish.
+   */
+  void stop();
+
+  /* The body of the reader thread; stream is the InstructionStream */
+  static void *runReader(void *stream);
+
+  /* The body of the decoder thread; stream is the InstructionStream */
+  static void *runDecoder(void *stream);
+
+  // bytes read from the file at a time
+  static const size_t BLOCK_SIZE = 1 << 16;
+
+  FILE *myFile;
+  string myRest;            // the last, partial line of the block read
+  Parser *myParser;
+  bool myFormatCorrect;
+
+  // blocks read and not yet decoded, and batches decoded and not taken
+  RingBuffer<string> myBlocks;
+  RingBuffer<vector<Instruction> > myBatches;
+
+  // whether the reader and decoder threads are running; without them,
+  // getBatch reads and decodes each block itself
+  pthread_t myReader, myDecoder;
+  bool myReading, myDecoding;
+
+};
+
+#endif
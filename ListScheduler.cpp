@@ -0,0 +1,203 @@
+// aalok sathe
+#include "ListScheduler.h"
+#include <algorithm>
+
+ListScheduler::ListScheduler(string inputFile, Pipeline &model)
+    : myProgram(inputFile)
+/* Reads the program in inputFile, a MIPS assembly or machine instruction
+ * file, and reorders each of its basic blocks using the value delays of
+ * model.
+ */
+{
+    myNumBlocks = myNumReordered = 0;
+    if (not myProgram.isFormatCorrect())
+        return;
+
+    int n = myProgram.size();
+    myOrder.resize(n);
+    for (int k = 0; k < n; k++)
+        myOrder[k] = k;
+
+    vector<int> starts = myProgram.getBlockStarts();
+    for (unsigned int b = 0; b + 1 < starts.size(); b++)
+        scheduleBlock(starts[b], starts[b+1], model);
+}
+
+
+void ListScheduler::scheduleBlock(int begin, int end, Pipeline &model)
+/* Reorders the instructions from begin up to, but not including, end,
+ * which form one basic block, and stores the new order in myOrder.
+ */
+{
+    int m = end - begin;
+    myNumBlocks++;
+    if (m < 2)
+        return;
+
+    // find the dependences inside the block. each register remembers its
+    // last writer and the instructions that read it since, so that every
+    // reordering that would change a value is ruled out
+    vector<Dependence> deps;
+    vector<int> weights;
+    vector<int> lastWriter(DependencyChecker::HI_REGISTER + 1, -1);
+    vector<vector<int> > readers(DependencyChecker::HI_REGISTER + 1);
+    for (int i = 0; i < m; i++)
+    {
+        Instruction &inst = myProgram.getInstruction(begin + i);
+        int src[2], dst;
+        myDependencyChecker.getRegisters(inst, src, dst);
+
+        Dependence d;
+        d.currentInstructionNumber = i;
+        for (int j = 0; j < 2; j++)
+        {
+            if (src[j] < 0 or lastWriter[src[j]] < 0)
+                continue;
+            int p = lastWriter[src[j]];
+            d.dependenceType = RAW;
+            d.registerNumber = src[j];
+            d.previousInstructionNumber = p;
+            deps.push_back(d);
+            weights.push_back(max(1, model.getValueDelay(
+                myProgram.getInstruction(begin + p).getOpcode(), inst.getOpcode())));
+        }
+        for (int j = 0; j < 2; j++)
+            if (src[j] >= 0)
+                readers[src[j]].push_back(i);
+
+        if (dst >= 0)
+        {
+            d.registerNumber = dst;
+            if (lastWriter[dst] >= 0)
+            {
+                d.dependenceType = WAW;
+                d.previousInstructionNumber = lastWriter[dst];
+                deps.push_back(d);
+                weights.push_back(1);
+            }
+            for (unsigned int r = 0; r < readers[dst].size(); r++)
+            {
+                if (readers[dst][r] == i)
+                    continue;
+                d.dependenceType = WAR;
+                d.previousInstructionNumber = readers[dst][r];
+                deps.push_back(d);
+                weights.push_back(0);
+            }
+            readers[dst].clear();
+            lastWriter[dst] = i;
+        }
+    }
+
+    // a control instruction ending the block has to stay last
+    int last = m - 1;
+    if (myOpcodes.getInstFunc(myProgram.getInstruction(begin + last).getOpcode()) == CONTROL_I)
+    {
+        Dependence d;
+        d.dependenceType = D_UNDEFINED;
+        d.registerNumber = 0;
+        d.currentInstructionNumber = last;
+        for (int i = 0; i < last; i++)
+        {
+            d.previousInstructionNumber = i;
+            deps.push_back(d);
+            weights.push_back(1);
+        }
+    }
+
+    DependenceGraph graph(m, deps, weights);
+
+    // the priority of an instruction is the longest chain of delays from it
+    // to the end of the block; edges only go forward, so walk backwards
+    vector<int> height(m, 0), preds(m, 0);
+    for (int i = m - 1; i >= 0; i--)
+        for (int e = graph.beginEdge(i); e < graph.endEdge(i); e++)
+        {
+            height[i] = max(height[i], graph.getWeight(e) + height[graph.getTarget(e)]);
+            preds[graph.getTarget(e)]++;
+        }
+
+    // instructions whose dependences are all placed wait in waiting until
+    // the tick their values are available, then in ready until they are
+    // the highest priority one. ties keep the original order
+    priority_queue<pair<int,int>, vector<pair<int,int> >,
+                   greater<pair<int,int> > > waiting;
+    priority_queue<pair<int,int> > ready;
+    vector<int> earliest(m, 0), order;
+    order.reserve(m);
+    for (int i = 0; i < m; i++)
+        if (preds[i] == 0)
+            waiting.push(make_pair(0, i));
+
+    int t = 0;
+    while ((int)order.size() < m)
+    {
+        while (not waiting.empty() and waiting.top().first <= t)
+        {
+            int i = waiting.top().second;
+            waiting.pop();
+            ready.push(make_pair(height[i], -i));
+        }
+        if (ready.empty())
+        {
+            t = waiting.top().first;
+            continue;
+        }
+
+        int i = -ready.top().second;
+        ready.pop();
+        order.push_back(i);
+        for (int e = graph.beginEdge(i); e < graph.endEdge(i); e++)
+        {
+            int s = graph.getTarget(e);
+            earliest[s] = max(earliest[s], t + graph.getWeight(e));
+            if (--preds[s] == 0)
+                waiting.push(make_pair(earliest[s], s));
+        }
+        t++;
+    }
+
+    // list scheduling is a heuristic, so keep the original order unless the
+    // new one is faster
+    vector<int> original(m);
+    for (int i = 0; i < m; i++)
+        original[i] = i;
+    if (getBlockTime(graph, order) >= getBlockTime(graph, original))
+        return;
+
+    myNumReordered++;
+    for (int i = 0; i < m; i++)
+        myOrder[begin + i] = begin + order[i];
+}
+
+
+int ListScheduler::getBlockTime(DependenceGraph &graph, const vector<int> &order)
+/* Returns the clock tick the last instruction of a block starts in when
+ * the nodes of graph are executed in the given order, one per tick at
+ * most, each after the ticks its incoming edges ask for.
+ */
+{
+    int m = order.size();
+    vector<int> earliest(m, 0);
+    int t = -1;
+    for (int k = 0; k < m; k++)
+    {
+        int i = order[k];
+        t = max(t + 1, earliest[i]);
+        for (int e = graph.beginEdge(i); e < graph.endEdge(i); e++)
+            earliest[graph.getTarget(e)] = max(earliest[graph.getTarget(e)],
+                                               t + graph.getWeight(e));
+    }
+    return t;
+}
+
+
+bool ListScheduler::write(string outputFile)
+/* Writes the reordered program to outputFile, as assembly if its
+ * extension is "asm" and as machine instructions if it is "mach".
+ * Labels of assembly input stay at the same positions. Returns false if
+ * the file could not be written.
+ */
+{
+    return myProgram.write(outputFile, myOrder);
+}
@@ -0,0 +1,82 @@
+// aalok sathe
+#ifndef _LIST_SCHEDULER_H_
+#define _LIST_SCHEDULER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include "Pipeline.h"
+#include "DependenceGraph.h"
+#include "Program.h"
+
+
+/* This class reorders the instructions of a program to reduce the clock
+ * ticks a pipeline model loses waiting for values. The program is split
+ * into basic blocks, which end at a control instruction or right before a
+ * label or branch target, and only instructions within a block are moved;
+ * control instructions stay at the end of their blocks, so branch offsets
+ * and jump addresses still hold. Within a block, an instruction may not
+ * move past another it has a RAW, WAR or WAW dependence with, and among
+ * the instructions that are ready to start, the one with the longest chain
+ * of value delays after it goes first (list scheduling).
+ */
+class ListScheduler{
+
+ public:
+
+  /* Reads the program in inputFile, a MIPS assembly or machine instruction
+   * file, and reorders each of its basic blocks using the value delays of
+   * model.
+   */
+  ListScheduler(string inputFile, Pipeline &model);
+
+  /* Returns true if the input file was syntactically correct and only
+   * contained supported instructions.  Otherwise, returns false.
+   */
+  bool isFormatCorrect() { return myProgram.isFormatCorrect(); };
+
+  /* Writes the reordered program to outputFile, as assembly if its
+   * extension is "asm" and as machine instructions if it is "mach".
+   * Labels of assembly input stay at the same positions. Returns false if
+   * the file could not be written.
+   */
+  bool write(string outputFile);
+
+  /* Returns the number of basic blocks in the program */
+  int getNumBlocks() { return myNumBlocks; };
+
+  /* Returns the number of basic blocks whose order changed */
+  int getNumReordered() { return myNumReordered; };
+
+
+ private:
+
+  /* Reorders the instructions from begin up to, but not including, end,
+   * which form one basic block, and stores the new order in myOrder.
+   */
+  void scheduleBlock(int begin, int end, Pipeline &model);
+
+  /* Returns the clock tick the last instruction of a block starts in when
+   * the nodes of graph are executed in the given order, one per tick at
+   * most, each after the ticks its incoming edges ask for.
+   */
+  int getBlockTime(DependenceGraph &graph, const vector<int> &order);
+
+  // the program as read
+  Program myProgram;
+
+  // index into myProgram of the instruction placed at each position
+  vector<int> myOrder;
+
+  int myNumBlocks;
+  int myNumReordered;
+
+  // used for the registers each instruction reads and writes, and for
+  // the kind of each instruction
+  DependencyChecker myDependencyChecker;
+  OpcodeTable myOpcodes;
+
+};
+
+#endif
@@ -19,29 +19,55 @@ MachLangParser::MachLangParser(string inputfile)
     myFormatCorrect = true;
     myIndex = 0;
 
-    // Initialize 'Instruction' to store decoded instruction
-    Instruction i;
-
-    // open input filestream for reading
-    ifstream in;
-    in.open(inputfile.c_str());
-
-    // if failed to open the file for reading, stop
-    if (in.bad())
+    // read the file and split it into chunks of lines, which are parsed
+    // on threads of their own; a file that cannot be opened has no lines
+    readChunks(inputfile);
+    int count = getChunkCount();
+    myChunks.assign(count, Chunk());
+    runChunks(0);
+
+    // keep the instructions up to the first line that fails
+    for (int k = 0; k < count; k++)
     {
-        myFormatCorrect = false;
-        return;
+        myInstructions.insert(myInstructions.end(),
+                              myChunks[k].instructions.begin(),
+                              myChunks[k].instructions.end());
+        if (myChunks[k].failed)
+        {
+            myFormatCorrect = false;
+            break;
+        }
     }
 
-    // process for each line in the file
+    myChunks.clear();
+    myText.clear();
+}
+
+
+void MachLangParser::parseChunk(int k, int pass)
+// Parses the lines of chunk k of the file into its instructions, up to
+// the first line that is not a supported instruction.
+//
+// Parameters:
+//     int k := the chunk to parse
+//     int pass := unused, there is a single pass
+{
+    Chunk &chunk = myChunks[k];
+    chunk.failed = false;
+
+    // Initialize 'Instruction' to store decoded instruction
+    Instruction i;
+
+    // process for each line in the chunk
+    size_t pos = myChunkStarts[k];
     string line;
-    while (getline(in, line))
+    while (getLine(pos, myChunkStarts[k+1], line))
     {
         // make sure the line meets basic format requirements
         // such as length and valid characters
         if (not isLineCorrect(line))
         {
-            myFormatCorrect = false;
+            chunk.failed = true;
             break;
         }
         i.setEncoding(line);
@@ -53,21 +79,105 @@ MachLangParser::MachLangParser(string inputfile)
         // check if the instruction is supported
         if (i.getOpcode() == UNDEFINED)
         {
-            myFormatCorrect = false;
+            chunk.failed = true;
             break;
         }
         // call the 'encode' method to put together
         // the assembly syntax
         assemble(i);
 
-        // store instructions in private container
+        // store instructions in the chunk's container
         // after processing them
-        myInstructions.push_back(i);
+        chunk.instructions.push_back(i);
 
     }
 }
 
 
+MachLangParser::MachLangParser()
+// Creates a parser with no instructions, to parse a file a block at a
+// time with parseBlock.
+{
+    myFormatCorrect = true;
+    myIndex = 0;
+}
+
+
+bool MachLangParser::parseBlock(const string &text, vector<Instruction> &instructions)
+// Parses text, whole lines that follow those of the blocks parsed before,
+// and appends their instructions to instructions.  Returns false at the
+// first line that is not a supported instruction.
+//
+// Parameters:
+//     const string &text := the lines of the block
+//     vector<Instruction> &instructions := where its instructions go
+{
+    // the block is parsed as the one chunk of a file of its own
+    myText = text;
+    myChunkStarts.assign(1, 0);
+    myChunkStarts.push_back(myText.size());
+    myChunks.assign(1, Chunk());
+    parseChunk(0, 0);
+
+    instructions.insert(instructions.end(), myChunks[0].instructions.begin(),
+                        myChunks[0].instructions.end());
+    if (myChunks[0].failed)
+        myFormatCorrect = false;
+
+    myChunks.clear();
+    myText.clear();
+    return myFormatCorrect;
+}
+
+
+bool MachLangParser::decodeWord(uint32_t word, Instruction &i)
+// Decodes the instruction encoded by word into i, with its fields and
+// assembly text, taking the fields straight from the bits rather than
+// from a line of text.  Returns false if it is not a supported
+// instruction.
+//
+// Parameters:
+//     uint32_t word := the encoding, its first bit the highest
+//     Instruction &i := where the instruction goes
+{
+    // the fields, from the highest bits down, as decodeRType,
+    // decodeIType and decodeJType split the line
+    int rsShift = ARCH_NUM_BITS - OPCODE_LEN - REG_WIDTH;
+    int rtShift = rsShift - REG_WIDTH;
+    int rdShift = rtShift - REG_WIDTH;
+    int shamtShift = rdShift - SHAMT_LEN;
+    unsigned int reg = (1u << REG_WIDTH) - 1;
+
+    Opcode opc = opcodes.getInstr(word >> (ARCH_NUM_BITS - OPCODE_LEN),
+                                  word & ((1u << FUNCT_LEN) - 1));
+    if (opc == UNDEFINED)
+        return false;
+
+    InstType type = opcodes.getInstType(opc);
+    if (type == RTYPE)
+        i.setValues(opc, (word >> rsShift) & reg, (word >> rtShift) & reg,
+                    (word >> rdShift) & reg, (word >> shamtShift) & ((1u << SHAMT_LEN) - 1));
+    else if (type == ITYPE)
+        // the immediate is sign extended
+        i.setValues(opc, (word >> rsShift) & reg, (word >> rtShift) & reg,
+                    NumRegisters, (int16_t)(word & ((1u << IMM_WIDTH) - 1)));
+    else
+        // the address is sign extended, and holds the byte address
+        // without its last two 0 bits
+        i.setValues(opc, NumRegisters, NumRegisters, NumRegisters,
+                    ((int32_t)(word << OPCODE_LEN) >> OPCODE_LEN) * 4);
+
+    string encoding(ARCH_NUM_BITS, '0');
+    for (int b = 0; b < ARCH_NUM_BITS; b++)
+        if (word & (1u << (ARCH_NUM_BITS - 1 - b)))
+            encoding[b] = '1';
+    i.setEncoding(encoding);
+
+    assemble(i);
+    return true;
+}
+
+
 MachLangParser::~MachLangParser()
 // Default deconstructor for the MachLangParser class
 {}
@@ -249,13 +359,15 @@ void MachLangParser::decodeJType(Instruction& i)
 
     // set the appropriate fields of the instruction
     // and pass 'NumRegisters' to the places that are
-    // not applicable
+    // not applicable. the address field drops the last
+    // two 0 bits, so multiply by 4 to store the byte
+    // address of the target as ASMParser does
     i.setValues(
         opc,
         NumRegisters,
         NumRegisters,
         NumRegisters,
-        convertToInt(addr, SIGNED)
+        convertToInt(addr, SIGNED)*4
     );
 }
 
@@ -447,9 +559,9 @@ string MachLangParser::assembleJType(Instruction i)
         else if (opcodes.RTposition(opc) == it)
             assembled << "$" << i.getRT();
         else if (opcodes.IMMposition(opc) == it)
-            // multiply by 4 to account for truncation of
-            // last two 0 bits; pass 'hex' flag for hex output
-            assembled << "0x" << hex << i.getImmediate()*4;
+            // the immediate already holds the byte address;
+            // pass 'hex' flag for hex output
+            assembled << "0x" << hex << i.getImmediate();
 
         // we don't want a comma at the end
         if (it < opcodes.numOperands(opc) - 1)
@@ -10,6 +10,7 @@ using namespace std;
 #include <sstream>
 #include <stdlib.h>
 #include <bitset>
+#include <stdint.h>
 #include "Parser.h"
 #include "Instruction.h"
 #include "RegisterTable.h"
@@ -45,6 +46,10 @@ class MachLangParser : public Parser{
   //
   MachLangParser(string input_file);
 
+  // Creates a parser with no instructions, to parse a file a block at a
+  // time with parseBlock.
+  MachLangParser();
+
   // Destructor
   ~MachLangParser();
 
@@ -55,6 +60,17 @@ class MachLangParser : public Parser{
   // Iterator that returns the next Instruction in the list of Instructions.
   Instruction getNextInstruction();
 
+  // Parses text, whole lines that follow those of the blocks parsed before,
+  // and appends their instructions to instructions.  Returns false at the
+  // first line that is not a supported instruction.
+  bool parseBlock(const string &text, vector<Instruction> &instructions);
+
+  // Decodes the instruction encoded by word into i, with its fields and
+  // assembly text, taking the fields straight from the bits rather than
+  // from a line of text.  Returns false if it is not a supported
+  // instruction.
+  bool decodeWord(uint32_t word, Instruction &i);
+
  private:
     // private container of Instruction objects
     vector<Instruction> myInstructions;
@@ -65,6 +81,22 @@ class MachLangParser : public Parser{
     // iterator index to use with getNextInstruction
     int myIndex;
 
+    // the instructions parsed from a chunk of the file's lines, up to the
+    // first line that fails, if any
+    struct Chunk{
+        vector<Instruction> instructions;
+        bool failed;
+    };
+    vector<Chunk> myChunks;
+
+    // Parses the lines of chunk k of the file into its instructions, up to
+    // the first line that is not a supported instruction.
+    //
+    // Parameters:
+    //     int k := the chunk to parse
+    //     int pass := unused, there is a single pass
+    void parseChunk(int k, int pass);
+
     // private instance of OpcodeTable for various methods
     OpcodeTable opcodes;
 
@@ -0,0 +1,75 @@
+// aalok sathe
+#include "MemoryHierarchy.h"
+
+MemoryHierarchy::MemoryHierarchy(int memLatency)
+/* Creates a hierarchy with no cache levels, in which every access takes
+ * memLatency clock ticks.
+ */
+{
+    myMemLatency = memLatency;
+}
+
+
+void MemoryHierarchy::addLevel(string name, Cache level, int latency)
+/* Adds a cache level below the levels already added. An access that hits
+ * in it takes latency clock ticks. name is used when printing statistics.
+ */
+{
+    myNames.push_back(name);
+    myLevels.push_back(level);
+    myLatencies.push_back(latency);
+}
+
+
+int MemoryHierarchy::access(unsigned int addr)
+/* Accesses the word at address addr and returns how many clock ticks the
+ * access takes.
+ */
+{
+    // a level that misses brings the line in, so keep going down to fill
+    // every level until one hits
+    for (unsigned int k = 0; k < myLevels.size(); k++)
+        if (myLevels[k].access(addr))
+            return myLatencies[k];
+
+    return myMemLatency;
+}
+
+
+void MemoryHierarchy::printStatistics()
+/* Prints the number of hits and misses of each level */
+{
+    for (unsigned int k = 0; k < myLevels.size(); k++)
+    {
+        long hits = myLevels[k].getHits();
+        long misses = myLevels[k].getMisses();
+        cout << myNames[k] << ": " << hits << " hits, " << misses
+             << " misses";
+        if (hits + misses > 0)
+            cout << ", miss rate " << 100.0 * misses / (hits + misses) << "%";
+        cout << endl;
+    }
+}
+
+
+void MemoryHierarchy::save(Checkpoint &checkpoint)
+/* Appends the state of each level to checkpoint */
+{
+    checkpoint.putInt(myLevels.size());
+    for (unsigned int k = 0; k < myLevels.size(); k++)
+        myLevels[k].save(checkpoint);
+}
+
+
+bool MemoryHierarchy::load(Checkpoint &checkpoint)
+/* Reads back what save appended, into a hierarchy of the same levels.
+ * Returns false if the levels differ.
+ */
+{
+    if (checkpoint.getInt() != (int64_t)myLevels.size())
+        return false;
+    for (unsigned int k = 0; k < myLevels.size(); k++)
+        if (not myLevels[k].load(checkpoint))
+            return false;
+    return true;
+}
@@ -0,0 +1,58 @@
+// aalok sathe
+#ifndef _MEMORY_HIERARCHY_H_
+#define _MEMORY_HIERARCHY_H_
+
+using namespace std;
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include "Cache.h"
+
+
+/* This class models the levels of cache between the pipeline and main
+ * memory. An access looks in each level in turn until one holds the line,
+ * bringing the line into every level that missed, and takes as many clock
+ * ticks as the level that supplied the data, or main memory if none did.
+ */
+class MemoryHierarchy{
+
+ public:
+
+  /* Creates a hierarchy with no cache levels, in which every access takes
+   * memLatency clock ticks.
+   */
+  MemoryHierarchy(int memLatency);
+
+  /* Adds a cache level below the levels already added. An access that hits
+   * in it takes latency clock ticks. name is used when printing statistics.
+   */
+  void addLevel(string name, Cache level, int latency);
+
+  /* Accesses the word at address addr and returns how many clock ticks the
+   * access takes.
+   */
+  int access(unsigned int addr);
+
+  /* Prints the number of hits and misses of each level */
+  void printStatistics();
+
+  /* Appends the state of each level to checkpoint */
+  void save(Checkpoint &checkpoint);
+
+  /* Reads back what save appended, into a hierarchy of the same levels.
+   * Returns false if the levels differ.
+   */
+  bool load(Checkpoint &checkpoint);
+
+
+ private:
+
+  vector<string> myNames;
+  vector<Cache> myLevels;
+  vector<int> myLatencies;
+  int myMemLatency;
+
+};
+
+#endif
@@ -45,6 +45,7 @@ OpcodeTable::OpcodeTable()
     myArray[MULT].rtPos = 1;
     myArray[MULT].immPos = -1;
     myArray[MULT].instType = RTYPE;
+    myArray[MULT].unit = MULT_UNIT;
     myArray[MULT].op_field = "000000";
     myArray[MULT].funct_field = "011000";
 
@@ -101,6 +102,7 @@ OpcodeTable::OpcodeTable()
     myArray[LW].immPos = 1;
     myArray[LW].instType = ITYPE;
     myArray[LW].instFunc = MEMORY_I;
+    myArray[LW].unit = MEM_UNIT;
     myArray[LW].op_field = "100011";
     myArray[LW].funct_field = "";
 
@@ -251,6 +253,26 @@ Opcode OpcodeTable::getInstr(string opc, string funct)
 }
 
 
+Opcode OpcodeTable::getInstr(unsigned int opc, unsigned int funct)
+// As above, given the values of the opcode field and the funct
+// field, e.g. as taken from an encoding word
+{
+    for (int i = 0; i < (int)UNDEFINED; i++)
+    {
+        bitset<OPCODE_LEN> op_bits(myArray[i].op_field);
+        if (op_bits.to_ulong() != opc)
+            continue;
+        if (opc != 0)
+            return (Opcode)i;
+        bitset<OPCODE_LEN> funct_bits(myArray[i].funct_field);
+        if (funct_bits.to_ulong() == funct)
+            return (Opcode)i;
+    }
+
+    return UNDEFINED;
+}
+
+
 string OpcodeTable::getName(Opcode o)
 // Given a valid Opcode (enum member) o, returns
 // the string name of the instruction corresponding
@@ -273,3 +295,14 @@ InstFunc OpcodeTable::getInstFunc(Opcode o)
     else
         return (InstFunc)-1;
 }
+
+
+FunctionalUnit OpcodeTable::getFunctionalUnit(Opcode o)
+// Given a valid Opcode (enum member) o, returns the
+// FunctionalUnit the corresponding instruction executes on
+{
+    if (o >= 0 and o < UNDEFINED)
+        return myArray[o].unit;
+    else
+        return ALU_UNIT;
+}
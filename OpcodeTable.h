@@ -43,6 +43,16 @@ enum InstFunc{
 };
 
 
+// The functional units instructions execute on. Instructions on the same
+// unit compete for it; ALU_UNIT stands for as many ALUs as are needed
+enum FunctionalUnit{
+    ALU_UNIT,
+    MULT_UNIT,
+    MEM_UNIT,
+    NUM_UNITS
+};
+
+
 /* This class represents templates for supported MIPS instructions.  For every supported
  * MIPS instruction, the OpcodeTable includes information about the opcode, expected
  * operands, and other fields.
@@ -98,6 +108,11 @@ class OpcodeTable
         Opcode getInstr(string opc, string funct);
 
 
+        // As above, given the values of the opcode field and the funct
+        // field, e.g. as taken from an encoding word
+        Opcode getInstr(unsigned int opc, unsigned int funct);
+
+
         // Given a valid Opcode (enum member) o, returns
         // the string name of the instruction corresponding
         // to it
@@ -110,6 +125,11 @@ class OpcodeTable
         InstFunc getInstFunc(Opcode o);
 
 
+        // Given a valid Opcode (enum member) o, returns the
+        // FunctionalUnit the corresponding instruction executes on
+        FunctionalUnit getFunctionalUnit(Opcode o);
+
+
     private:
 
         // Provides information about how where to find values in a MIPS assembly
@@ -127,6 +147,7 @@ class OpcodeTable
 
             InstType instType;
             InstFunc instFunc;
+            FunctionalUnit unit;
             string op_field;
             string funct_field;
 
@@ -137,6 +158,7 @@ class OpcodeTable
                 rdPos = rsPos = rtPos = immPos = -1;
                 immLabel = false;
                 instFunc = ARITHM_I; // basic kind of instruction function
+                unit = ALU_UNIT;
             };
         };
 
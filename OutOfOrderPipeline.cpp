@@ -0,0 +1,314 @@
+// aalok sathe
+#include "OutOfOrderPipeline.h"
+
+OutOfOrderPipeline::OutOfOrderPipeline(string inputFile, SimOptions options)
+    : Pipeline(inputFile, options)
+/* Default constructor for the OutOfOrderPipeline class.
+ * Uses the inherited constructor, sets the header title, and reads the sizes
+ * of its structures from options. Values are forwarded to consumers as soon
+ * as they are computed, so the ValueSchedule items match the data forwarding
+ * model; they give the number of ticks until a result can be used.
+ */
+{
+    initializeModel();
+}
+
+
+OutOfOrderPipeline::OutOfOrderPipeline(const vector<Instruction> &program, SimOptions options)
+    : Pipeline(program, options)
+/* Constructs the model with program, instructions already parsed, as
+ * Pipeline does.
+ */
+{
+    initializeModel();
+}
+
+
+void OutOfOrderPipeline::initializeModel()
+/* Sets up what this model adds to Pipeline, for the constructors */
+{
+    myOutput.myPipelineType = "OUT-OF-ORDER";
+
+    myDataSchedule.insert(make_pair(ARITHM_I, ValueSchedule(EXECUTE, EXECUTE)));
+    myDataSchedule.insert(make_pair(MEMORY_I, ValueSchedule(EXECUTE, MEMORY)));
+    myDataSchedule.insert(make_pair(CONTROL_I, ValueSchedule(EXECUTE, EXECUTE)));
+
+    // PIPESIM refuses sizes out of range; options built by a program are
+    // brought into range
+    myRobSize = max(1, myOptions.robSize);
+    myWidth = max(1, myOptions.issueWidth);
+    myRsSize = max(1, myOptions.rsSize);
+    if (myRsSize > MAX_RS)
+        myRsSize = MAX_RS;
+
+    myWarTotal = myWarInFlight = myWawTotal = myWawInFlight = 0;
+}
+
+
+void OutOfOrderPipeline::execute()
+/* Simulates the instructions on the out-of-order pipeline and stores the
+ * commit time of each instruction as its completion time.
+ */
+{
+    // a streamed input is read in full first, since the reorder buffer
+    // may reach far past the instructions that have finished
+    finishStream();
+    int n = getNumInstructions();
+    if (n == 0)
+        return;
+
+    // predecode the registers, functional unit and kind of each instruction,
+    // and the stage after EXECUTE its result is produced in. the time spent
+    // on the unit is only known at issue, since loads look up the data cache
+    vector<int> srcs(2*n), dsts(n), produced(n), units(n);
+    vector<bool> control(n), pipelined(n);
+    for (int i = 0; i < n; i++)
+    {
+        myDependencyChecker.getRegisters(getInstruction(i), &srcs[2*i], dsts[i]);
+        Opcode opc = getOpcode(i);
+        InstFunc func = myOpcodes.getInstFunc(opc);
+        produced[i] = myDataSchedule[func].produced - EXECUTE;
+        units[i] = myOpcodes.getFunctionalUnit(opc);
+        pipelined[i] = myOptions.pipelined[opc];
+        control[i] = (func == CONTROL_I);
+    }
+
+    // the clock tick from which each functional unit can start another
+    // instruction; there are as many ALUs as the issue width
+    int unitFree[NUM_UNITS];
+    for (int u = 0; u < NUM_UNITS; u++)
+        unitFree[u] = 0;
+    myUnitStalls.assign(n, false);
+
+    // the reorder buffer, a ring of myRobSize entries
+    vector<RobEntry> rob(myRobSize);
+    int robHead = 0, robCount = 0;
+
+    // reservation stations; a set bit in freeRS marks an empty station and
+    // a set bit in readyRS a station whose operands are all available
+    vector<Station> rs(myRsSize);
+    uint64_t freeRS = (myRsSize == MAX_RS) ? ~(uint64_t)0
+                                           : (((uint64_t)1 << myRsSize) - 1);
+    uint64_t readyRS = 0;
+
+    // fetched instructions waiting to be decoded and renamed; holds what
+    // the fetch and decode stages hold
+    int queueSize = 2*myWidth;
+    vector<int> queueInst(queueSize), queueTime(queueSize);
+    int queueHead = 0, queueCount = 0;
+
+    // register alias table: the ROB entry that will produce each register,
+    // or -1 if its value is already committed
+    int rat[NumRegisters + 1];
+    for (int r = 0; r <= NumRegisters; r++)
+        rat[r] = -1;
+
+    // completion events: ROB entries whose results become available at a
+    // tick, linked through nextEvent. the wheel covers more ticks than the
+    // longest latency, so a bucket is always emptied before it is reused
+    int wheelSize = getWheelSize();
+    vector<int> wheel(wheelSize, -1);
+
+    myCompletionTimes.clear();
+    myCompletionTimes.reserve(n);
+    myDispatchTimes.assign(n, 0);
+
+    int fetched = 0, committed = 0, fetchBlockedUntil = 0;
+    for (int t = 1; committed < n; t++)
+    {
+        // wake up the stations waiting on results that become available now
+        for (int s = wheel[t % wheelSize]; s >= 0; s = rob[s].nextEvent)
+        {
+            uint64_t w = rob[s].waiters;
+            while (w)
+            {
+                int k = __builtin_ctzll(w);
+                w &= w - 1;
+                if (--rs[k].pending == 0)
+                    readyRS |= (uint64_t)1 << k;
+            }
+            rob[s].waiters = 0;
+        }
+        wheel[t % wheelSize] = -1;
+
+        // commit finished instructions in order from the head of the ROB
+        for (int w = 0; w < myWidth and robCount > 0; w++)
+        {
+            RobEntry &e = rob[robHead];
+            if (e.doneCycle < 0 or e.doneCycle > t)
+                break;
+            if (e.dst >= 0 and rat[e.dst] == robHead)
+                rat[e.dst] = -1;
+            myCompletionTimes.push_back(t);
+            robHead = (robHead + 1) % myRobSize;
+            robCount--;
+            committed++;
+        }
+
+        // issue the oldest ready instructions whose functional units are free
+        for (int w = 0; w < myWidth and readyRS; w++)
+        {
+            int best = -1, bestAge = myRobSize;
+            for (uint64_t r = readyRS; r; r &= r - 1)
+            {
+                int k = __builtin_ctzll(r);
+                int unit = units[rob[rs[k].rob].inst];
+                if (unit != ALU_UNIT and unitFree[unit] > t)
+                {
+                    myUnitStalls[rob[rs[k].rob].inst] = true;
+                    continue;
+                }
+                int age = (rs[k].rob - robHead + myRobSize) % myRobSize;
+                if (age < bestAge)
+                {
+                    best = k;
+                    bestAge = age;
+                }
+            }
+            if (best < 0)
+                break;
+            readyRS &= ~((uint64_t)1 << best);
+            freeRS |= (uint64_t)1 << best;
+
+            // a unit that is not pipelined stays busy for the whole latency
+            int s = rs[best].rob;
+            RobEntry &e = rob[s];
+            int unitLatency = max(1, getLatency(e.inst));
+            e.readyCycle = t + produced[e.inst] + unitLatency;
+            e.doneCycle = t + WRITEBACK - EXECUTE + unitLatency - 1;
+            if (units[e.inst] != ALU_UNIT)
+                unitFree[units[e.inst]] = t + (pipelined[e.inst] ? 1 : unitLatency);
+
+            int b = e.readyCycle % wheelSize;
+            e.nextEvent = wheel[b];
+            wheel[b] = s;
+        }
+
+        // rename decoded instructions into the ROB and reservation stations
+        for (int w = 0; w < myWidth and queueCount > 0; w++)
+        {
+            if (queueTime[queueHead] >= t or robCount == myRobSize or freeRS == 0)
+                break;
+
+            int i = queueInst[queueHead];
+            queueHead = (queueHead + 1) % queueSize;
+            queueCount--;
+
+            int s = (robHead + robCount) % myRobSize;
+            robCount++;
+            RobEntry &e = rob[s];
+            e.inst = i;
+            e.dst = dsts[i];
+            e.readyCycle = e.doneCycle = e.nextEvent = -1;
+            e.waiters = 0;
+
+            int k = __builtin_ctzll(freeRS);
+            uint64_t bit = (uint64_t)1 << k;
+            freeRS &= ~bit;
+            rs[k].rob = s;
+            rs[k].pending = 0;
+
+            // only wait on producers whose results are not available by
+            // the next tick; reading the same producer twice waits once
+            for (int j = 0; j < 2; j++)
+            {
+                int r = srcs[2*i + j];
+                if (r < 0 or rat[r] < 0)
+                    continue;
+                RobEntry &p = rob[rat[r]];
+                if ((p.readyCycle < 0 or p.readyCycle > t + 1)
+                    and not (p.waiters & bit))
+                {
+                    p.waiters |= bit;
+                    rs[k].pending++;
+                }
+            }
+            if (rs[k].pending == 0)
+                readyRS |= bit;
+
+            if (e.dst >= 0)
+                rat[e.dst] = s;
+            myDispatchTimes[i] = t;
+        }
+
+        // fetch the next instructions; as in the in-order models, there is
+        // no branch prediction, so fetching waits a tick after a control
+        // instruction. with a front end, only instructions that have arrived
+        // in the fetch buffer can be taken
+        int available = n;
+        if (myFetchUnit != NULL)
+            available = myFetchUnit->fetch(t, fetched);
+        if (t >= fetchBlockedUntil and queueCount < queueSize and fetched < n
+            and fetched >= available)
+            myFetchStalls++;
+        if (t >= fetchBlockedUntil)
+        {
+            for (int w = 0; w < myWidth and fetched < available and queueCount < queueSize; w++)
+            {
+                int q = (queueHead + queueCount) % queueSize;
+                queueInst[q] = fetched;
+                queueTime[q] = t;
+                queueCount++;
+                if (control[fetched++])
+                {
+                    fetchBlockedUntil = t + 2;
+                    break;
+                }
+            }
+        }
+    }
+
+    countFalseDependences(WAR, myWarTotal, myWarInFlight);
+    countFalseDependences(WAW, myWawTotal, myWawInFlight);
+}
+
+
+int OutOfOrderPipeline::getWheelSize()
+/* Returns a number of wheel buckets greater than the number of ticks from
+ * issue to the result of the slowest instruction the options allow.
+ */
+{
+    int longest = max(myOptions.memLatency, myOptions.l2Latency);
+    for (int o = 0; o < UNDEFINED; o++)
+        longest = max(longest, myOptions.latency[o]);
+
+    int size = 64;
+    while (size <= longest + NUM_STAGES)
+        size *= 2;
+    return size;
+}
+
+
+void OutOfOrderPipeline::countFalseDependences(DependenceType depType,
+                                               int &total, int &inFlight)
+/* Counts the dependences of type depType, and how many of them had the
+ * earlier instruction still in the ROB when the later one was renamed.
+ * Without renaming, each of those would have ordered the two instructions.
+ */
+{
+    vector<Dependence> deps = myDependencyChecker.getDependences(depType);
+    total = deps.size();
+    inFlight = 0;
+
+    for (unsigned int d = 0; d < deps.size(); d++)
+        if (myCompletionTimes[deps[d].previousInstructionNumber]
+            > myDispatchTimes[deps[d].currentInstructionNumber])
+            inFlight++;
+}
+
+
+void OutOfOrderPipeline::printStatistics()
+/* Prints the configuration, how many WAR and WAW dependences renaming
+ * removed from the window, how many instructions waited for a busy
+ * functional unit, and the achieved IPC.
+ */
+{
+    cout << "ROB size " << myRobSize << ", issue width " << myWidth
+         << ", reservation stations " << myRsSize << endl;
+    cout << "WAR dependences removed by renaming: " << myWarInFlight
+         << " of " << myWarTotal << endl;
+    cout << "WAW dependences removed by renaming: " << myWawInFlight
+         << " of " << myWawTotal << endl;
+    Pipeline::printStatistics();
+    cout << "IPC is " << getIPC() << endl;
+}
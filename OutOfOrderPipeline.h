@@ -0,0 +1,104 @@
+// aalok sathe
+#ifndef _OUT_OF_ORDER_PIPELINE_H_
+#define _OUT_OF_ORDER_PIPELINE_H_
+
+#include <stdint.h>
+#include "Pipeline.h"
+
+
+/* This class simulates an out-of-order pipeline. Instructions are fetched
+ * and decoded in order, renamed onto reorder buffer (ROB) entries so that
+ * only RAW dependences remain, and wait in reservation stations until their
+ * operands are available. Up to the issue width of ready instructions start
+ * executing each clock tick, oldest first, with full data forwarding, and
+ * instructions commit in order from the ROB. The completion time of an
+ * instruction is the clock tick it commits in.
+ *
+ * The ROB, the fetch queue and the reservation stations are fixed-capacity
+ * rings and slot arrays allocated once. Each ROB entry keeps a bitmask of
+ * the reservation stations waiting on its result, so waking up consumers
+ * when a result becomes available does not scan the window.
+ */
+class OutOfOrderPipeline: public Pipeline{
+
+
+ public:
+
+  /* The constructor is passed either the name of a MIPS assembly file or
+   * the name of a MIPS machine instruction file.  If the input file is
+   * not a valid input file (due to syntactical errors or unsupported
+   * instructions being specified), the format is considered incorrect.
+   * options give the ROB size, issue width and number of reservation
+   * stations, at most MAX_RS, and are passed on to the Pipeline
+   * constructor.
+   */
+  OutOfOrderPipeline(string inputFile, SimOptions options = SimOptions());
+
+  /* Constructs the model with program, instructions already parsed, as
+   * Pipeline does.
+   */
+  OutOfOrderPipeline(const vector<Instruction> &program, SimOptions options = SimOptions());
+
+  /* Simulates the instructions on the out-of-order pipeline and stores the
+   * commit time of each instruction as its completion time.
+   */
+  void execute();
+
+  // number of reservation stations a bitmask can track: one per bit of a
+  // 64-bit word
+  static const int MAX_RS = 64;
+
+
+ private:
+
+ /* Sets up what this model adds to Pipeline, for the constructors */
+  void initializeModel();
+
+  /* Prints the configuration, how many WAR and WAW dependences renaming
+   * removed from the window, and the achieved IPC.
+   */
+  void printStatistics();
+
+  /* Counts the dependences of type depType, and how many of them had the
+   * earlier instruction still in the ROB when the later one was renamed.
+   */
+  void countFalseDependences(DependenceType depType, int &total, int &inFlight);
+
+  /* Returns a number of wheel buckets greater than the number of ticks from
+   * issue to the result of the slowest instruction the options allow.
+   */
+  int getWheelSize();
+
+  // an entry of the reorder buffer
+  struct RobEntry
+  {
+      int inst;         // number of the instruction in the run
+      int dst;          // architectural register written, or -1
+      int readyCycle;   // first tick a consumer may issue; -1 until issued
+      int doneCycle;    // first tick the entry may commit; -1 until issued
+      int nextEvent;    // next ROB entry in the same wheel bucket, or -1
+      uint64_t waiters; // reservation stations waiting on this result
+  };
+
+  // a reservation station
+  struct Station
+  {
+      int rob;          // ROB entry of the waiting instruction
+      int pending;      // number of operands not yet available
+  };
+
+  // configuration, clamped to what the structures support
+  int myRobSize;
+  int myWidth;
+  int myRsSize;
+
+  // tick each instruction entered the ROB, for reporting false dependences
+  vector<int> myDispatchTimes;
+
+  // values for printing statistics
+  int myWarTotal, myWarInFlight;
+  int myWawTotal, myWawInFlight;
+
+};
+
+#endif
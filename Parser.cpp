@@ -0,0 +1,93 @@
+// aalok sathe
+#include "Parser.h"
+#include <cstdio>
+#include <unistd.h>
+#include <algorithm>
+
+bool Parser::readChunks(string filename)
+  // Reads the whole of filename into myText and splits it into chunks of
+  // whole lines, about one per core for large files, whose starts go in
+  // myChunkStarts followed by the end of the text.  Returns false if the
+  // file cannot be opened.
+{
+  myText.clear();
+  myChunkStarts.assign(1, 0);
+
+  FILE *in = fopen(filename.c_str(), "rb");
+  if(in == NULL){
+    myChunkStarts.push_back(0);
+    return false;
+  }
+  char buffer[1 << 16];
+  size_t got;
+  while((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    myText.append(buffer, got);
+  fclose(in);
+
+  // each chunk ends just past the first newline after its share of the
+  // text, so no line is split between two chunks
+  size_t size = myText.size();
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t count = min((size_t)max(1L, cores), max((size_t)1, size / MIN_CHUNK));
+  for(size_t k = 1; k < count; k++){
+    size_t start = max(myChunkStarts.back(), size * k / count);
+    start = myText.find('\n', start);
+    if(start == string::npos)
+      break;
+    if(start + 1 > myChunkStarts.back())
+      myChunkStarts.push_back(start + 1);
+  }
+  if(myChunkStarts.back() < size || myChunkStarts.size() == 1)
+    myChunkStarts.push_back(size);
+  return true;
+}
+
+
+bool Parser::getLine(size_t &pos, size_t end, string &line)
+  // Reads the next line of the text at pos, as getline would, into line
+  // and moves pos past it.  Returns false if pos is at end.
+{
+  if(pos >= end)
+    return false;
+  size_t newline = myText.find('\n', pos);
+  if(newline == string::npos || newline > end)
+    newline = end;
+  line.assign(myText, pos, newline - pos);
+  pos = newline + 1;
+  return true;
+}
+
+
+void Parser::runChunks(int pass)
+  // Calls parseChunk(k, pass) for every chunk k, each on a thread of its
+  // own, and returns once all of them are done.
+{
+  int count = getChunkCount();
+  vector<ChunkTask> tasks(count);
+  vector<pthread_t> threads(count);
+  vector<bool> started(count, false);
+  for(int k = 0; k < count; k++){
+    tasks[k].parser = this;
+    tasks[k].chunk = k;
+    tasks[k].pass = pass;
+  }
+
+  // the first chunk runs on this thread, as do any that cannot get one
+  for(int k = 1; k < count; k++)
+    started[k] = (pthread_create(&threads[k], NULL, runChunk, &tasks[k]) == 0);
+  for(int k = 0; k < count; k++){
+    if(started[k])
+      pthread_join(threads[k], NULL);
+    else
+      runChunk(&tasks[k]);
+  }
+}
+
+
+void *Parser::runChunk(void *task)
+  // The body of a thread running a chunk; task is its ChunkTask.
+{
+  ChunkTask *chunk = (ChunkTask *)task;
+  chunk->parser->parseChunk(chunk->chunk, chunk->pass);
+  return NULL;
+}
@@ -1,38 +1,93 @@
-#ifndef __PARSER_H__
-#define __PARSER_H__
-
-using namespace std;
-
-#include "Instruction.h"
-#include "RegisterTable.h"
-#include "OpcodeTable.h"
-#include <string>
-
-/* This class reads in a MIPS assembly file and checks its syntax.  If
- * the file is syntactically correct, this class will retain a list
- * of Instructions (one for each instruction from the file).  This
- * list of Instructions can be iterated through.
- */
-
-
-class Parser{
- public:
-
-  Parser() {};
-
-  virtual ~Parser() {};
-
-  // Specify a text file containing MIPS assembly instructions. Function
-  // checks syntactic correctness of file and creates a list of Instructions.
-  Parser(string filename) {};
-
-  // Returns true if the file specified was syntactically correct.  Otherwise,
-  // returns false.
-  virtual bool isFormatCorrect() = 0;
-
-  // Iterator that returns the next Instruction in the list of Instructions.
-  virtual Instruction getNextInstruction() = 0;
-
-};
-
-#endif
+#ifndef __PARSER_H__
+#define __PARSER_H__
+
+using namespace std;
+
+#include "Instruction.h"
+#include "RegisterTable.h"
+#include "OpcodeTable.h"
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/* This class reads in a MIPS assembly file and checks its syntax.  If
+ * the file is syntactically correct, this class will retain a list
+ * of Instructions (one for each instruction from the file).  This
+ * list of Instructions can be iterated through.
+ */
+
+
+class Parser{
+ public:
+
+  Parser() {};
+
+  virtual ~Parser() {};
+
+  // Specify a text file containing MIPS assembly instructions. Function
+  // checks syntactic correctness of file and creates a list of Instructions.
+  Parser(string filename) {};
+
+  // Returns true if the file specified was syntactically correct.  Otherwise,
+  // returns false.
+  virtual bool isFormatCorrect() = 0;
+
+  // Iterator that returns the next Instruction in the list of Instructions.
+  virtual Instruction getNextInstruction() = 0;
+
+  // Parses text, whole lines that follow those of the blocks parsed before,
+  // and appends their instructions to instructions.  Returns false at the
+  // first line that is not a supported instruction.  Defined by parsers
+  // that can read a file a block at a time.
+  virtual bool parseBlock(const string &text, vector<Instruction> &instructions)
+      { return false; };
+
+  // Once the last block is parsed, gives the instructions of the blocks
+  // that change now that the whole file is known, e.g. branches to labels
+  // defined after them, each with its index.
+  virtual void finishBlocks(vector<pair<int, Instruction> > &changed) {};
+
+ protected:
+
+  // Reads the whole of filename into myText and splits it into chunks of
+  // whole lines, about one per core for large files, whose starts go in
+  // myChunkStarts followed by the end of the text.  Returns false if the
+  // file cannot be opened.
+  bool readChunks(string filename);
+
+  // Returns the number of chunks readChunks split the text into.
+  int getChunkCount() { return (int)myChunkStarts.size() - 1; };
+
+  // Reads the next line of the text at pos, as getline would, into line
+  // and moves pos past it.  Returns false if pos is at end.
+  bool getLine(size_t &pos, size_t end, string &line);
+
+  // Calls parseChunk(k, pass) for every chunk k, each on a thread of its
+  // own, and returns once all of them are done.
+  void runChunks(int pass);
+
+  // Parses chunk k of the text in the given pass.  Defined by parsers that
+  // use runChunks.
+  virtual void parseChunk(int k, int pass) {};
+
+  string myText;                  // the text of the file being parsed
+  vector<size_t> myChunkStarts;   // where each chunk of it starts
+
+ private:
+
+  // smallest chunk worth a thread of its own, in bytes
+  static const size_t MIN_CHUNK = 1 << 16;
+
+  // what a thread running a chunk needs to know
+  struct ChunkTask{
+    Parser *parser;
+    int chunk;
+    int pass;
+  };
+
+  // The body of a thread running a chunk; task is its ChunkTask.
+  static void *runChunk(void *task);
+
+};
+
+#endif
@@ -1,54 +1,298 @@
 // aalok sathe
 #include "Pipeline.h"
+#include <cstdio>
+#include <cctype>
 
 
-Pipeline::Pipeline(string inputFile)
+Pipeline::Pipeline(string inputFile, SimOptions options)
 /* Default constructor for the Pipeline class. Given an input string for
- * a filename, calls an appropriate parser instance on the file (according
- * to file extension), and processes the instructions in the file by simulating
- * each one's execution in the CPU
+ * a filename, has a ProgramLoader read the instructions in the file, and
+ * processes them by simulating each one's execution in the CPU. If options
+ * ask for it, the program is executed first and the instructions are taken
+ * from the dynamic stream.
  */
 {
-    myTime = 1;                         // start clock at '1'
-    myOutput.myPipelineType = "IDEAL";  // name this pipeline model
+    initialize(options);
 
-    // initialize a parser, and construct appropriate derived class based on
-    // input file kind
-    Parser* parser;
+    // when streaming, the instructions only need timing, unless there is
+    // more to do with all of them first, so execute simulates them as they
+    // are read and decoded on threads of their own
     string ext = inputFile.substr(inputFile.find_last_of('.')+1);
-    if (ext == "asm")
-        parser = new ASMParser(inputFile);
-    else if (ext == "mach")
-        parser = new MachLangParser(inputFile);
-    else
+    if (myOptions.stream and ext != "trace" and myOptions.cacheDir.empty()
+        and not (myOptions.execute or myOptions.dataCache or myOptions.frontEnd)
+        and myOptions.rangeEnd < 0 and myOptions.checkpointFile.empty()
+        and myOptions.resumeFile.empty() and not myOptions.watch
+        and myOptions.updateFile.empty() and myOptions.threads <= 1
+        and not myOptions.estimate)
+    {
+        myStream = new InstructionStream(inputFile);
+        myFormatCorrect = true;
         return;
+    }
 
-    // check if parser is able to parse the input file correctly and
-    // exit if it is not able
-    myFormatCorrect = parser->isFormatCorrect();
+    ProgramLoader loader(myOptions);
+    myFormatCorrect = loader.load(inputFile);
     if (not myFormatCorrect)
         return;
+    setProgram(loader);
 
-    // add each instruction parsed by the parser into a container storing
-    // instructions, and into the dependency checker
-    for (Instruction i = parser->getNextInstruction();
-         i.getOpcode() != UNDEFINED;
-         i = parser->getNextInstruction())
+    // an input edited while PIPESIM runs is followed line by line, so that
+    // only what changed is read, checked and simulated again; that needs
+    // the instructions to be the lines of the file, in order
+    if ((myOptions.watch or not myOptions.updateFile.empty()) and loader.isParsed()
+        and not (myOptions.execute or myOptions.dataCache or myOptions.frontEnd)
+        and myOptions.rangeEnd < 0 and myOptions.checkpointFile.empty()
+        and myOptions.resumeFile.empty())
+    {
+        myEdit = new ProgramEdit(inputFile);
+        if (not myEdit->isUsable())
         {
-            myInstructions.push_back(i);
-            myDependencyChecker.addInstruction(i);
+            delete myEdit;
+            myEdit = NULL;
         }
+    }
+}
+
+
+Pipeline::Pipeline(const vector<Instruction> &program, SimOptions options)
+/* Constructs the model with program, the instructions of a program already
+ * parsed, e.g. from a buffer in memory, instead of reading a file. They
+ * are simulated as the instructions of a file would be, executed first if
+ * options ask for it; the options that name files are not used. The format
+ * is incorrect if an instruction is not a supported one.
+ */
+{
+    initialize(options);
+    myOptions.cacheDir = "";
+    myOptions.watch = false;
+    myOptions.updateFile = "";
+    ProgramLoader loader(myOptions);
+    myFormatCorrect = loader.load(program);
+    if (myFormatCorrect)
+        setProgram(loader);
+}
+
 
-    // free allocated memory
-    delete parser;
+Pipeline::Pipeline(Pipeline *whole, int first)
+/* Constructs a part of whole, as makePart returns it: a model with no
+ * data cache, front end or block cache, starting from instruction first
+ * with an empty pipeline, as if the instructions before had long
+ * finished.
+ */
+{
+    initialize(whole->myOptions);
+    myFormatCorrect = true;
+    myWhole = whole;
+    myFirst = first;
+    myPipeline.reset(first);
+
+    // only the records of its own instructions, which run on past the part
+    // when a later part has to be simulated again from it
+    myUnitStalls.assign(getNumInstructions() - first, false);
+    for (int u = 0; u < NUM_UNITS; u++)
+        myUnitFree[u] = 0;
+}
+
+
+void Pipeline::initialize(SimOptions options)
+/* Sets the members of a model that has no instructions yet, for the
+ * constructors.
+ */
+{
+    myTime = 1;                         // start clock at '1'
+    myOutput.myPipelineType = "IDEAL";  // name this pipeline model
+    myOptions = options;
+    myFormatCorrect = false;
+    myWidth = 1;                        // one instruction per stage
+    myDataCache = NULL;
+    myFetchUnit = NULL;
+    myFetchStalls = 0;
+    myExtrapolated = 0;
+    myBlockCache = NULL;
+    myBlockStart = -1;
+    myResuming = false;
+    myCached = false;
+    myRangeFirst = -1;
+    myRangeStart = 0;
+    myEdit = NULL;
+    myNoteStates = false;
+    myResimulated = 0;
+    myWhole = this;
+    myFirst = 0;
+    myStream = NULL;
+}
+
+
+void Pipeline::setProgram(ProgramLoader &loader)
+/* Takes over the instructions to simulate, with their dependences, from
+ * loader, and builds the data cache and front end the options ask for.
+ */
+{
+    myProgram.swap(loader.getProgram());
+    myPcs.swap(loader.getPcs());
+    myDependencyChecker.swap(loader.getDependencyChecker());
+    myCached = loader.isCached();
+
+    // a trace or cached program is simulated without a data cache, since
+    // only executing it again gives the load addresses
+    if (myOptions.dataCache and loader.isParsed())
+        createDataCache(loader.getAddresses());
+    if (myOptions.frontEnd)
+        createFetchUnit(myPcs);
+    if (loader.getRangeFirst() >= 0)
+        setRange(loader.getRangeFirst());
+}
+
+
+void Pipeline::setRange(int first)
+/* Notes that the instructions to simulate start with instruction first of
+ * the run, and where the range starts among them.
+ */
+{
+    myRangeFirst = first;
+    myRangeStart = min(max(0, myOptions.rangeStart - first), (int)myPcs.size());
+}
+
+
+bool Pipeline::takeBatch()
+/* Takes the next batch of instructions from myStream into myProgram
+ * and the dependency checker, with their producers, program order and
+ * records. Once there are none left, applies the changes the stream
+ * gives, notes whether the input was formatted correctly, closes the
+ * stream and returns false.
+ */
+{
+    if (myStream == NULL)
+        return false;
+
+    vector<Instruction> batch;
+    if (myStream->getBatch(batch))
+    {
+        int first = myProgram.size();
+        myProgram.insert(myProgram.end(), batch.begin(), batch.end());
+        myDependencyChecker.addInstructions(batch);
+        for (unsigned int k = first; k < myProgram.size(); k++)
+        {
+            myProducers.push_back(myDependencyChecker.getPrevDep(k, RAW));
+            myPcs.push_back(k);
+        }
+        spliceRecords(first, 0, batch.size());
+        return true;
+    }
+
+    // only labels change, which the timing does not depend on
+    myFormatCorrect = myStream->isFormatCorrect();
+    vector<pair<int, Instruction> > changed;
+    myStream->getChanges(changed);
+    for (unsigned int k = 0; k < changed.size(); k++)
+        myProgram[changed[k].first] = changed[k].second;
+    delete myStream;
+    myStream = NULL;
+    return false;
+}
+
+
+bool Pipeline::writeTrace(string file, int &chunks, long &bytes)
+/* Writes the instructions to simulate, with their dependences, to file
+ * as a TraceFile, and sets chunks and bytes to its number of chunks and
+ * size. Returns false if it could not be written.
+ */
+{
+    TraceFile trace(myProgram, myPcs, myDependencyChecker);
+    bool written = trace.write(file);
+    chunks = trace.getChunkCount();
+    bytes = trace.getSize();
+    return written;
+}
+
+
+void Pipeline::findProducers()
+/* Looks up the instruction each instruction reads a value from, for
+ * getProducer.
+ */
+{
+    int n = myPcs.size();
+    myProducers.resize(n);
+    for (int k = 0; k < n; k++)
+        myProducers[k] = myDependencyChecker.getPrevDep(k, RAW);
+}
+
+
+void Pipeline::createFetchUnit(const vector<int> &order)
+/* Builds the front end the options ask for. order gives the index into the
+ * program of each instruction simulated, from which it finds the address
+ * each instruction is fetched from.
+ */
+{
+    vector<unsigned int> pcs(order.size());
+    for (unsigned int k = 0; k < order.size(); k++)
+        pcs[k] = TextBaseAddress + 4*order[k];
+
+    myFetchUnit = new FetchUnit(myOptions, pcs);
+}
+
+
+void Pipeline::createDataCache(vector<unsigned int> &addresses)
+/* Builds the data cache levels the options ask for, and takes the address
+ * of each load simulated from addresses, which holds one per instruction.
+ */
+{
+    myDataCache = new MemoryHierarchy(myOptions.memLatency);
+    myDataCache->addLevel("L1 data cache",
+                          Cache(myOptions.l1.size, myOptions.l1.lineSize,
+                                myOptions.l1.ways, myOptions.replacement),
+                          myOptions.latency[LW]);
+    if (myOptions.l2.size > 0)
+        myDataCache->addLevel("L2 cache",
+                              Cache(myOptions.l2.size, myOptions.l2.lineSize,
+                                    myOptions.l2.ways, myOptions.replacement),
+                              myOptions.l2Latency);
+
+    myAddresses.swap(addresses);
+    myLoadLatencies.assign(myPcs.size(), 0);
 }
 
 
 Pipeline::~Pipeline()
 /* Deconstructor for Pipeline class
  */
-{}
+{
+    delete myDataCache;
+    delete myFetchUnit;
+    delete myBlockCache;
+    delete myEdit;
+    delete myStream;
+}
+
 
+void Pipeline::setInstructions(const vector<Instruction> &program,
+                               const vector<int> &pcs)
+/* Replaces the instructions to simulate with the ones at indices pcs of
+ * program, and forgets any earlier simulation, so that one model can
+ * time many parts of a long run. The parts are simulated without a data
+ * cache or front end.
+ */
+{
+    myProgram = program;
+    myPcs = pcs;
+    myDependencyChecker = DependencyChecker();
+    myDependencyChecker.addInstructions(myProgram, myPcs);
+
+    delete myDataCache;
+    delete myFetchUnit;
+    myDataCache = NULL;
+    myFetchUnit = NULL;
+    myAddresses.clear();
+    myLoadLatencies.clear();
+
+    myPipeline.reset(0);
+    myCompletionTimes.clear();
+    myUnitStalls.clear();
+    myEvents = priority_queue<int, vector<int>, greater<int> >();
+    myTime = 1;
+    myFetchStalls = 0;
+    myExtrapolated = 0;
+}
 
 void Pipeline::execute()
 /* Executes the instructions passed into the constructor.  The method
@@ -57,8 +301,14 @@ void Pipeline::execute()
  * storing that information for later printing.
  */
 {
+    if (myStream != NULL)
+    {
+        executeStream();
+        return;
+    }
+
     // there needs to be at least one instruction
-    if (myInstructions.empty())
+    if (myPcs.empty())
         return;
     
     // iterate through instructions, one after another,
@@ -66,19 +316,290 @@ void Pipeline::execute()
     // time for each instruction in a container for later use. continue loop
     // even after all instructions are already in pipeline in order to finish
     // executing them. use i to keep track of insertion and j for completion.
-    int i = 0, j = 0;
-    while (i < (int)myInstructions.size() or myPipeline[myInstructions.size()-1] < NUM_STAGES)
+    int n = myPcs.size();
+    myUnitStalls.assign(n, false);
+    findProducers();
+    for (int u = 0; u < NUM_UNITS; u++)
+        myUnitFree[u] = 0;
+
+    // iterations of a loop that repeat exactly are extrapolated rather than
+    // simulated, and basic blocks entered in a state seen before may be
+    // timed from the block cache, unless the caches or the front end keep
+    // state that the pipeline does not show
+    vector<int> shapes, blockEnds;
+    map<vector<int>, pair<int,int> > seen;
+    int lastFirst = 0;
+    bool repeatable = (myOptions.execute and myDataCache == NULL
+                       and myFetchUnit == NULL);
+    if (repeatable and (myOptions.extrapolate or myOptions.blockCache > 0))
+        findShapes(shapes);
+    if (repeatable and myOptions.blockCache > 0)
+    {
+        delete myBlockCache;
+        myBlockCache = new BlockCache(myOptions.blockCache);
+        myBlockStart = -1;
+        findBlockEnds(blockEnds);
+    }
+
+    // with threads to spare, parts of the instructions are simulated at the
+    // same time, unless the caches, the front end or the block cache keep
+    // state that carries from one part to the next, or there are
+    // checkpoints to take or states to note for edits
+    if (myOptions.threads > 1 and myDataCache == NULL and myFetchUnit == NULL
+        and blockEnds.empty() and myOptions.checkpointFile.empty()
+        and not myResuming and myEdit == NULL and executeParallel(shapes))
+        return;
+
+    // an input that is edited notes the state at each instruction, for
+    // update to simulate the edit from and to
+    if (myEdit != NULL)
+    {
+        myStates.assign(n, vector<int>());
+        myStateTimes.assign(n, 0);
+        myNoShapes.assign(n, 0);
+        myNoteStates = true;
+    }
+
+    int i = 0, j = 0, inserted = 0;
+    if (myResuming)
     {
-        // if instruction is not in the pipeline yet, add it to the pipeline
-        if (myPipeline.find(i) == myPipeline.end())
-            myPipeline.insert(make_pair(i, FETCH));
+        restoreCheckpoint(i, j, inserted, lastFirst, seen);
+        myResuming = false;
+    }
+    run(i, j, inserted, lastFirst, seen, shapes, blockEnds, n);
+    myNoteStates = false;
+    myCheckpointWriter.wait();
+}
+
+
+void Pipeline::executeStream()
+/* Simulates the instructions as execute does while they are read from
+ * myStream: after each batch, the clock loop runs on as far as it can
+ * without the instructions still to come.
+ */
+{
+    for (int u = 0; u < NUM_UNITS; u++)
+        myUnitFree[u] = 0;
+
+    // instructions finish in order and each stage holds at most myWidth of
+    // them, so while j is this far from the last instruction read, the
+    // ones coming into the pipeline have all been read
+    int ahead = (NUM_STAGES + 2) * myWidth;
+    int i = 0, j = 0, inserted = 0, lastFirst = 0;
+    map<vector<int>, pair<int,int> > seen;
+    vector<int> none;
+    while (takeBatch())
+        run(i, j, inserted, lastFirst, seen, none, none,
+            (int)myPcs.size() - ahead);
+    if (myFormatCorrect and not myPcs.empty())
+        run(i, j, inserted, lastFirst, seen, none, none, myPcs.size());
+}
+
+
+bool Pipeline::update(string inputFile)
+/* Reads inputFile as an edit of the input file read last and simulates
+ * it again: only the lines that changed are parsed, the dependences
+ * they change are patched, and the pipeline is simulated from the state
+ * it was in just before the first instruction that changed until it is
+ * in the same state as at the same instruction of the last run; the
+ * rest of the run is the last one, moved. Returns false, leaving the
+ * model to be built again, if it cannot follow the edit or was not
+ * built to (options.watch or options.updateFile).
+ */
+{
+    int first, removed;
+    vector<Instruction> added;
+    vector<pair<int, Instruction> > relabeled;
+    if (myEdit == NULL or myPcs.empty()
+        or myStates.size() != myPcs.size()
+        or not myEdit->update(inputFile, first, removed, added, relabeled))
+        return false;
+    int oldEnd = first + removed;
+    int newEnd = first + added.size();
+    int shift = newEnd - oldEnd;
+    int n = myPcs.size() + shift;
+    if (n == 0)
+        return false;
+
+    // the instructions, with the dependences the edit changes patched.
+    // from settled on, every instruction depends on the ones that may
+    // still be in the pipeline with it as the one it was did
+    int far = NUM_STAGES * myWidth;
+    int settled = myDependencyChecker.replaceInstructions(first, removed, added, far);
+    myProgram.erase(myProgram.begin() + first, myProgram.begin() + oldEnd);
+    myProgram.insert(myProgram.begin() + first, added.begin(), added.end());
+    for (unsigned int r = 0; r < relabeled.size(); r++)
+        myProgram[relabeled[r].first] = relabeled[r].second;
+    myPcs.resize(n);
+    for (int k = first; k < (shift != 0 ? n : newEnd); k++)
+        myPcs[k] = k;
+    findProducers();
+    myNoShapes.assign(n, 0);
+
+    // what the last run found after the edit, moved to the new numbering
+    vector<int> oldTimes(myCompletionTimes.begin() + oldEnd, myCompletionTimes.end());
+    myStates.erase(myStates.begin() + first, myStates.begin() + oldEnd);
+    myStates.insert(myStates.begin() + first, added.size(), vector<int>());
+    myStateTimes.erase(myStateTimes.begin() + first, myStateTimes.begin() + oldEnd);
+    myStateTimes.insert(myStateTimes.begin() + first, added.size(), 0);
+    spliceRecords(first, removed, added.size());
+    vector<int> oldRecords(n - newEnd);
+    for (int k = newEnd; k < n; k++)
+        oldRecords[k - newEnd] = getInstructionRecord(k);
+    int oldTime = myTime;
+
+    // the last state before the edit in which no instruction it changed
+    // had entered the pipeline yet; without one, the run starts over
+    int start = first - 1;
+    while (start >= 0 and (myStates[start].empty() or start
+           + ((int)myStates[start].size() - NUM_UNITS) / 4 > first))
+        start--;
+    int inPipeline = 0;
+    myPipeline.reset(max(0, start));
+    myEvents = priority_queue<int, vector<int>, greater<int> >();
+    if (start >= 0)
+    {
+        const vector<int> &state = myStates[start];
+        inPipeline = (state.size() - NUM_UNITS) / 4;
+        myTime = myStateTimes[start];
+        for (int e = 0; e < inPipeline; e++)
+        {
+            int k = start + e;
+            myPipeline.push((PipelineStages)state[4*e], myTime + state[4*e + 2]);
+            if (state[4*e + 2] > 0)
+                myEvents.push(myTime + state[4*e + 2]);
+            setInstructionRecord(k, state[4*e + 3]);
+        }
+        for (int u = 0; u < NUM_UNITS; u++)
+        {
+            myUnitFree[u] = myTime + state[4*inPipeline + u];
+            if (myUnitFree[u] > myTime)
+                myEvents.push(myUnitFree[u]);
+        }
+    }
+    else
+    {
+        start = 0;
+        myTime = 1;
+        for (int u = 0; u < NUM_UNITS; u++)
+            myUnitFree[u] = 0;
+    }
+    for (int k = start + inPipeline; k < n; k++)
+        setInstructionRecord(k, 0);
+    myCompletionTimes.resize(start);
+
+    // simulate from there, a clock tick at a time, until the pipeline is
+    // in the state the last run was in at the same instruction, with the
+    // same instructions to come
+    int i = start, j = start, inserted = start + inPipeline, lastFirst = start;
+    while (i < n and myPipeline.contains(i) and myPipeline[i] > FETCH)
+        i++;
+    map<vector<int>, pair<int,int> > seen;
+    vector<int> none;
+    int match = -1;
+    while (j < n)
+    {
+        int previous = j;
+        run(i, j, inserted, lastFirst, seen, none, none, j + 1);
+
+        // the last run's states at instructions this one passes over are
+        // not this run's
+        for (int k = previous + 1; k < j and k < n; k++)
+            myStates[k].clear();
+        if (j >= n)
+            break;
+        vector<int> state;
+        int end;
+        bool noted = getState(j, myNoShapes, end, state);
+        if (noted and j >= settled and state == myStates[j])
+        {
+            match = j;
+            break;
+        }
+        myStates[j].swap(state);
+        myStateTimes[j] = myTime;
+        if (not noted)
+            myStates[j].clear();
+    }
+
+    // the rest of the run is the last one's, later or earlier by as many
+    // clock ticks as the pipeline reached the state later or earlier
+    myResimulated = (match >= 0 ? match : n) - start;
+    if (match >= 0)
+    {
+        int delta = myTime - myStateTimes[match];
+        for (int k = match; k < n; k++)
+        {
+            myCompletionTimes.push_back(oldTimes[k - newEnd] + delta);
+            setInstructionRecord(k, oldRecords[k - newEnd]);
+            myStateTimes[k] += delta;
+        }
+        myPipeline.reset(n);
+        myTime = oldTime + delta;
+    }
+    return true;
+}
+
+
+void Pipeline::run(int &i, int &j, int &inserted, int &lastFirst,
+                   map<vector<int>, pair<int,int> > &seen,
+                   const vector<int> &shapes, const vector<int> &blockEnds,
+                   int stop)
+/* The clock loop of execute: simulates clock ticks until every instruction
+ * has finished, or until instruction stop is the first one that has not.
+ * i, j, inserted and lastFirst are execute's positions, seen its loop
+ * states, and shapes and blockEnds what findShapes and findBlockEnds
+ * found, if anything.
+ */
+{
+    // with a front end, only the instructions that have arrived in the fetch
+    // buffer may enter FETCH; ticks in which FETCH had room for the next
+    // instruction but it had not arrived yet are fetch stalls
+    int n = getNumInstructions();
+    int available = n;
+
+    // a checkpoint is taken each time another checkpointEvery instructions
+    // have completed
+    long every = max(1L, myOptions.checkpointEvery);
+    long nextCheckpoint = (j / every + 1) * every;
+    int recorded = -1, noted = -1;
+
+    while ((i < n or myPipeline[n-1] < NUM_STAGES) and j < stop)
+    {
+        if (myFetchUnit != NULL)
+            available = myFetchUnit->fetch(myTime, inserted);
+
+        // if instructions are not in the pipeline yet, add them to the
+        // pipeline, as many as can be fetched together
+        bool starved = false;
+        for (int k = i; k < n and k < i + myWidth; k++)
+        {
+            if (myPipeline.contains(k))
+                continue;
+            if (k >= available)
+            {
+                starved = true;
+                break;
+            }
+            myPipeline.push(FETCH);
+            inserted++;
+        }
+        if (starved)
+            myFetchStalls++;
+
+        if (myFetchUnit != NULL)
+        {
+            int next = myFetchUnit->getNextFetchTime(myTime, inserted);
+            if (next > 0)
+                myEvents.push(next);
+        }
        
         // update clock tick and pipeline stages
-        stepPipeline(j);
+        bool moved = stepPipeline(j);
       
-        // if instruction at j is finished executing, add the current clock
-        // tick as its completion time 
-        if (myPipeline[j] == NUM_STAGES)
+        // if instructions from j on are finished executing, add the current
+        // clock tick as their completion time 
+        while (j < n and myPipeline.contains(j) and myPipeline[j] == NUM_STAGES)
         {
             myCompletionTimes.push_back(myTime);
             j++;
@@ -86,16 +607,707 @@ void Pipeline::execute()
 
         // if there are still more instructions to add and there's an opening
         // in the pipeline to add an instruction, then proceed to next instr.
-        if (i < (int)myInstructions.size() and myPipeline[i] > FETCH)
+        while (i < n and myPipeline.contains(i) and myPipeline[i] > FETCH)
             i++;
 
+        // if no instruction could move, none can until a functional unit
+        // finishes, so skip the clock ticks in between
+        if (not moved)
+        {
+            while (not myEvents.empty() and myEvents.top() <= myTime)
+                myEvents.pop();
+            if (not myEvents.empty())
+            {
+                if (starved)
+                    myFetchStalls += myEvents.top() - 1 - myTime;
+                myTime = myEvents.top() - 1;
+            }
+        }
+
         // increment clock tick
         myTime++;
 
+        // a loop starts another iteration where the program goes back, and
+        // a basic block where blockEnds says so. either may move j on to
+        // another one
+        while (not shapes.empty() and j < n and j != lastFirst)
+        {
+            lastFirst = j;
+            if (myBlockStart >= 0 and j >= myBlockEnd)
+                recordBlock(j, shapes);
+            if (myOptions.extrapolate and myWhole->myPcs[j] <= myWhole->myPcs[j-1]
+                and extrapolate(i, j, shapes, seen))
+                myBlockStart = -1;
+            else if (myBlockCache != NULL and myBlockStart < 0
+                     and blockEnds[j] >= 0)
+                replayBlock(i, j, shapes, blockEnds);
+        }
+
+        if (not myOptions.checkpointFile.empty() and j >= nextCheckpoint
+            and j < n)
+        {
+            saveCheckpoint(i, j, inserted, lastFirst, seen);
+            nextCheckpoint = (j / every + 1) * every;
+        }
+
+        // a part simulated on its own notes its states where the parts
+        // next to it are checked against it
+        if (not mySegment.windows.empty() and j != recorded)
+        {
+            recorded = j;
+            recordSegmentState(j);
+        }
+
+        // and an input that is edited notes every state
+        if (myNoteStates and j != noted and j < n)
+        {
+            noted = j;
+            int end;
+            myStateTimes[j] = myTime;
+            if (not getState(j, myNoShapes, end, myStates[j]))
+                myStates[j].clear();
+        }
+    }
+}
+
+
+
+
+bool Pipeline::executeParallel(const vector<int> &shapes)
+/* Simulates the instructions in parts, each on a copy of the model on a
+ * thread of its own, started with an empty pipeline as if the
+ * instructions before had long finished. Each part is then checked
+ * against the one before: from the first instruction in a window past
+ * its start at which both were in the same state, its times are right,
+ * shifted by the difference of their clocks; if there is none, the part
+ * before is simulated on into it. The times are exactly those of
+ * simulating every instruction in turn. Returns false, doing nothing, if
+ * there are too few instructions to split.
+ */
+{
+    // the states of two parts usually agree a few dozen instructions into
+    // the later one; parts much shorter than the window are not worth it
+    int n = myPcs.size();
+    int window = 64 * NUM_STAGES * myWidth;
+    int parts = min(myOptions.threads, n / (4 * window));
+    if (parts < 2)
+        return false;
+
+    // the parts are compared at the same instructions, so their states
+    // need no shapes to tell instructions apart when there are none
+    vector<int> starts, noShapes;
+    for (int p = 0; p <= parts; p++)
+        starts.push_back((long)n * p / parts);
+    if (shapes.empty())
+        noShapes.assign(n, 0);
+
+    vector<Pipeline *> segments(parts);
+    for (int p = 0; p < parts; p++)
+    {
+        int start = starts[p];
+        Pipeline *model = makePart(start);
+        Segment &segment = model->mySegment;
+        segment.i = segment.j = segment.inserted = segment.lastFirst = start;
+        segment.stop = min(n, starts[p+1] + window);
+        for (int t = p; t < parts; t++)
+            segment.windows.push_back(make_pair(starts[t], starts[t] + window));
+        segment.shapes = &shapes;
+        segment.stateShapes = shapes.empty() ? &noShapes : &shapes;
+        segments[p] = model;
+    }
+
+    // the first part runs on this thread, as do any that cannot get one
+    vector<pthread_t> threads(parts);
+    vector<bool> started(parts, false);
+    for (int p = 1; p < parts; p++)
+        started[p] = (pthread_create(&threads[p], NULL, startSegment,
+                                     segments[p]) == 0);
+    for (int p = 0; p < parts; p++)
+    {
+        if (started[p])
+            pthread_join(threads[p], NULL);
+        else
+            segments[p]->runSegment();
+    }
+
+    // the first part started as the whole run does. known is the last part
+    // whose times are right once delta is added, taken from copied on
+    myCompletionTimes.assign(n, 0);
+    int known = 0, delta = 0, copied = 0;
+    for (int p = 1; p < parts; p++)
+    {
+        const map<int, pair<int, vector<int> > > &right = segments[known]->mySegment.states;
+        const map<int, pair<int, vector<int> > > &guess = segments[p]->mySegment.states;
+        map<int, pair<int, vector<int> > >::const_iterator a, b;
+        for (a = right.lower_bound(starts[p]);
+             a != right.end() and a->first < starts[p] + window; a++)
+        {
+            b = guess.find(a->first);
+            if (b != guess.end() and b->second.second == a->second.second)
+                break;
+        }
+
+        if (a == right.end() or a->first >= starts[p] + window)
+        {
+            Segment &segment = segments[known]->mySegment;
+            segment.stop = min(n, starts[p+1] + window);
+            segments[known]->runSegment();
+            continue;
+        }
+        copySegment(segments[known], copied, a->first, delta);
+        delta += a->second.first - b->second.first;
+        known = p;
+        copied = a->first;
+    }
+    copySegment(segments[known], copied, n, delta);
+    myTime = segments[known]->myTime + delta;
+
+    // every instruction has finished, and the instructions extrapolated are
+    // those the parts extrapolated, some of them twice where they overlap
+    myPipeline.reset(n);
+    for (int p = 0; p < parts; p++)
+    {
+        myExtrapolated += segments[p]->myExtrapolated;
+        delete segments[p];
+    }
+    return true;
+}
+
+
+void Pipeline::runSegment()
+/* Runs the clock loop of a part, as set up in mySegment, to its stop */
+{
+    Segment &segment = mySegment;
+    run(segment.i, segment.j, segment.inserted, segment.lastFirst, segment.seen,
+        *segment.shapes, vector<int>(), segment.stop);
+}
+
+
+void *Pipeline::startSegment(void *model)
+/* The body of a thread simulating a part; model is its copy of the model */
+{
+    ((Pipeline *)model)->runSegment();
+    return NULL;
+}
+
+
+void Pipeline::recordSegmentState(int j)
+/* Called between clock ticks of a part when instruction j is first the
+ * first one that has not finished; notes the state if j is in a window.
+ */
+{
+    for (unsigned int w = 0; w < mySegment.windows.size(); w++)
+    {
+        if (j < mySegment.windows[w].first or j >= mySegment.windows[w].second)
+            continue;
+        vector<int> state;
+        int end;
+        if (getState(j, *mySegment.stateShapes, end, state))
+            mySegment.states[j] = make_pair(myTime, state);
+        return;
+    }
+}
+
+
+void Pipeline::copySegment(Pipeline *part, int from, int to, int delta)
+/* Takes the completion times and records of instructions from to to-1
+ * from part, its clock shifted by delta.
+ */
+{
+    for (int k = from; k < to; k++)
+    {
+        myCompletionTimes[k] = part->myCompletionTimes[k - part->myFirst] + delta;
+        setInstructionRecord(k, part->getInstructionRecord(k));
     }
 }
 
 
+void Pipeline::findShapes(vector<int> &shapes)
+/* Numbers the instructions into shapes: two instructions have the same
+ * shape exactly when they are the same instruction of the program with
+ * the same dependences on the instructions the same distance before them.
+ * Dependences on instructions so far back that they must have left the
+ * pipeline are the same at any distance.
+ */
+{
+    // at most myWidth instructions are in each stage
+    int far = NUM_STAGES * myWidth;
+
+    int n = myPcs.size();
+    shapes.resize(n);
+    map<vector<int>, int> numbers;
+    for (int k = 0; k < n; k++)
+    {
+        vector<int> shape(1, myPcs[k]);
+        vector<Dependence> deps = myDependencyChecker.getInstructionDependences(k);
+        for (unsigned int d = 0; d < deps.size(); d++)
+        {
+            shape.push_back(deps[d].dependenceType);
+            shape.push_back(min(far, k - deps[d].previousInstructionNumber));
+        }
+        int number = numbers.size();
+        shapes[k] = numbers.insert(make_pair(shape, number)).first->second;
+    }
+}
+
+
+bool Pipeline::extrapolate(int &i, int &j, const vector<int> &shapes,
+                           map<vector<int>, pair<int,int> > &seen)
+/* Called between clock ticks when instruction j, the first one that has
+ * not finished, starts an iteration of a loop. If the pipeline was in the
+ * same state (the stages, shapes and functional unit times of the
+ * instructions in it, relative to j and the clock) at an earlier
+ * iteration, recorded in seen, and the instructions coming in repeat the
+ * ones of that iteration, the whole iterations that repeat are not
+ * simulated: the pipeline moves on by them, and each of their
+ * instructions completes as many ticks after the one an iteration
+ * earlier as the first repeat took. Updates i and j, and returns whether
+ * it moved on.
+ */
+{
+    // the state of the pipeline, which with the instructions still to come
+    // decides everything that happens from here on
+    int n = getNumInstructions();
+    vector<int> state;
+    int end;
+    if (not getState(j, shapes, end, state))
+        return false;
+
+    // remember the state for later iterations; loops that never repeat
+    // should not fill memory with their states
+    const unsigned int remembered = 4096;
+    map<vector<int>, pair<int,int> >::iterator found = seen.find(state);
+    if (found == seen.end())
+    {
+        if (seen.size() >= remembered)
+            seen.clear();
+        seen.insert(make_pair(state, make_pair(myTime, j)));
+        return false;
+    }
+    int period = j - found->second.second;
+    int ticks = myTime - found->second.first;
+    found->second = make_pair(myTime, j);
+
+    // the instructions in the pipeline repeat those of the earlier state;
+    // count the whole iterations after them that repeat too
+    int same = end;
+    while (same < n - 1 and shapes[same] == shapes[same - period])
+        same++;
+    int repeats = (same - end) / period;
+
+    // a part simulated on its own must not pass over the instructions it
+    // notes states at
+    for (unsigned int w = 0; w < mySegment.windows.size(); w++)
+        if (j < mySegment.windows[w].second)
+            repeats = min(repeats, (max(j, mySegment.windows[w].first) - j) / period);
+    if (repeats == 0)
+        return false;
+
+    int shift = repeats * period;
+    int delay = repeats * ticks;
+
+    // move the instructions in the pipeline on by shift, last first since
+    // they may move onto each other
+    vector<PipelineStages> stages;
+    vector<int> leaves;
+    for (int k = j; k < end; k++)
+    {
+        stages.push_back(myPipeline[k]);
+        leaves.push_back(myPipeline.getLeaveTime(k) + delay);
+    }
+    for (int k = end - 1; k >= j; k--)
+        setInstructionRecord(k + shift, getInstructionRecord(k));
+
+    // the instructions passed over finish like those an iteration earlier
+    for (int k = j; k < j + shift; k++)
+    {
+        myCompletionTimes.push_back(myCompletionTimes[k - period - myFirst] + ticks);
+        setInstructionRecord(k, getInstructionRecord(k - period));
+    }
+    myPipeline.reset(j + shift);
+    for (int k = j; k < end; k++)
+        myPipeline.push(stages[k - j], leaves[k - j]);
+
+    // and the clock with them
+    for (int u = 0; u < NUM_UNITS; u++)
+        myUnitFree[u] += delay;
+    vector<int> events;
+    for (; not myEvents.empty(); myEvents.pop())
+        if (myEvents.top() > myTime)
+            events.push_back(myEvents.top() + delay);
+    for (unsigned int e = 0; e < events.size(); e++)
+        myEvents.push(events[e]);
+    myTime += delay;
+
+    i += shift;
+    j += shift;
+    myExtrapolated += shift;
+    return true;
+}
+
+
+bool Pipeline::getState(int j, const vector<int> &shapes, int &end,
+                        vector<int> &state)
+/* Appends to state the state of the pipeline between clock ticks, when
+ * instruction j is the first one that has not finished: the stage, shape,
+ * ticks left on its unit and record of each instruction in the pipeline,
+ * then the ticks until each functional unit is free. Sets end to one past
+ * the last instruction in the pipeline. Returns false if the pipeline
+ * reaches the last instruction, which execute puts in the map early.
+ */
+{
+    int n = getNumInstructions();
+    for (end = j; end < n - 1; end++)
+    {
+        if (not myPipeline.contains(end))
+            break;
+        state.push_back(myPipeline[end]);
+        state.push_back(shapes[end]);
+        state.push_back(max(0, myPipeline.getLeaveTime(end) - myTime));
+        state.push_back(getInstructionRecord(end));
+    }
+    if (end >= n - 1)
+        return false;
+    for (int u = 0; u < NUM_UNITS; u++)
+        state.push_back(max(0, myUnitFree[u] - myTime));
+    return true;
+}
+
+
+void Pipeline::findBlockEnds(vector<int> &blockEnds)
+/* Marks the instructions that start a basic block of the instructions
+ * executed: those after a control instruction and those the program did
+ * not come to from the instruction before. blockEnds[k] is one past the
+ * last instruction of the block k starts, or -1 if k does not start one.
+ */
+{
+    int n = myPcs.size();
+    blockEnds.assign(n, -1);
+    int next = n;
+    for (int k = n - 1; k >= 0; k--)
+    {
+        if (k == 0 or myPcs[k] != myPcs[k-1] + 1
+            or myOpcodes.getInstFunc(getOpcode(k-1)) == CONTROL_I)
+        {
+            blockEnds[k] = next;
+            next = k;
+        }
+    }
+}
+
+
+bool Pipeline::replayBlock(int &i, int &j, const vector<int> &shapes,
+                           const vector<int> &blockEnds)
+/* Called between clock ticks when instruction j, the first one that has
+ * not finished, starts a basic block. If the block cache holds the block
+ * entered in this state, with the same instructions coming in, the block
+ * is not simulated: its instructions complete and the pipeline is left as
+ * when the block was simulated. Otherwise starts recording the block.
+ * Updates i and j, and returns whether it moved on.
+ */
+{
+    // the state of the pipeline and the shapes of the instructions that may
+    // come into it before the block is left make up the key. the key covers
+    // as many instructions after the block as the pipeline can hold
+    int n = myPcs.size();
+    int limit = blockEnds[j] + (NUM_STAGES + 1) * myWidth;
+    vector<int> key;
+    int end;
+    if (limit >= n - 1 or not getState(j, shapes, end, key))
+        return false;
+    for (int k = end; k < limit; k++)
+        key.push_back(shapes[k]);
+
+    const BlockTiming *timing = myBlockCache->find(key);
+    if (timing == NULL)
+    {
+        myBlockStart = j;
+        myBlockEnd = blockEnds[j];
+        myBlockLimit = limit;
+        myBlockTime = myTime;
+        myBlockKey.swap(key);
+        return false;
+    }
+
+    // the instructions of the block complete as they did before
+    for (int k = 0; k < timing->length; k++)
+    {
+        myCompletionTimes.push_back(myTime + timing->completions[k]);
+        setInstructionRecord(j + k, timing->records[k]);
+    }
+
+    // and leave the pipeline in the state they left it in before
+    myTime += timing->ticks;
+    j += timing->length;
+    const vector<int> &state = timing->exitState;
+    int inFlight = (state.size() - NUM_UNITS) / 4;
+    myPipeline.reset(j);
+    for (int k = 0; k < inFlight; k++)
+    {
+        myPipeline.push((PipelineStages) state[4*k], myTime + state[4*k + 2]);
+        setInstructionRecord(j + k, state[4*k + 3]);
+    }
+    for (int u = 0; u < NUM_UNITS; u++)
+        myUnitFree[u] = myTime + state[4*inFlight + u];
+
+    // only the times still to come matter to the events
+    myEvents = priority_queue<int, vector<int>, greater<int> >();
+    for (int k = j; k < j + inFlight; k++)
+        if (myPipeline.getLeaveTime(k) > myTime)
+            myEvents.push(myPipeline.getLeaveTime(k));
+    for (int u = 0; u < NUM_UNITS; u++)
+        if (myUnitFree[u] > myTime)
+            myEvents.push(myUnitFree[u]);
+
+    i = j;
+    while (i < n and myPipeline.contains(i) and myPipeline[i] > FETCH)
+        i++;
+    return true;
+}
+
+
+void Pipeline::recordBlock(int j, const vector<int> &shapes)
+/* Called between clock ticks when j, the first instruction that has not
+ * finished, is past the block being recorded; stores its timing in the
+ * block cache, unless instructions came into the pipeline that its key
+ * does not cover.
+ */
+{
+    int start = myBlockStart;
+    myBlockStart = -1;
+
+    BlockTiming timing;
+    int end;
+    if (not getState(j, shapes, end, timing.exitState) or end > myBlockLimit)
+        return;
+
+    timing.length = j - start;
+    timing.ticks = myTime - myBlockTime;
+    for (int k = start; k < j; k++)
+    {
+        timing.completions.push_back(myCompletionTimes[k] - myBlockTime);
+        timing.records.push_back(getInstructionRecord(k));
+    }
+    myBlockCache->insert(myBlockKey, timing);
+}
+
+
+string Pipeline::getCheckpointFile(string prefix)
+/* Returns the name of the checkpoint file of this model for prefix: the
+ * prefix, a dot and the model's name in lower case, e.g., "run.stall".
+ */
+{
+    string name = myOutput.myPipelineType;
+    for (unsigned int k = 0; k < name.size(); k++)
+        name[k] = tolower(name[k]);
+    return prefix + "." + name;
+}
+
+
+void Pipeline::putCheckpointHeader(Checkpoint &checkpoint)
+/* Appends what identifies a checkpoint of this model for these
+ * instructions: the format, the model, its width, and the number and a
+ * hash of the instructions.
+ */
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned int k = 0; k < myPcs.size(); k++)
+    {
+        string encoding = getInstruction(k).getEncoding();
+        for (unsigned int c = 0; c < encoding.size(); c++)
+            hash = (hash ^ (unsigned char)encoding[c]) * 1099511628211ULL;
+    }
+
+    checkpoint.putString("PIPESIM checkpoint 1");
+    checkpoint.putString(myOutput.myPipelineType);
+    checkpoint.putInt(myWidth);
+    checkpoint.putInt(myPcs.size());
+    checkpoint.putInt(hash);
+}
+
+
+bool Pipeline::loadCheckpoint(string prefix)
+/* Reads the checkpoint of this model in the file named by prefix and the
+ * model (getCheckpointFile), so that execute resumes from it rather than
+ * from the beginning. Returns false if it cannot be read, is damaged, or
+ * was taken of other instructions or another model. If there is no such
+ * file, returns true and execute starts from the beginning.
+ */
+{
+    myResuming = false;
+    string file = getCheckpointFile(prefix);
+    FILE *exists = fopen(file.c_str(), "rb");
+    if (exists == NULL)
+        return true;
+    fclose(exists);
+
+    if (not myResume.read(file))
+        return false;
+
+    // the header must be the one this model would write
+    Checkpoint expected;
+    putCheckpointHeader(expected);
+    vector<unsigned char> bytes;
+    expected.seal(bytes);
+    bytes.resize(bytes.size() - 8);
+    Checkpoint header;
+    header.putString(myResume.getString());
+    header.putString(myResume.getString());
+    for (int k = 0; k < 3; k++)
+        header.putInt(myResume.getInt());
+    vector<unsigned char> found;
+    header.seal(found);
+    found.resize(found.size() - 8);
+
+    myResuming = (myResume.isValid() and found == bytes);
+    return myResuming;
+}
+
+
+void Pipeline::saveCheckpoint(int i, int j, int inserted, int lastFirst,
+                              const map<vector<int>, pair<int,int> > &seen)
+/* Writes a checkpoint of the whole state of execute between clock ticks
+ * in the background: the clock, the completion times and records so far,
+ * the instructions in the pipeline, the functional units and events, and
+ * the state of loop extrapolation, the block cache and any caches or
+ * front end. i, j, inserted and lastFirst are execute's positions and
+ * seen its loop states.
+ */
+{
+    Checkpoint checkpoint;
+    putCheckpointHeader(checkpoint);
+
+    checkpoint.putInt(myTime);
+    checkpoint.putInt(i);
+    checkpoint.putInt(j);
+    checkpoint.putInt(inserted);
+    checkpoint.putInt(lastFirst);
+    checkpoint.putInt(myFetchStalls);
+    checkpoint.putInt(myExtrapolated);
+    checkpoint.putInts(myCompletionTimes, true);
+
+    // most instructions record nothing, so only the others are kept
+    int n = myPcs.size();
+    vector<int> marked, records;
+    for (int k = 0; k < n; k++)
+    {
+        int record = getInstructionRecord(k);
+        if (record == 0)
+            continue;
+        marked.push_back(k);
+        records.push_back(record);
+    }
+    checkpoint.putInts(marked, true);
+    checkpoint.putInts(records);
+
+    // the instructions before j have all finished
+    vector<int> entries;
+    for (int k = j; k < myPipeline.getEnd(); k++)
+    {
+        entries.push_back(k);
+        entries.push_back(myPipeline[k]);
+        entries.push_back(myPipeline.getLeaveTime(k));
+    }
+    checkpoint.putInts(entries);
+
+    vector<int> units(myUnitFree, myUnitFree + NUM_UNITS);
+    checkpoint.putInts(units);
+    vector<int> events;
+    priority_queue<int, vector<int>, greater<int> > pending = myEvents;
+    for (; not pending.empty(); pending.pop())
+        if (pending.top() > myTime)
+            events.push_back(pending.top());
+    checkpoint.putInts(events, true);
+
+    checkpoint.putInt(seen.size());
+    map<vector<int>, pair<int,int> >::const_iterator state;
+    for (state = seen.begin(); state != seen.end(); state++)
+    {
+        checkpoint.putInts(state->first);
+        checkpoint.putInt(state->second.first);
+        checkpoint.putInt(state->second.second);
+    }
+
+    checkpoint.putInt(myBlockCache != NULL);
+    if (myBlockCache != NULL)
+    {
+        myBlockCache->save(checkpoint);
+        checkpoint.putInt(myBlockStart);
+        checkpoint.putInt(myBlockEnd);
+        checkpoint.putInt(myBlockLimit);
+        checkpoint.putInt(myBlockTime);
+        checkpoint.putInts(myBlockKey);
+    }
+    checkpoint.putInt(myDataCache != NULL);
+    if (myDataCache != NULL)
+        myDataCache->save(checkpoint);
+    checkpoint.putInt(myFetchUnit != NULL);
+    if (myFetchUnit != NULL)
+        myFetchUnit->save(checkpoint);
+
+    myCheckpointWriter.write(getCheckpointFile(myOptions.checkpointFile), checkpoint);
+}
+
+
+void Pipeline::restoreCheckpoint(int &i, int &j, int &inserted, int &lastFirst,
+                                 map<vector<int>, pair<int,int> > &seen)
+/* Puts back the state saveCheckpoint wrote, from myResume */
+{
+    myTime = myResume.getInt();
+    i = myResume.getInt();
+    j = myResume.getInt();
+    inserted = myResume.getInt();
+    lastFirst = myResume.getInt();
+    myFetchStalls = myResume.getInt();
+    myExtrapolated = myResume.getInt();
+    myResume.getInts(myCompletionTimes, true);
+
+    vector<int> marked, records;
+    myResume.getInts(marked, true);
+    myResume.getInts(records);
+    for (unsigned int k = 0; k < marked.size() and k < records.size(); k++)
+        setInstructionRecord(marked[k], records[k]);
+
+    // the instructions in the pipeline are those from j on, in order
+    myPipeline.reset(j);
+    vector<int> entries;
+    myResume.getInts(entries);
+    for (unsigned int e = 0; e + 2 < entries.size(); e += 3)
+        if (entries[e] == myPipeline.getEnd())
+            myPipeline.push((PipelineStages) entries[e+1], entries[e+2]);
+
+    vector<int> units, events;
+    myResume.getInts(units);
+    for (int u = 0; u < NUM_UNITS and u < (int)units.size(); u++)
+        myUnitFree[u] = units[u];
+    myResume.getInts(events, true);
+    myEvents = priority_queue<int, vector<int>, greater<int> >(events.begin(),
+                                                                events.end());
+
+    seen.clear();
+    for (int64_t count = myResume.getInt(); count > 0; count--)
+    {
+        vector<int> state;
+        myResume.getInts(state);
+        int time = myResume.getInt();
+        seen[state] = make_pair(time, (int)myResume.getInt());
+    }
+
+    if (myResume.getInt() and myBlockCache != NULL)
+    {
+        myBlockCache->load(myResume);
+        myBlockStart = myResume.getInt();
+        myBlockEnd = myResume.getInt();
+        myBlockLimit = myResume.getInt();
+        myBlockTime = myResume.getInt();
+        myResume.getInts(myBlockKey);
+    }
+    if (myResume.getInt() and myDataCache != NULL)
+        myDataCache->load(myResume);
+    if (myResume.getInt() and myFetchUnit != NULL)
+        myFetchUnit->load(myResume);
+}
+
 void Pipeline::print()
 /* Prints the pipeline time, prints the RAW dependences found in the
  * instructions, prints each instruction with its completion time, and
@@ -106,7 +1318,9 @@ void Pipeline::print()
     cout << myOutput.myPipelineType << ": " << endl;
    
     // print out any dependences found 
-    vector<string> deps = myDependencyChecker.getStringDependences(RAW);
+    // with a range, instructions keep their numbers in the whole run
+    int offset = max(0, myRangeFirst);
+    vector<string> deps = myDependencyChecker.getStringDependences(RAW, offset);
     vector<string>::iterator it;
     for (it = deps.begin(); it != deps.end(); it++)
         cout << (*it) << endl;
@@ -116,19 +1330,113 @@ void Pipeline::print()
    
     // print each instruction number, completion time, and mnemonic
     // one after another
-    vector<Instruction>::iterator iiter = myInstructions.begin();
-    vector<int>::iterator citer = myCompletionTimes.begin();
-    int i = 0;
-    while (iiter != myInstructions.end())
-        cout << i++ << "\t" << *(citer++) << "\t\t\t|"
-             << (iiter++)->getAssembly() << endl;
+    for (unsigned int k = 0; k < myPcs.size(); k++)
+        cout << k + offset << "\t" << myCompletionTimes[k] << "\t\t\t|"
+             << getInstruction(k).getAssembly() << endl;
 
     // finally state the total execution time
-    cout << myOutput.footer << myCompletionTimes.back() << endl << endl;
+    cout << myOutput.footer << getTotalTime() << endl;
+    printRange();
+    printStatistics();
+    cout << endl;
 }
 
 
-void Pipeline::stepPipeline(int current)
+void Pipeline::printRange()
+/* With a range, prints how long its instructions took, counted as the
+ * Sampler counts a sample: from the completion of the last warm-up
+ * instruction, and how many dependences reach before the warm-up.
+ */
+{
+    int n = myPcs.size();
+    if (myRangeFirst < 0 or myRangeStart >= n)
+        return;
+
+    int before = (myRangeStart > 0) ? myCompletionTimes[myRangeStart - 1]
+                                    : NUM_STAGES - 1;
+    int ticks = getTotalTime() - before;
+    cout << "Range " << myRangeFirst + myRangeStart << ":" << myRangeFirst + n
+         << " took " << ticks << " clock ticks after " << myRangeStart
+         << " warm-up instructions, CPI " << (double)ticks / (n - myRangeStart)
+         << endl;
+    if (myDependencyChecker.getEarlierCount() > 0)
+        cout << "Dependences on instructions before the warm-up, taken as finished: "
+             << myDependencyChecker.getEarlierCount() << endl;
+}
+
+
+void Pipeline::printEstimate()
+/* Estimates the total execution time in one pass over the RAW dependences,
+ * without simulating the pipeline clock tick by clock tick, and prints it
+ * with the dependences that cost the most stall cycles. For straight-line
+ * code with one-tick functional units it gives the same total as execute.
+ */
+{
+    cout << myOutput.myPipelineType << " estimate: " << endl;
+    int n = myPcs.size();
+    if (n == 0)
+    {
+        cout << "Estimated total time is 0" << endl << endl;
+        return;
+    }
+
+    // instructions start executing in order, one clock tick apart, unless
+    // they are after a control instruction or wait for a value; start holds
+    // the tick each one starts executing, counted from the first. the
+    // costliest dependences are kept in a small heap, cheapest on top
+    const unsigned int shown = 5;
+    vector<int> start(n);
+    long stalls = 0;
+    priority_queue<pair<int,int>, vector<pair<int,int> >,
+                   greater<pair<int,int> > > hotspots;
+    for (int i = 0; i < n; i++)
+    {
+        start[i] = 0;
+        if (i > 0)
+        {
+            start[i] = start[i-1] + 1;
+            Opcode prevOpc = getOpcode(i-1);
+            if (myOpcodes.getInstFunc(prevOpc) == CONTROL_I)
+                start[i] += getControlDelay();
+        }
+
+        int prev = myDependencyChecker.getPrevDep(i, RAW);
+        if (prev < 0)
+            continue;
+
+        int stall = start[prev] + getValueDelay(getOpcode(prev),
+                                                getOpcode(i)) - start[i];
+        if (stall <= 0)
+            continue;
+
+        start[i] += stall;
+        stalls += stall;
+        hotspots.push(make_pair(stall, i));
+        if (hotspots.size() > shown)
+            hotspots.pop();
+    }
+
+    int last = myOptions.latency[getOpcode(n-1)];
+    cout << "Estimated total time is " << start[n-1] + NUM_STAGES + last - 1
+         << ", with " << stalls << " stall cycles from RAW dependences" << endl;
+
+    // print the costliest first
+    vector<pair<int,int> > costliest;
+    for (; not hotspots.empty(); hotspots.pop())
+        costliest.push_back(hotspots.top());
+    for (int k = costliest.size() - 1; k >= 0; k--)
+    {
+        int curr = costliest[k].second;
+        int prev = myDependencyChecker.getPrevDep(curr, RAW);
+        cout << costliest[k].first << " stall cycles: RAW Dependence between instruction "
+             << prev << ' ' << getInstruction(prev).getAssembly() << " and "
+             << curr << ' ' << getInstruction(curr).getAssembly() << endl;
+    }
+    cout << endl;
+}
+
+
+bool Pipeline::stepPipeline(int current)
 /* A method that increments the clock tick by 1, and makes updates to the
  * pipeline as appropriate. It checks to see if any instructions can finish
  * executing in this clock tick, and if any new instructions can be added.
@@ -140,31 +1448,292 @@ void Pipeline::stepPipeline(int current)
  */
 {
     // check to see each of the instructions in the pipeline, in order
-    // added. if an instruction is not present, then no instructions thereafter
-    // are being executed yet so exit. if an instruction has finished executing,
+    // added, up to the last one that came in; no instructions thereafter are
+    // being executed yet. if an instruction has finished executing,
     // its stage would be 'NUM_STAGES', so skip that and move on to next instr
-    for (unsigned int i=current; i<myInstructions.size(); i++)
+    bool moved = false;
+    int end = myPipeline.getEnd();
+    for (int i=current; i<end; i++)
     {
-        // if not yet in pipeline, stop updating because we reached end of 
-        // active pipeline and instructions beyond current value are not being
-        // executed yet
-        if (myPipeline.find(i) == myPipeline.end())
-            break; 
-
         PipelineStages prevStage = NUM_STAGES;
         if (i>0)
             prevStage = myPipeline[i-1];
 
+        // an instruction may also enter the same stage as the prev
+        // instruction if fewer than myWidth instructions are in that stage
+        // and the pipeline model lets it join their group
+        int next = myPipeline[i]+1;
+        bool joins = (next == prevStage and next < NUM_STAGES
+                      and groupSize(i, prevStage) < myWidth
+                      and not checkPairing(i));
+
         // move on to next state if it is still mid-execution, and if the prev
         // instruction has moved onto the next stage, and if no hazards exist;
         // otherwise stall this instruction in this clock tick
-        if ((myPipeline[i]+1 < prevStage or myPipeline[i]+1 == NUM_STAGES)
+        if ((next < prevStage or next == NUM_STAGES or joins)
+            and (not checkFunctionalUnit(i))
             and (not checkHazards(i)))
         {
-            myPipeline[i] = (PipelineStages) ((int)myPipeline[i] + 1);
+            myPipeline.setStage(i, (PipelineStages) next);
+            enterStage(i);
+            moved = true;
         }
         else
             continue;   // done updating the current instruction 
     }
+
+    return moved;
+}
+
+
+bool Pipeline::checkFunctionalUnit(int i)
+/* Given the index of an instruction, i, determine if it has to stay in its
+ * stage because it is still working on its functional unit, or because it
+ * would start on a unit that is busy with an earlier instruction. returns
+ * whether it must wait (true) or not (false)
+ */
+{
+    // still working in a multi-cycle stage
+    if (myTime < myPipeline.getLeaveTime(i))
+        return true;
+
+    // structural hazard: the unit it needs has not finished the previous
+    // instruction yet
+    FunctionalUnit unit = myOpcodes.getFunctionalUnit(getOpcode(i));
+    if (unit != ALU_UNIT and myPipeline[i]+1 == getWorkStage(i)
+        and myTime < myUnitFree[unit])
+    {
+        myUnitStalls[i - myFirst] = true;
+        return true;
+    }
+
+    return false;
+}
+
+
+void Pipeline::enterStage(int i)
+/* Called after instruction i has moved into the next stage. if that is the
+ * stage it does its work in, notes how long it stays there and how long
+ * its unit is busy.
+ */
+{
+    if (myPipeline[i] != getWorkStage(i))
+        return;
+
+    Opcode opc = getOpcode(i);
+    int latency = getLatency(i);
+    FunctionalUnit unit = myOpcodes.getFunctionalUnit(opc);
+
+    myPipeline.setLeaveTime(i, myTime + latency);
+    if (latency > 1)
+        myEvents.push(myTime + latency);
+
+    if (unit != ALU_UNIT)
+    {
+        myUnitFree[unit] = myTime + (myOptions.pipelined[opc] ? 1 : latency);
+        if (myUnitFree[unit] > myTime + 1)
+            myEvents.push(myUnitFree[unit]);
+    }
+}
+
+
+int Pipeline::getLatency(int i)
+/* Returns the number of clock ticks instruction i spends on its
+ * functional unit. For a load this looks it up in the data cache, so it
+ * must be called once per instruction, when it starts its access.
+ */
+{
+    Opcode opc = getOpcode(i);
+    if (myDataCache != NULL and opc == LW)
+        return myLoadLatencies[i] = max(1, myDataCache->access(myAddresses[i]));
+    return myOptions.latency[opc];
+}
+
+
+int Pipeline::getLatencyTaken(int i)
+/* Returns the number of clock ticks instruction i spent on its
+ * functional unit in the run: for a load the latency the data cache
+ * gave it, and otherwise the latency of its opcode.
+ */
+{
+    if ((unsigned int)i < myLoadLatencies.size() and myLoadLatencies[i] > 0)
+        return myLoadLatencies[i];
+    return myOptions.latency[getOpcode(i)];
+}
+
+
+PipelineStages Pipeline::getWorkStage(int i)
+/* Returns the stage instruction i does its work in on its functional unit:
+ * MEMORY for memory instructions and EXECUTE for all others.
+ */
+{
+    if (myOpcodes.getInstFunc(getOpcode(i)) == MEMORY_I)
+        return MEMORY;
+    return EXECUTE;
+}
+
+
+void Pipeline::printStatistics()
+/* Prints any statistics particular to a pipeline model after the total
+ * execution time. The in-order models report how many instructions waited
+ * for a busy functional unit, if any did, the fetch stalls and cache hits
+ * and misses when there is a front end or data cache, and the dataflow
+ * limit when asked for.
+ */
+{
+    int stalled = 0;
+    for (unsigned int i = 0; i < myUnitStalls.size(); i++)
+        if (myUnitStalls[i])
+            stalled++;
+
+    if (stalled > 0)
+        cout << "Instructions that waited for a busy functional unit: "
+             << stalled << endl;
+    if (myExtrapolated > 0)
+        cout << "Instructions extrapolated from repeating loop iterations: "
+             << myExtrapolated << endl;
+    if (myBlockCache != NULL)
+        myBlockCache->printStatistics();
+
+    if (myFetchUnit != NULL)
+    {
+        cout << "Fetch stall cycles: " << myFetchStalls << endl;
+        myFetchUnit->printStatistics();
+    }
+    if (myDataCache != NULL)
+        myDataCache->printStatistics();
+
+    if (myOptions.criticalPath)
+        printCriticalPath();
+}
+
+
+int Pipeline::getValueDelay(Opcode prev, Opcode curr, int latency)
+/* Given the opcodes of two instructions, prev and curr, where curr reads
+ * a value prev writes after latency clock ticks on its unit, returns the
+ * least number of clock ticks between prev and curr starting to execute
+ * in this pipeline model, from when the value is produced and needed
+ * (myDataSchedule). With no schedule, as in the ideal model, values are
+ * available right away.
+ */
+{
+    if (myDataSchedule.empty())
+        return 0;
+
+    PipelineStages prod = myDataSchedule[myOpcodes.getInstFunc(prev)].produced;
+    PipelineStages reqd = myDataSchedule[myOpcodes.getInstFunc(curr)].required;
+
+    // the value can be used the clock tick after the stage producing it,
+    // which may itself be held up by a multi-cycle unit
+    return max(0, (int)prod - (int)reqd + latency);
+}
+
+
+void Pipeline::printCriticalPath()
+/* Builds the dependence graph of the instructions, weighted for this
+ * pipeline model, and prints the length of its longest path (the least
+ * time any schedule could take, given only the dependences) together
+ * with the chain of instructions on that path.
+ */
+{
+    // a RAW edge waits for the value, a WAW edge keeps the two writes in
+    // order, and a WAR edge only keeps the read from coming after the
+    // write. the checker only keeps the last access to each register, which
+    // would leave out all but one reader of a value, so each register
+    // remembers its last writer and the instructions that read it since,
+    // as in ListScheduler
+    int n = myPcs.size();
+    vector<Dependence> deps;
+    vector<int> weights;
+    vector<int> lastWriter(DependencyChecker::HI_REGISTER + 1, -1);
+    vector<vector<int> > readers(DependencyChecker::HI_REGISTER + 1);
+    for (int i = 0; i < n; i++)
+    {
+        int src[2], dst;
+        myDependencyChecker.getRegisters(getInstruction(i), src, dst);
+
+        Dependence d;
+        d.currentInstructionNumber = i;
+        for (int j = 0; j < 2; j++)
+        {
+            if (src[j] < 0 or lastWriter[src[j]] < 0)
+                continue;
+            int p = lastWriter[src[j]];
+            d.dependenceType = RAW;
+            d.registerNumber = src[j];
+            d.previousInstructionNumber = p;
+            deps.push_back(d);
+            weights.push_back(getValueDelay(getOpcode(p),
+                                            getOpcode(i),
+                                            getLatencyTaken(p)));
+        }
+        for (int j = 0; j < 2; j++)
+            if (src[j] >= 0)
+                readers[src[j]].push_back(i);
+
+        if (dst < 0)
+            continue;
+        d.registerNumber = dst;
+        if (lastWriter[dst] >= 0)
+        {
+            d.dependenceType = WAW;
+            d.previousInstructionNumber = lastWriter[dst];
+            deps.push_back(d);
+            weights.push_back(1);
+        }
+        for (unsigned int r = 0; r < readers[dst].size(); r++)
+        {
+            if (readers[dst][r] == i)
+                continue;
+            d.dependenceType = WAR;
+            d.previousInstructionNumber = readers[dst][r];
+            deps.push_back(d);
+            weights.push_back(0);
+        }
+        readers[dst].clear();
+        lastWriter[dst] = i;
+    }
+
+    // a single instruction takes all the stages, plus the extra ticks its
+    // unit needed
+    vector<int> tail(n);
+    for (int i = 0; i < n; i++)
+        tail[i] = NUM_STAGES + getLatencyTaken(i) - 1;
+
+    DependenceGraph graph(n, deps, weights);
+    vector<int> chain;
+    int limit = graph.getLongestPath(tail, chain);
+
+    cout << "Dataflow limit is " << limit;
+    if (limit > 0)
+        cout << " (total time is " << (double)getTotalTime() / limit
+             << " times the limit)";
+    cout << endl;
+
+    // long chains are cut short after the first few instructions
+    const unsigned int shown = 32;
+    cout << "Critical chain:";
+    for (unsigned int k = 0; k < chain.size() and k < shown; k++)
+        cout << (k ? " -> " : " ") << chain[k];
+    if (chain.size() > shown)
+        cout << " -> ... (" << chain.size() << " instructions)";
+    cout << endl;
+}
+
+
+int Pipeline::groupSize(int i, PipelineStages stage)
+/* Returns the number of instructions right before instruction i that are
+ * in the given stage, i.e., the size of the group i would join by moving
+ * into that stage. Stops counting at myWidth.
+ */
+{
+    int count = 0;
+    for (int k = i-1; k >= 0 and count < myWidth; k--)
+    {
+        if (myPipeline[k] != stage)
+            break;
+        count++;
+    }
+    return count;
 }
 
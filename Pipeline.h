@@ -7,21 +7,19 @@ using namespace std;
 #include <string>
 #include <iostream>
 #include <vector>
-#include "ASMParser.h"
-#include "MachLangParser.h"
+#include <queue>
 #include "DependencyChecker.h"
-
-
-
-/* The stages in the pipeline in the order they appear in the datapath */
-enum PipelineStages{
-  FETCH,
-  DECODE,
-  EXECUTE,
-  MEMORY,
-  WRITEBACK,
-  NUM_STAGES
-};
+#include "SimOptions.h"
+#include "MemoryHierarchy.h"
+#include "FetchUnit.h"
+#include "DependenceGraph.h"
+#include "BlockCache.h"
+#include "Checkpoint.h"
+#include "InstructionStream.h"
+#include "TraceFile.h"
+#include "ProgramLoader.h"
+#include "ProgramEdit.h"
+#include "StageRing.h"
 
 
 
@@ -39,8 +37,19 @@ class Pipeline{
    * the name of a MIPS machine instruction file.  If the input file is
    * not a valid input file (due to syntactical errors or unsupported
    * instructions being specified), the format is considered incorrect.
+   * options may ask for the program to be executed first, in which case
+   * the dynamic instruction stream is simulated instead of the file. A
+   * trace file, written by writeTrace, is simulated as it is.
    */
-  Pipeline(string inputFile);
+  Pipeline(string inputFile, SimOptions options = SimOptions());
+
+  /* Constructs the model with program, the instructions of a program already
+   * parsed, e.g. from a buffer in memory, instead of reading a file. They
+   * are simulated as the instructions of a file would be, executed first if
+   * options ask for it; the options that name files are not used. The format
+   * is incorrect if an instruction is not a supported one.
+   */
+  Pipeline(const vector<Instruction> &program, SimOptions options = SimOptions());
 
   /* Default deconstructor for the Pipeline class
    */
@@ -51,7 +60,14 @@ class Pipeline{
    * instruction and the overall execution time for the set of instructions,
    * storing that information for later printing.
    */
-  void execute();
+  virtual void execute();
+
+  /* Returns a model of the same kind to simulate the instructions from
+   * first on, on another thread: a part, which shares the instructions of
+   * this model and keeps only its own pipeline and the times and records
+   * of its instructions. Models with their own execute need not give one.
+   */
+  virtual Pipeline *makePart(int first) { return new Pipeline(this, first); };
 
   /* Prints the pipeline time, prints the RAW dependences found in the
    * instructions, prints each instruction with its completion time, and
@@ -59,23 +75,159 @@ class Pipeline{
    */
   void print();
 
+  /* Estimates the total execution time in one pass over the RAW dependences,
+   * without simulating the pipeline clock tick by clock tick, and prints it
+   * with the dependences that cost the most stall cycles. For straight-line
+   * code with one-tick functional units it gives the same total as execute.
+   */
+  void printEstimate();
+
+  /* Reads the checkpoint of this model in the file named by prefix and the
+   * model (getCheckpointFile), so that execute resumes from it rather than
+   * from the beginning. Returns false if it cannot be read, is damaged, or
+   * was taken of other instructions or another model. If there is no such
+   * file, returns true and execute starts from the beginning.
+   */
+  bool loadCheckpoint(string prefix);
+
+  /* Returns the name of the checkpoint file of this model for prefix: the
+   * prefix, a dot and the model's name in lower case, e.g., "run.stall".
+   */
+  string getCheckpointFile(string prefix);
+
+  /* Writes the instructions to simulate, with their dependences, to file
+   * as a TraceFile, and sets chunks and bytes to its number of chunks and
+   * size. Returns false if it could not be written.
+   */
+  bool writeTrace(string file, int &chunks, long &bytes);
+
+  /* Reads inputFile as an edit of the input file read last and simulates
+   * it again: only the lines that changed are parsed, the dependences
+   * they change are patched, and the pipeline is simulated from the state
+   * it was in just before the first instruction that changed until it is
+   * in the same state as at the same instruction of the last run; the
+   * rest of the run is the last one, moved. Returns false, leaving the
+   * model to be built again, if it cannot follow the edit or was not
+   * built to (options.watch or options.updateFile).
+   */
+  bool update(string inputFile);
+
+  /* Returns the number of lines that changed in the last update, and the
+   * number of instructions simulated again.
+   */
+  int getChangedLines() { return myEdit ? myEdit->getChangedLines() : 0; };
+  int getResimulated() { return myResimulated; };
+
   /* Returns true if the input file was syntactically correct and only
-   * contained supported instructions.  Otherwise, returns false.
+   * contained supported instructions.  Otherwise, returns false. A model
+   * still reading its input as a stream reads the rest of it first.
+   */
+  bool isFormatCorrect() { finishStream(); return myFormatCorrect; };
+
+  /* Returns true if the model is still reading its input as a stream, so
+   * that execute simulates the instructions as they arrive; whether the
+   * input is formatted correctly is only known once all of it is read.
+   */
+  bool isStreaming() { return myStream != NULL; };
+
+  /* Returns true if the instructions were loaded from the program cache
+   * rather than read from the input file.
+   */
+  bool isCached() { return myCached; };
+
+  /* Returns the name of this pipeline model, e.g., "IDEAL" */
+  string getPipelineType() { return myOutput.myPipelineType; };
+
+  /* Returns the total execution time computed by execute, or 0 if there
+   * were no instructions to execute.
    */
-  bool isFormatCorrect() { return myFormatCorrect; };
+  int getTotalTime()
+    { return myCompletionTimes.empty() ? 0 : myCompletionTimes.back(); };
+
+  /* Returns the completion time of instruction k, once execute has run */
+  int getCompletionTime(int k) { return myCompletionTimes[k - myFirst]; };
+
+  /* Returns the number of instructions simulated */
+  int getNumInstructions() { return myWhole->myPcs.size(); };
+
+  /* Replaces the instructions to simulate with the ones at indices pcs of
+   * program, and forgets any earlier simulation, so that one model can
+   * time many parts of a long run. The parts are simulated without a data
+   * cache or front end.
+   */
+  virtual void setInstructions(const vector<Instruction> &program,
+                               const vector<int> &pcs);
+
+  /* Returns the average number of instructions completed per clock tick
+   * over the whole execution.
+   */
+  double getIPC()
+    { return getTotalTime() ? (double)getNumInstructions() / getTotalTime() : 0; };
+
+  /* Given the opcodes of two instructions, prev and curr, where curr reads
+   * a value prev writes after latency clock ticks on its unit, returns the
+   * least number of clock ticks between prev and curr starting to execute
+   * in this pipeline model, from when the value is produced and needed
+   * (myDataSchedule). With no schedule, as in the ideal model, values are
+   * available right away.
+   */
+  virtual int getValueDelay(Opcode prev, Opcode curr, int latency);
+
+  /* As above, for prev taking the latency the options give its opcode */
+  int getValueDelay(Opcode prev, Opcode curr)
+    { return getValueDelay(prev, curr, myOptions.latency[prev]); };
+
+  /* Returns the number of clock ticks the instruction after a control
+   * instruction is held back by, since there is no branch prediction. The
+   * ideal model does not hold it back.
+   */
+  virtual int getControlDelay() { return 0; };
 
 
  protected:
- 
+
+
+  /* Constructs a part of whole, as makePart returns it: a model with no
+   * data cache, front end or block cache, starting from instruction first
+   * with an empty pipeline, as if the instructions before had long
+   * finished.
+   */
+  Pipeline(Pipeline *whole, int first);
+
 
   /* a private container to hold pipeline data. for each instruction denoted
-    * by its index in myInstructions, enocdes the stage it is in, if currently
+    * by its number in the run, enocdes the stage it is in, if currently
     * being executed in the pipeline. Any instruction in this container is
-    * either in the pipeline or has finished executing (i.e., in stage NUM_STAGES) 
+    * either in the pipeline or has finished executing (i.e., in stage NUM_STAGES).
+    * It only keeps the instructions that may still be in the pipeline, and
+    * the clock tick from which each may leave the stage it does its work in.
     */
-    map<int, PipelineStages> myPipeline;
+    StageRing myPipeline;
    
 
+   /* Prints any statistics particular to a pipeline model after the total
+    * execution time. The in-order models report how many instructions waited
+    * for a busy functional unit, if any did, the fetch stalls and cache hits
+    * and misses when there is a front end or data cache, and the dataflow
+    * limit when asked for.
+    */
+    virtual void printStatistics();
+
+
+   /* The number of instructions that may be in each stage at the same time.
+    * Instructions move through the stages in groups of up to myWidth.
+    */
+    int myWidth;
+
+
+   /* Given the index of an instruction, i, that is about to move into the
+    * same stage as the instructions right before it, determine if it may not
+    * join their group. returns whether it must wait (true) or not (false).
+    * With one instruction per stage there are never groups to join.
+    */
+    virtual bool checkPairing(int i) { return false; };
+
+
    /* Given the index of an instruction, i, determine if there is any kind of hazard
     * at all that might prevent this instruction from moving into the next stage
     * in the pipeline at the current state. is declared as virtual so that any derived
@@ -96,6 +248,43 @@ class Pipeline{
     OpcodeTable myOpcodes;
 
 
+   /* The settings this pipeline was constructed with
+    */
+    SimOptions myOptions;
+
+
+   /* The data caches loads are looked up in, or NULL if the options do not
+    * ask for one, the address each instruction accesses (0 for the
+    * instructions that are not loads) and the latency the cache gave each
+    * load (0 until it has been looked up).
+    */
+    MemoryHierarchy *myDataCache;
+    vector<unsigned int> myAddresses;
+    vector<int> myLoadLatencies;
+
+
+   /* The front end instructions are fetched through, or NULL if the options
+    * do not ask for one, and the number of clock ticks in which the next
+    * instruction could have entered FETCH but had not been fetched yet.
+    */
+    FetchUnit *myFetchUnit;
+    long myFetchStalls;
+
+
+   /* Returns the number of clock ticks instruction i spends on its
+    * functional unit. For a load this looks it up in the data cache, so it
+    * must be called once per instruction, when it starts its access.
+    */
+    int getLatency(int i);
+
+
+   /* Returns the number of clock ticks instruction i spent on its
+    * functional unit in the run: for a load the latency the data cache
+    * gave it, and otherwise the latency of its opcode.
+    */
+    int getLatencyTaken(int i);
+
+
    /* An internal struct to hold data that is computed for later
     * formatting and printing.
     */
@@ -118,11 +307,10 @@ class Pipeline{
     } myOutput;
 
 
-   /* A container to store the instructions in the pipeline.
-    * The container is ordered, and relies on instruction indices for certain
-    * kinds of processing.
+   /* The program the instructions in the pipeline are taken from, each of
+    * its instructions stored once and indexed by pc; myPcs orders them.
     */
-    vector<Instruction> myInstructions;
+    vector<Instruction> myProgram;
    
 
    /* A container to store when each of the instructions would finish executing
@@ -161,16 +349,248 @@ class Pipeline{
     map<InstFunc, ValueSchedule> myDataSchedule;
 
 
+   /* Marks the instructions that had to wait for a busy functional unit
+    */
+    vector<bool> myUnitStalls;
+
+
+   /* The model whose instructions this one simulates: itself, or for a part
+    * the whole model, whose instructions, dependences and producers it reads
+    * rather than copying them. And the first instruction whose completion
+    * time and record this model keeps, which is where a part starts; the
+    * ones before are not kept.
+    */
+    Pipeline *myWhole;
+    int myFirst;
+
+
+   /* Reads the rest of the input, if the model is still reading it as a
+    * stream, without simulating it. Models with an execute of their own
+    * call it before simulating.
+    */
+    void finishStream() { while (takeBatch()) ; };
+
+
+   /* Returns instruction i, as the program holds it */
+    Instruction &getInstruction(int i) { return myWhole->myProgram[myWhole->myPcs[i]]; };
+
+
+   /* Returns the opcode of instruction i */
+    Opcode getOpcode(int i) { return getInstruction(i).getOpcode(); };
+
+
+   /* Returns the instruction whose value instruction i reads, as the
+    * dependency checker's getPrevDep finds it for RAW, or -1 if there is
+    * none. The hazard checks ask for it every clock tick, so execute looks
+    * each one up once.
+    */
+    int getProducer(int i) { return myWhole->myProducers[i]; };
+
+
+   /* Returns true if instruction curr has a dependence of depType on
+    * instruction prev.
+    */
+    bool hasDependence(int prev, int curr, DependenceType depType)
+      { return myWhole->myDependencyChecker.hasDependence(prev, curr, depType); };
+
+
+   /* Return and set what is recorded for instruction k as a number, so that
+    * instructions timed from an earlier loop iteration or a cached basic
+    * block, without simulating them, record the same. Models that record
+    * more add theirs to the number.
+    */
+    virtual int getInstructionRecord(int k) { return myUnitStalls[k - myFirst] ? 1 : 0; };
+    virtual void setInstructionRecord(int k, int record)
+      { myUnitStalls[k - myFirst] = (record & 1); };
+
+
+   /* Replaces what is recorded for the removed instructions from first
+    * with nothing recorded for added new ones, moving the records of the
+    * instructions after them. Models that record more move theirs too.
+    */
+    virtual void spliceRecords(int first, int removed, int added)
+    {
+        myUnitStalls.erase(myUnitStalls.begin() + first,
+                           myUnitStalls.begin() + first + removed);
+        myUnitStalls.insert(myUnitStalls.begin() + first, added, false);
+    };
+
+
  private:
 
 
+    /* Models are not copied: the caches, front end, block cache and edit
+    * they own are not. Parts are made with makePart.
+    */
+    Pipeline(const Pipeline &);
+    Pipeline &operator=(const Pipeline &);
+
+
     /* A method that increments the current clock tick by 1 and updates the
     * stages of instructions in the pipeline wherever possible. calls checkHazards
     * before moving any particular instruction into the next stage 
     * int current: the integer index of the instruction that is currently the
     * first instruction in the pipeline (we ignore instructions that have finished
-    * executing; i.e. the ones that came befoe 'current'). */ 
-    void stepPipeline(int current);
+    * executing; i.e. the ones that came befoe 'current'). returns whether any
+    * instruction moved. */ 
+    bool stepPipeline(int current);
+
+
+    /* Given the index of an instruction, i, determine if it has to stay in its
+    * stage because it is still working on its functional unit, or because it
+    * would start on a unit that is busy with an earlier instruction. returns
+    * whether it must wait (true) or not (false)
+    */
+    bool checkFunctionalUnit(int i);
+
+
+    /* Called after instruction i has moved into the next stage. if that is the
+    * stage it does its work in, notes how long it stays there and how long
+    * its unit is busy.
+    */
+    void enterStage(int i);
+
+
+    /* Returns the stage instruction i does its work in on its functional unit:
+    * MEMORY for memory instructions and EXECUTE for all others.
+    */
+    PipelineStages getWorkStage(int i);
+
+
+    /* Returns the number of instructions right before instruction i that are
+    * in the given stage, i.e., the size of the group i would join by moving
+    * into that stage. Stops counting at myWidth.
+    */
+    int groupSize(int i, PipelineStages stage);
+
+
+    /* Looks up the instruction each instruction reads a value from, for
+    * getProducer.
+    */
+    void findProducers();
+
+
+    /* Builds the data cache levels the options ask for, and takes the address
+    * of each load simulated from addresses, which holds one per instruction.
+    */
+    void createDataCache(vector<unsigned int> &addresses);
+
+
+    /* Builds the front end the options ask for. order gives the index into the
+    * program of each instruction simulated, from which it finds the address
+    * each instruction is fetched from.
+    */
+    void createFetchUnit(const vector<int> &order);
+
+
+    /* Takes the next batch of instructions from myStream into myProgram
+     * and the dependency checker, with their producers, program order and
+     * records. Once there are none left, applies the changes the stream
+     * gives, notes whether the input was formatted correctly, closes the
+     * stream and returns false.
+     */
+    bool takeBatch();
+
+
+    /* Simulates the instructions as execute does while they are read from
+     * myStream: after each batch, the clock loop runs on as far as it can
+     * without the instructions still to come.
+     */
+    void executeStream();
+
+
+    /* Sets the members of a model that has no instructions yet, for the
+     * constructors.
+     */
+    void initialize(SimOptions options);
+
+
+    /* Takes over the instructions to simulate, with their dependences, from
+     * loader, and builds the data cache and front end the options ask for.
+     */
+    void setProgram(ProgramLoader &loader);
+
+
+    /* Notes that the instructions to simulate start with instruction first
+     * of the run, and where the range starts among them.
+     */
+    void setRange(int first);
+
+
+    /* Builds the dependence graph of the instructions, weighted for this
+    * pipeline model, and prints the length of its longest path (the least
+    * time any schedule could take, given only the dependences) together
+    * with the chain of instructions on that path.
+    */
+    void printCriticalPath();
+
+
+    /* With a range, prints how long its instructions took, counted as the
+     * Sampler counts a sample: from the completion of the last warm-up
+     * instruction, and how many dependences reach before the warm-up.
+     */
+    void printRange();
+
+
+    /* Numbers the instructions into shapes: two instructions have the same
+    * shape exactly when they are the same instruction of the program with
+    * the same dependences on the instructions the same distance before them.
+    * Dependences on instructions so far back that they must have left the
+    * pipeline are the same at any distance.
+    */
+    void findShapes(vector<int> &shapes);
+
+
+    /* Called between clock ticks when instruction j, the first one that has
+    * not finished, starts an iteration of a loop. If the pipeline was in the
+    * same state (the stages, shapes and functional unit times of the
+    * instructions in it, relative to j and the clock) at an earlier
+    * iteration, recorded in seen, and the instructions coming in repeat the
+    * ones of that iteration, the whole iterations that repeat are not
+    * simulated: the pipeline moves on by them, and each of their
+    * instructions completes as many ticks after the one an iteration
+    * earlier as the first repeat took. Updates i and j, and returns whether
+    * it moved on.
+    */
+    bool extrapolate(int &i, int &j, const vector<int> &shapes,
+                     map<vector<int>, pair<int,int> > &seen);
+
+
+    /* Appends to state the state of the pipeline between clock ticks, when
+    * instruction j is the first one that has not finished: the stage, shape,
+    * ticks left on its unit and record of each instruction in the pipeline,
+    * then the ticks until each functional unit is free. Sets end to one past
+    * the last instruction in the pipeline. Returns false if the pipeline
+    * reaches the last instruction, which execute puts in the map early.
+    */
+    bool getState(int j, const vector<int> &shapes, int &end, vector<int> &state);
+
+
+    /* Marks the instructions that start a basic block of the instructions
+    * executed: those after a control instruction and those the program did
+    * not come to from the instruction before. blockEnds[k] is one past the
+    * last instruction of the block k starts, or -1 if k does not start one.
+    */
+    void findBlockEnds(vector<int> &blockEnds);
+
+
+    /* Called between clock ticks when instruction j, the first one that has
+    * not finished, starts a basic block. If the block cache holds the block
+    * entered in this state, with the same instructions coming in, the block
+    * is not simulated: its instructions complete and the pipeline is left as
+    * when the block was simulated. Otherwise starts recording the block.
+    * Updates i and j, and returns whether it moved on.
+    */
+    bool replayBlock(int &i, int &j, const vector<int> &shapes,
+                     const vector<int> &blockEnds);
+
+
+    /* Called between clock ticks when j, the first instruction that has not
+    * finished, is past the block being recorded; stores its timing in the
+    * block cache, unless instructions came into the pipeline that its key
+    * does not cover.
+    */
+    void recordBlock(int j, const vector<int> &shapes);
  
 
     /* Internal variable to keep track of whether or not the input files are
@@ -180,12 +600,179 @@ class Pipeline{
     bool myFormatCorrect;
 
 
+    /* Whether the instructions were loaded from the program cache */
+    bool myCached;
+
+
+    /* The input still being read, from which execute takes the instructions
+    * as they are decoded, or NULL once it is read or if it is not streamed.
+    */
+    InstructionStream *myStream;
+
+
+    /* The input file followed through its edits, or NULL if the options do
+    * not ask for it or the instructions are not the lines of the file; the
+    * state of the pipeline (as getState gives it, without shapes) and the
+    * clock tick when each instruction was first the first one that had not
+    * finished, empty if it never was or the pipeline reached the last
+    * instruction; and the number of instructions the last update simulated.
+    */
+    ProgramEdit *myEdit;
+    vector<vector<int> > myStates;
+    vector<int> myStateTimes;
+    vector<int> myNoShapes;
+    bool myNoteStates;
+    int myResimulated;
+
+
+    /* With a range, the number in the run of the first instruction to
+     * simulate, or -1 without one, and the index of the first instruction
+     * of the range, after the warm-up.
+     */
+    int myRangeFirst;
+    int myRangeStart;
+
+
    /* A clock ticker that keeps track of how far along the CPU has progressed.
     * Is incremented by execute by at least one, or more if intermediate clock
     * ticks may be skipped (relevant to other kinds of pipeline models).
     */
     int myTime;
 
+
+   /* The instruction each instruction reads a value from, or -1 */
+    vector<int> myProducers;
+
+
+   /* The clock tick from which each functional unit can start another
+    * instruction. ALUs are never busy since there are as many as needed.
+    */
+    int myUnitFree[NUM_UNITS];
+
+
+   /* Clock ticks at which a multi-cycle instruction may leave its stage or
+    * a functional unit becomes free, earliest first. When no instruction can
+    * move, nothing changes until the earliest of these, so the simulation
+    * jumps straight to it.
+    */
+    priority_queue<int, vector<int>, greater<int> > myEvents;
+
+
+   /* The index into myProgram of each instruction simulated, in order, and
+    * the number of instructions whose timing was extrapolated from an
+    * earlier loop iteration instead of simulated.
+    */
+    vector<int> myPcs;
+    long myExtrapolated;
+
+
+   /* The basic block timings the pipeline remembers, or NULL if the options
+    * do not ask for them, and the block being recorded: its first and one
+    * past its last instruction (myBlockStart is -1 if none is), the last
+    * instruction its key covers, the clock tick it was entered at, and its
+    * key.
+    */
+    BlockCache *myBlockCache;
+    int myBlockStart;
+    int myBlockEnd;
+    int myBlockLimit;
+    int myBlockTime;
+    vector<int> myBlockKey;
+
+
+   /* The checkpoint execute resumes from, read by loadCheckpoint, whether
+    * there is one, and the writer of the checkpoints execute takes.
+    */
+    Checkpoint myResume;
+    bool myResuming;
+    CheckpointWriter myCheckpointWriter;
+
+
+    /* Appends what identifies a checkpoint of this model for these
+    * instructions: the format, the model, its width, and the number and a
+    * hash of the instructions.
+    */
+    void putCheckpointHeader(Checkpoint &checkpoint);
+
+
+    /* Writes a checkpoint of the whole state of execute between clock ticks
+    * in the background: the clock, the completion times and records so far,
+    * the instructions in the pipeline, the functional units and events, and
+    * the state of loop extrapolation, the block cache and any caches or
+    * front end. i, j, inserted and lastFirst are execute's positions and
+    * seen its loop states.
+    */
+    void saveCheckpoint(int i, int j, int inserted, int lastFirst,
+                        const map<vector<int>, pair<int,int> > &seen);
+
+
+    /* Puts back the state saveCheckpoint wrote, from myResume */
+    void restoreCheckpoint(int &i, int &j, int &inserted, int &lastFirst,
+                           map<vector<int>, pair<int,int> > &seen);
+
+
+    /* The clock loop of execute: simulates clock ticks until every instruction
+    * has finished, or until instruction stop is the first one that has not.
+    * i, j, inserted and lastFirst are execute's positions, seen its loop
+    * states, and shapes and blockEnds what findShapes and findBlockEnds
+    * found, if anything.
+    */
+    void run(int &i, int &j, int &inserted, int &lastFirst,
+             map<vector<int>, pair<int,int> > &seen,
+             const vector<int> &shapes, const vector<int> &blockEnds, int stop);
+
+
+    /* What a part simulating some of the instructions on its own keeps: its positions in the clock loop and loop states, where it
+    * stops for now, the windows of instructions at which it notes the state
+    * of the pipeline, the shapes it extrapolates with and the ones it notes
+    * states with, and for each instruction in a window, the clock tick and
+    * state when it was first the first one that had not finished.
+    */
+    struct Segment
+    {
+        int i, j, inserted, lastFirst;
+        map<vector<int>, pair<int,int> > seen;
+        int stop;
+        vector<pair<int,int> > windows;
+        const vector<int> *shapes;
+        const vector<int> *stateShapes;
+        map<int, pair<int, vector<int> > > states;
+    };
+    Segment mySegment;
+
+
+    /* Simulates the instructions in parts, each on a part of the model on a
+    * thread of its own, started with an empty pipeline as if the
+    * instructions before had long finished. Each part is then checked
+    * against the one before: from the first instruction in a window past
+    * its start at which both were in the same state, its times are right,
+    * shifted by the difference of their clocks; if there is none, the part
+    * before is simulated on into it. The times are exactly those of
+    * simulating every instruction in turn. Returns false, doing nothing, if
+    * there are too few instructions to split.
+    */
+    bool executeParallel(const vector<int> &shapes);
+
+
+    /* Runs the clock loop of a part, as set up in mySegment, to its stop */
+    void runSegment();
+
+
+    /* The body of a thread simulating a part; model is the part */
+    static void *startSegment(void *model);
+
+
+    /* Called between clock ticks of a part when instruction j is first the
+    * first one that has not finished; notes the state if j is in a window.
+    */
+    void recordSegmentState(int j);
+
+
+    /* Takes the completion times and records of instructions from to to-1
+    * from part, its clock shifted by delta.
+    */
+    void copySegment(Pipeline *part, int from, int to, int delta);
+
 };
 
 #endif
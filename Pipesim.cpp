@@ -1,11 +1,324 @@
 #include "Pipeline.h"
 #include "StallPipeline.h"
 #include "DataForwardPipeline.h"
+#include "OutOfOrderPipeline.h"
+#include "SuperscalarPipeline.h"
+#include "ListScheduler.h"
+#include "RegisterRenamer.h"
+#include "SlotFiller.h"
+#include "Sampler.h"
+#include "Simulator.h"
+#include "SimServer.h"
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
+#include <climits>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
 
 using namespace std;
 
+/* Reads a cache shape written as SIZE:LINE:WAYS, e.g. "8192:32:2", into
+ * config. Returns false if it is not of that form.
+ */
+bool parseCacheConfig(string setting, CacheConfig &config)
+{
+  int size, line, ways;
+  char extra;
+  if(sscanf(setting.c_str(), "%d:%d:%d%c", &size, &line, &ways, &extra) != 3)
+    return false;
+  if(size <= 0 || line <= 0 || ways <= 0)
+    return false;
+  config = CacheConfig(size, line, ways);
+  return true;
+}
+
+/* Reads text, the value given to option name, into value. Exits, saying
+ * why, if it is not a whole number from low up to high.
+ */
+void parseBounded(string name, const char *text, int low, int high, int &value)
+{
+  char *end;
+  long number = strtol(text, &end, 10);
+  if(*text == '\0' || *end != '\0' || number < low || number > high){
+    cerr << name << " must be a number from " << low;
+    if(high < INT_MAX)
+      cerr << " to " << high;
+    else
+      cerr << " up";
+    cerr << endl;
+    exit(1);
+  }
+  value = number;
+}
+
+/* Reads the command line options in argv into options, and stores the
+ * name of the input file in inputFile. Returns false if the command line
+ * could not be understood.
+ */
+bool parseArguments(int argc, char *argv[], SimOptions &options, string &inputFile,
+                    string &request, string &server)
+{
+  OpcodeTable opcodes;
+  for(int a = 1; a < argc; a++){
+    string arg = argv[a];
+    if(arg == "-x" || arg == "--execute")
+      options.execute = true;
+    else if(arg == "--max-steps" && a+1 < argc)
+      options.maxSteps = atol(argv[++a]);
+    else if(arg == "--ooo")
+      options.outOfOrder = true;
+    else if(arg == "--superscalar")
+      options.superscalar = true;
+    else if(arg == "--rob" && a+1 < argc)
+      parseBounded(arg, argv[++a], 1, INT_MAX, options.robSize);
+    else if(arg == "--width" && a+1 < argc)
+      parseBounded(arg, argv[++a], 1, INT_MAX, options.issueWidth);
+    else if(arg == "--rs" && a+1 < argc)
+      // the out-of-order model wakes reservation stations with a bitmask
+      // of one 64-bit word
+      parseBounded(arg, argv[++a], 1, OutOfOrderPipeline::MAX_RS, options.rsSize);
+    else if(arg == "--latency" && a+1 < argc){
+      // e.g. "--latency mult=4"
+      string setting = argv[++a];
+      string::size_type eq = setting.find('=');
+      if(eq == string::npos)
+        return false;
+      Opcode o = opcodes.getOpcode(setting.substr(0, eq));
+      if(o == UNDEFINED)
+        return false;
+      options.latency[o] = max(1, atoi(setting.substr(eq+1).c_str()));
+    }
+    else if(arg == "--unpipelined" && a+1 < argc){
+      Opcode o = opcodes.getOpcode(argv[++a]);
+      if(o == UNDEFINED)
+        return false;
+      options.pipelined[o] = false;
+    }
+    else if(arg == "--dcache" && a+1 < argc){
+      // e.g. "--dcache 8192:32:2"
+      if(!parseCacheConfig(argv[++a], options.l1))
+        return false;
+      options.dataCache = true;
+    }
+    else if(arg == "--l2" && a+1 < argc){
+      if(!parseCacheConfig(argv[++a], options.l2))
+        return false;
+      options.dataCache = true;
+    }
+    else if(arg == "--replacement" && a+1 < argc){
+      string policy = argv[++a];
+      if(policy == "lru")
+        options.replacement = LRU;
+      else if(policy == "plru")
+        options.replacement = PLRU;
+      else
+        return false;
+    }
+    else if(arg == "--l2-latency" && a+1 < argc)
+      options.l2Latency = max(1, atoi(argv[++a]));
+    else if(arg == "--mem-latency" && a+1 < argc)
+      options.memLatency = max(1, atoi(argv[++a]));
+    else if(arg == "--icache" && a+1 < argc){
+      if(!parseCacheConfig(argv[++a], options.icache))
+        return false;
+      options.frontEnd = true;
+    }
+    else if(arg == "--fetch-width" && a+1 < argc){
+      options.fetchWidth = max(4, atoi(argv[++a]));
+      options.frontEnd = true;
+    }
+    else if(arg == "--fetch-buffer" && a+1 < argc){
+      options.fetchBuffer = max(1, atoi(argv[++a]));
+      options.frontEnd = true;
+    }
+    else if(arg == "--critical-path")
+      options.criticalPath = true;
+    else if(arg == "--no-extrapolate")
+      options.extrapolate = false;
+    else if(arg == "--block-cache" && a+1 < argc)
+      options.blockCache = max(0, atoi(argv[++a]));
+    else if(arg == "--sample" && a+1 < argc){
+      char extra;
+      if(sscanf(argv[++a], "%d:%d%c", &options.sampleUnit, &options.samplePeriod,
+                &extra) != 2 || options.sampleUnit <= 0 || options.samplePeriod <= 0)
+        return false;
+    }
+    else if(arg == "--simpoint" && a+1 < argc){
+      options.simpoints = max(1, atoi(argv[++a]));
+      if(options.sampleUnit == 0)
+        options.sampleUnit = 1000;
+    }
+    else if(arg == "--warmup" && a+1 < argc)
+      options.sampleWarmup = max(0, atoi(argv[++a]));
+    else if(arg == "--target-error" && a+1 < argc)
+      options.targetError = max(0.0, atof(argv[++a]) / 100);
+    else if(arg == "--stream")
+      options.stream = true;
+    else if(arg == "--range" && a+1 < argc){
+      char extra;
+      if(sscanf(argv[++a], "%d:%d%c", &options.rangeStart, &options.rangeEnd,
+                &extra) != 2 || options.rangeStart < 0
+         || options.rangeEnd <= options.rangeStart)
+        return false;
+    }
+    else if(arg == "--threads" && a+1 < argc)
+      options.threads = max(1, atoi(argv[++a]));
+    else if(arg == "--checkpoint" && a+1 < argc)
+      options.checkpointFile = argv[++a];
+    else if(arg == "--checkpoint-every" && a+1 < argc)
+      options.checkpointEvery = max(1, atoi(argv[++a]));
+    else if(arg == "--resume" && a+1 < argc)
+      options.resumeFile = argv[++a];
+    else if(arg == "--cache" && a+1 < argc)
+      options.cacheDir = argv[++a];
+    else if(arg == "--cache-limit" && a+1 < argc)
+      options.cacheLimit = max(0L, atol(argv[++a])) << 20;
+    else if(arg == "--write-trace" && a+1 < argc)
+      options.traceFile = argv[++a];
+    else if(arg == "--estimate")
+      options.estimate = true;
+    else if(arg == "--schedule" && a+1 < argc)
+      options.scheduleFile = argv[++a];
+    else if(arg == "--fill-slots" && a+1 < argc)
+      options.fillFile = argv[++a];
+    else if(arg == "--rename" && a+1 < argc)
+      options.renameFile = argv[++a];
+    else if(arg == "--serve" && a+1 < argc)
+      options.serveSocket = argv[++a];
+    else if(arg == "--workers" && a+1 < argc)
+      options.workers = max(0, atoi(argv[++a]));
+    else if(arg == "--result-cache" && a+1 < argc)
+      options.resultCache = max(0, atoi(argv[++a]));
+    else if((arg == "--request" || arg == "--stats" || arg == "--shutdown") && a+1 < argc){
+      request = arg;
+      server = argv[++a];
+    }
+    else if(arg == "--watch")
+      options.watch = true;
+    else if(arg == "--update" && a+1 < argc)
+      options.updateFile = argv[++a];
+    else if(arg == "--schedule-for" && a+1 < argc){
+      string model = argv[++a];
+      if(model == "stall")
+        options.scheduleForStall = true;
+      else if(model == "forward")
+        options.scheduleForStall = false;
+      else
+        return false;
+    }
+    else if(arg.length() > 0 && arg.at(0) == '-')
+      return false;
+    else
+      inputFile = arg;
+  }
+
+  // every cache in use replaces lines the same way, which pseudo-LRU can
+  // only do for some numbers of ways
+  CacheConfig used[] = {options.l1, options.l2, options.icache};
+  bool present[] = {options.dataCache, options.dataCache && options.l2.size > 0,
+                    options.frontEnd};
+  for(int c = 0; c < 3; c++)
+    if(present[c] && !Cache::canReplace(used[c].ways, options.replacement)){
+      cerr << "--replacement plru needs a power of two ways, at most 64, not "
+           << used[c].ways << endl;
+      exit(1);
+    }
+
+  // a server, and a request for its statistics or to shut it down, need
+  // no input file
+  return inputFile.length() != 0 || options.serveSocket.length() != 0
+         || (request.length() != 0 && request != "--request");
+}
+
+/* Sends the request command (--request, --stats or --shutdown) to the
+ * server on socket, for --request to simulate inputFile, and prints the
+ * answer. Returns false if there is no answer.
+ */
+bool sendRequest(string command, string socket, string inputFile)
+{
+  string text;
+  if(command == "--stats")
+    text = "STATS\n";
+  else if(command == "--shutdown")
+    text = "SHUTDOWN\n";
+  else{
+    FILE *in = fopen(inputFile.c_str(), "rb");
+    if(in == NULL)
+      return false;
+    string program;
+    char buffer[65536];
+    size_t got;
+    while((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+      program.append(buffer, got);
+    fclose(in);
+    char header[64];
+    sprintf(header, " %lu\n", (unsigned long)program.size());
+    text = "SIMULATE " + inputFile.substr(inputFile.find_last_of('.')+1) + header + program;
+  }
+
+  string response;
+  if(!SimServer::request(socket, text, response))
+    return false;
+  cout << response;
+  return true;
+}
+
+/* Returns the milliseconds since some fixed time, to time updates with */
+double getMilliseconds()
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+/* Simulates inputFile, an edit of the file the models simulated last, on
+ * each of them: from where it changed if the model can follow the edit,
+ * by building the model again if not. Prints the models, then how much
+ * each simulated again. Returns false, keeping the models as they were,
+ * if inputFile is not formatted correctly.
+ */
+bool simulateEdit(vector<Pipeline*> &models, string inputFile, const SimOptions &options)
+{
+  vector<double> took(models.size());
+  vector<bool> rebuilt(models.size(), false);
+  for(unsigned int m = 0; m < models.size(); m++){
+    double start = getMilliseconds();
+    if(!models[m]->update(inputFile)){
+      Pipeline *model = Simulator::createModel(models[m]->getPipelineType(), inputFile,
+                                               options);
+      if(!model->isFormatCorrect()){
+        delete model;
+        return false;
+      }
+      if(options.estimate)
+        model->printEstimate();
+      else
+        model->execute();
+      delete models[m];
+      models[m] = model;
+      rebuilt[m] = true;
+    }
+    took[m] = getMilliseconds() - start;
+  }
+
+  for(unsigned int m = 0; m < models.size(); m++)
+    if(!options.estimate)
+      models[m]->print();
+  for(unsigned int m = 0; m < models.size(); m++){
+    cout << "UPDATE: " << models[m]->getPipelineType();
+    if(rebuilt[m])
+      cout << " read the whole file again";
+    else
+      cout << " simulated " << models[m]->getResimulated() << " of "
+           << models[m]->getNumInstructions() << " instructions again after "
+           << models[m]->getChangedLines() << " changed lines";
+    cout << " in " << took[m] << " ms" << endl;
+  }
+  return true;
+}
+
 /* This program is provided the name of an input file.  The input
  * file either contains only synatically correct and supported MIPS
  * assembly instructions (one per line) or contains only synactically
@@ -16,40 +329,297 @@ using namespace std;
  * data forwarding pipeline, with information printed about the relevant
  * dependences that might cause stalling as well, when each instruction
  * completes, and the overall execution time for each pipeline.
+ * With -x (--execute), the program is executed first and the instructions
+ * in the order they execute are simulated instead; --max-steps N bounds
+ * the number of instructions executed. --ooo also simulates an
+ * out-of-order pipeline, whose ROB size, issue width and number of
+ * reservation stations are set with --rob N, --width N and --rs N (at
+ * least 1 each, and at most 64 reservation stations), and --superscalar
+ * an in-order pipeline issuing --width N instructions.
+ * --latency OP=N makes instructions OP spend N clock ticks on their
+ * functional unit, and --unpipelined OP keeps the unit busy meanwhile.
+ * --dcache SIZE:LINE:WAYS looks loads up in a data cache, backed by an L2
+ * given with --l2 SIZE:LINE:WAYS and then memory; --replacement lru|plru,
+ * --l2-latency N and --mem-latency N set how they behave (plru needs a
+ * power of two ways, at most 64, in every cache). An L1 hit takes
+ * the LW latency. --icache SIZE:LINE:WAYS, --fetch-width BYTES and
+ * --fetch-buffer N fetch instructions through an instruction cache, in
+ * blocks of BYTES, into a buffer of N instructions. --critical-path
+ * prints the dataflow limit of each model and the chain of instructions
+ * that sets it. --estimate only estimates the ideal, stalling and
+ * dataforwarding models from their dependences, without simulating them,
+ * and lists the dependences that cost the most stall cycles.
+ * Iterations of a loop that repeat exactly are timed from the first repeat
+ * rather than simulated; --no-extrapolate simulates every one of them.
+ * --block-cache N remembers the timing of up to N basic blocks by the
+ * state of the pipeline they are entered in, times blocks entered in a
+ * remembered state from it, and reports the hit rate.
+ * --schedule FILE reorders the instructions within each basic block to
+ * reduce stalls in the dataforwarding model (or the stalling model, with
+ * --schedule-for stall), writes the new program to FILE (.asm or .mach),
+ * and simulates it to compare the total times. --rename FILE first moves
+ * values into free registers where that removes WAR and WAW dependences,
+ * writes the new program to FILE (.asm or .mach), and reports how many
+ * dependences are left; --schedule then reorders the renamed program.
+ * --fill-slots FILE moves independent instructions into the bubbles the
+ * stalling model inserts, writes the new program to FILE, and reports the
+ * stall cycles recovered.
+ * --sample UNIT:PERIOD estimates each model's CPI and total time, with a
+ * 95% confidence interval, by simulating every PERIOD-th interval of UNIT
+ * instructions after --warmup N instructions, and fast-forwarding through
+ * the rest. --simpoint K instead samples clusters of intervals that run
+ * similar code. --target-error PCT stops sampling once the confidence
+ * interval is within PCT percent of the estimate.
+ * --threads N splits the simulation of each in-order model into N parts
+ * simulated at the same time, which give exactly the times of simulating
+ * it in one piece; it does not split runs with caches, a front end, the
+ * block cache or checkpoints.
+ * --stream reads and decodes the input file on threads of their own,
+ * passing batches of instructions on as they are ready, while each model
+ * checks the dependences of the batches before and, unless it needs the
+ * whole program first, simulates them.
+ * --write-trace FILE writes the instructions simulated, decoded and with
+ * their dependences, to FILE as a compact binary trace; an input file
+ * whose extension is "trace" is such a trace, simulated as it is.
+ * --range START:END simulates only the instructions from START up to END
+ * of the run, after --warmup N instructions before them, and reports how
+ * long the range took, and how many dependences reach before the warm-up.
+ * In a trace it reads only the chunks that hold them; other inputs are
+ * read, and executed, in full first.
+ * --cache DIR keeps each program read, with its dependences, in DIR, and
+ * loads it from there when the same input is read again with the same
+ * PIPESIM and -x setting; the entries are kept under --cache-limit MB
+ * (256 by default) by removing the least recently used.
+ * --checkpoint PREFIX writes the state of each in-order model to
+ * PREFIX.<model> every --checkpoint-every N completed instructions (100000
+ * by default), in the background. --resume PREFIX continues each model
+ * from its checkpoint, if it has one, and prints what the whole run would;
+ * the other options may differ, so that runs can fan out from one warm
+ * state.
+ * --update FILE simulates the input file, then FILE as an edit of it,
+ * reading, checking and simulating again only from where it changed until
+ * each model is back in the state it was in at the same instruction, and
+ * prints the models for FILE and how much was simulated again. --watch
+ * simulates the input file again in the same way each time it is saved,
+ * until PIPESIM is stopped. Runs executed with -x, with caches or a front
+ * end, or of the out-of-order model are read again in full.
+ * --serve SOCKET runs PIPESIM as a server on the Unix domain socket
+ * SOCKET, answering requests (see SimServer.h) on --workers N threads
+ * with the models and settings of the other options, and keeping the
+ * last --result-cache N answers (4096 by default) to give again.
+ * --request SOCKET sends the input file to such a server and prints its
+ * answer; --stats SOCKET prints what it has served and --shutdown SOCKET
+ * stops it.
  */
 int main(int argc, char *argv[])
 {
-  if(argc < 2){
+  SimOptions options;
+  string inputFile, request, server;
+  if(argc < 2 || !parseArguments(argc, argv, options, inputFile, request, server)){
     cerr << "Need to enter input file " << endl;
     exit(1);
   }
 
-  Pipeline *ideal = new Pipeline(argv[1]);
-  if(ideal->isFormatCorrect() == false){
-    cerr << "Input file is not formatted correctly " << endl;
-    exit(1);
+  // serve requests until asked to stop, or send one to a server
+  if(options.serveSocket.length() != 0){
+    SimServer simServer(options.serveSocket, options);
+    if(!simServer.listen()){
+      cerr << "Could not listen on " << options.serveSocket << endl;
+      exit(1);
+    }
+    simServer.run();
+    return 0;
+  }
+  if(request.length() != 0){
+    if(!sendRequest(request, server, inputFile)){
+      cerr << "No answer from " << server << endl;
+      exit(1);
+    }
+    return 0;
   }
-  ideal->execute();
-  ideal->print();
 
-  Pipeline *stall = new StallPipeline(argv[1]);
-  if(stall->isFormatCorrect() == false){
-    cerr << "Input file is not formatted correctly " << endl;
-    exit(1);
+  // estimate the models from samples of the run instead of simulating it
+  if(options.sampleUnit > 0){
+    Sampler sampler(inputFile, options);
+    if(!sampler.isFormatCorrect()){
+      cerr << "Input file is not formatted correctly " << endl;
+      exit(1);
+    }
+    SimOptions each = sampler.getModelOptions();
+    vector<Pipeline*> sampled;
+    sampled.push_back(new Pipeline(inputFile, each));
+    sampled.push_back(new StallPipeline(inputFile, each));
+    sampled.push_back(new DataForwardPipeline(inputFile, each));
+    if(options.superscalar)
+      sampled.push_back(new SuperscalarPipeline(inputFile, each));
+    if(options.outOfOrder)
+      sampled.push_back(new OutOfOrderPipeline(inputFile, each));
+    for(unsigned int m = 0; m < sampled.size(); m++){
+      sampler.print(*sampled[m]);
+      delete sampled[m];
+    }
+    return 0;
   }
-  stall->execute();
-  stall->print();
 
-  Pipeline *forward = new DataForwardPipeline(argv[1]);
-  if(forward->isFormatCorrect() == false){
+  // the pipeline models to simulate, in the order they are printed
+  vector<Pipeline*> models;
+  models.push_back(new Pipeline(inputFile, options));
+  models.push_back(new StallPipeline(inputFile, options));
+  models.push_back(new DataForwardPipeline(inputFile, options));
+  if(options.superscalar && !options.estimate)
+    models.push_back(new SuperscalarPipeline(inputFile, options));
+  if(options.outOfOrder && !options.estimate)
+    models.push_back(new OutOfOrderPipeline(inputFile, options));
+
+  for(unsigned int m = 0; m < models.size(); m++){
+    // a model still reading a streamed input only knows whether it is
+    // formatted correctly once execute has read all of it
+    if(!models[m]->isStreaming() && models[m]->isFormatCorrect() == false){
+      cerr << "Input file is not formatted correctly " << endl;
+      exit(1);
+    }
+    if(options.estimate){
+      if(options.updateFile.empty())
+        models[m]->printEstimate();
+      continue;
+    }
+    if(!options.resumeFile.empty() && !models[m]->loadCheckpoint(options.resumeFile)){
+      cerr << "Checkpoint " << models[m]->getCheckpointFile(options.resumeFile)
+           << " is damaged or is not of this program and model " << endl;
+      exit(1);
+    }
+    models[m]->execute();
+    if(models[m]->isFormatCorrect() == false){
+      cerr << "Input file is not formatted correctly " << endl;
+      exit(1);
+    }
+    if(options.updateFile.empty())
+      models[m]->print();
+  }
+
+  // simulate an edit of the input, or each edit as it is saved, from
+  // where it changed
+  if(!options.updateFile.empty() && !simulateEdit(models, options.updateFile, options)){
     cerr << "Input file is not formatted correctly " << endl;
     exit(1);
   }
-  forward->execute();
-  forward->print();
+  struct stat last, now;
+  if(options.watch && stat(inputFile.c_str(), &last) == 0){
+    while(true){
+      usleep(100000);
+      if(stat(inputFile.c_str(), &now) != 0
+         || (now.st_mtim.tv_sec == last.st_mtim.tv_sec
+             && now.st_mtim.tv_nsec == last.st_mtim.tv_nsec && now.st_size == last.st_size))
+        continue;
+      last = now;
+      if(!simulateEdit(models, inputFile, options))
+        cerr << "Input file is not formatted correctly " << endl;
+    }
+  }
+
+  // compare the wider models against the single-issue ones
+  if((options.outOfOrder || options.superscalar) && !options.estimate){
+    cout << "IPC:";
+    for(unsigned int m = 0; m < models.size(); m++)
+      cout << " " << models[m]->getPipelineType() << " " << models[m]->getIPC();
+    cout << endl;
+  }
+
+  // keep the instructions simulated, to simulate them again without
+  // parsing, executing or checking them
+  if(options.traceFile.length() != 0){
+    int chunks;
+    long bytes;
+    if(!models[0]->writeTrace(options.traceFile, chunks, bytes)){
+      cerr << "Could not write " << options.traceFile << endl;
+      exit(1);
+    }
+    cout << "TRACE: wrote " << options.traceFile << ", " << bytes << " bytes in "
+         << chunks << " chunks" << endl;
+  }
+
+  // report how the program cache did, and keep it within its limit
+  if(options.cacheDir.length() != 0){
+    int hits = 0;
+    for(unsigned int m = 0; m < models.size(); m++)
+      if(models[m]->isCached())
+        hits++;
+    ProgramCache cache(options.cacheDir);
+    int evicted = cache.evict(options.cacheLimit);
+
+    // the entries hold no load addresses, which only executing the program
+    // again gives, so a run with a data cache neither reads nor writes them
+    cout << "CACHE: ";
+    if(options.dataCache)
+      cout << "not used with --dcache, ";
+    else
+      cout << hits << " hits, " << models.size() - hits << " misses, ";
+    cout << evicted << " evicted, " << cache.getEntryCount() << " entries of "
+         << cache.getSize() << " bytes" << endl;
+  }
+
+  // rename registers to remove false dependences, and go on with the
+  // renamed program
+  string rewritten = inputFile;
+  if(options.renameFile.length() != 0){
+    RegisterRenamer renamer(inputFile);
+    if(!renamer.write(options.renameFile)){
+      cerr << "Could not write " << options.renameFile << endl;
+      exit(1);
+    }
+    cout << "RENAMED: wrote " << options.renameFile << ", renamed "
+         << renamer.getNumRenamed() << " of " << renamer.getNumWrites()
+         << " register writes" << endl;
+    cout << "WAR dependences " << renamer.getNumDependences(WAR, false)
+         << " -> " << renamer.getNumDependences(WAR, true) << endl;
+    cout << "WAW dependences " << renamer.getNumDependences(WAW, false)
+         << " -> " << renamer.getNumDependences(WAW, true) << endl;
+    rewritten = options.renameFile;
+  }
+
+  // reorder the program for the dataforwarding or stalling model and
+  // compare both models before and after
+  if(options.scheduleFile.length() != 0){
+    ListScheduler scheduler(rewritten, *models[options.scheduleForStall ? 1 : 2]);
+    if(!scheduler.write(options.scheduleFile)){
+      cerr << "Could not write " << options.scheduleFile << endl;
+      exit(1);
+    }
+    cout << "SCHEDULED: wrote " << options.scheduleFile << ", reordered "
+         << scheduler.getNumReordered() << " of " << scheduler.getNumBlocks()
+         << " basic blocks" << endl;
+
+    StallPipeline stall(options.scheduleFile, options);
+    DataForwardPipeline forward(options.scheduleFile, options);
+    Pipeline *after[] = {&stall, &forward};
+    for(int m = 0; m < 2; m++){
+      after[m]->execute();
+      cout << after[m]->getPipelineType() << " total time "
+           << models[m+1]->getTotalTime() << " -> "
+           << after[m]->getTotalTime() << endl;
+    }
+  }
+
+  // move independent instructions into the stalling model's bubbles
+  if(options.fillFile.length() != 0){
+    SlotFiller filler(rewritten, *models[1]);
+    if(!filler.write(options.fillFile)){
+      cerr << "Could not write " << options.fillFile << endl;
+      exit(1);
+    }
+    cout << "FILLED: wrote " << options.fillFile << ", moved "
+         << filler.getNumMoved() << " instructions into bubbles" << endl;
+    cout << "STALL cycles waiting for values " << filler.getNumBubbles(false)
+         << " -> " << filler.getNumBubbles(true) << ", after control instructions "
+         << filler.getNumControlBubbles() << " (no delay slot to fill)" << endl;
+
+    StallPipeline stall(options.fillFile, options);
+    stall.execute();
+    cout << stall.getPipelineType() << " total time " << models[1]->getTotalTime()
+         << " -> " << stall.getTotalTime() << endl;
+  }
 
-  delete ideal;
-  delete stall;
-  delete forward;
+  for(unsigned int m = 0; m < models.size(); m++)
+    delete models[m];
 
 }
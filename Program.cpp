@@ -0,0 +1,145 @@
+// aalok sathe
+#include "Program.h"
+#include <fstream>
+
+Program::Program(string inputFile)
+/* Reads the instructions of inputFile, a MIPS assembly file if its
+ * extension is "asm" or a MIPS machine instruction file if it is "mach".
+ */
+{
+    myFormatCorrect = false;
+
+    // read the program the same way Pipeline does, also keeping the labels
+    // of an assembly file
+    Parser *parser;
+    map<string, int> labels;
+    string ext = inputFile.substr(inputFile.find_last_of('.')+1);
+    if (ext == "asm")
+    {
+        ASMParser *asmParser = new ASMParser(inputFile);
+        labels = asmParser->getLabels();
+        parser = asmParser;
+    }
+    else if (ext == "mach")
+        parser = new MachLangParser(inputFile);
+    else
+        return;
+
+    myFormatCorrect = parser->isFormatCorrect();
+    if (not myFormatCorrect)
+    {
+        delete parser;
+        return;
+    }
+    for (Instruction i = parser->getNextInstruction();
+         i.getOpcode() != UNDEFINED;
+         i = parser->getNextInstruction())
+        myInstructions.push_back(i);
+    delete parser;
+
+    map<string, int>::iterator it;
+    for (it = labels.begin(); it != labels.end(); it++)
+        myLabels[(it->second - TextBaseAddress) / 4].push_back(it->first);
+}
+
+
+int Program::getTarget(int k)
+/* Returns the index of the instruction the control instruction at k may
+ * continue at other than k+1, or -1 if k is not a branch or jump or its
+ * target is outside the program. The end of the program is index size().
+ */
+{
+    long target = -1;
+    Opcode opc = myInstructions[k].getOpcode();
+    if (opc == J)
+        target = ((long)myInstructions[k].getImmediate() - TextBaseAddress) / 4;
+    else if (opc == BEQ)
+        target = (long)k + 1 + myInstructions[k].getImmediate();
+
+    if (target < 0 or target > size())
+        return -1;
+    return target;
+}
+
+
+vector<int> Program::getBlockStarts()
+/* Returns the index of the first instruction of each basic block in
+ * increasing order, followed by size(). A block starts at the first
+ * instruction, at every label, at every branch or jump target and after
+ * every control instruction.
+ */
+{
+    int n = size();
+    vector<bool> leader(n + 1, false);
+    leader[0] = true;
+    map<int, vector<string> >::iterator it;
+    for (it = myLabels.begin(); it != myLabels.end(); it++)
+        if (it->first >= 0 and it->first <= n)
+            leader[it->first] = true;
+    for (int k = 0; k < n; k++)
+    {
+        if (myOpcodes.getInstFunc(myInstructions[k].getOpcode()) != CONTROL_I)
+            continue;
+        leader[k+1] = true;
+        int target = getTarget(k);
+        if (target >= 0)
+            leader[target] = true;
+    }
+
+    vector<int> starts;
+    for (int k = 0; k < n; k++)
+        if (leader[k])
+            starts.push_back(k);
+    starts.push_back(n);
+    return starts;
+}
+
+
+bool Program::write(string outputFile, const vector<int> &order)
+/* Writes the program to outputFile with the instruction at index order[k]
+ * in position k, as assembly if its extension is "asm" and as machine
+ * instructions if it is "mach". Labels of assembly input stay at the same
+ * positions. Returns false if the file could not be written.
+ */
+{
+    string ext = outputFile.substr(outputFile.find_last_of('.')+1);
+    if (ext != "asm" and ext != "mach")
+        return false;
+
+    ofstream out(outputFile.c_str());
+    if (not out)
+        return false;
+
+    int n = order.size();
+    for (int k = 0; k <= n; k++)
+    {
+        // labels are only kept in assembly; machine instructions hold the
+        // resolved offsets and addresses instead
+        if (ext == "asm" and myLabels.find(k) != myLabels.end())
+            for (unsigned int l = 0; l < myLabels[k].size(); l++)
+                out << myLabels[k][l] << ":" << endl;
+        if (k == n)
+            break;
+
+        Instruction &inst = myInstructions[order[k]];
+        if (ext == "asm")
+            out << stripLabel(inst.getAssembly()) << endl;
+        else
+            out << inst.getEncoding() << endl;
+    }
+
+    return out.good();
+}
+
+
+string Program::stripLabel(string line)
+/* Returns line without a label definition at its start, if it has one */
+{
+    string::size_type comment = line.find('#');
+    string::size_type colon = line.find(':');
+    if (colon == string::npos or (comment != string::npos and comment < colon))
+        return line;
+
+    string::size_type p = line.find_first_not_of(" \t", colon + 1);
+    return p == string::npos ? string("") : line.substr(p);
+}
@@ -0,0 +1,75 @@
+// aalok sathe
+#ifndef _PROGRAM_H_
+#define _PROGRAM_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <map>
+#include "ASMParser.h"
+#include "MachLangParser.h"
+
+
+/* This class holds the instructions of a MIPS assembly or machine
+ * instruction file, together with the labels of an assembly file, for the
+ * passes that rewrite a program: it splits the program into basic blocks
+ * and writes the instructions back out in any order.
+ */
+class Program{
+
+ public:
+
+  /* Reads the instructions of inputFile, a MIPS assembly file if its
+   * extension is "asm" or a MIPS machine instruction file if it is "mach".
+   */
+  Program(string inputFile);
+
+  /* Returns true if the input file was syntactically correct and only
+   * contained supported instructions.  Otherwise, returns false.
+   */
+  bool isFormatCorrect() { return myFormatCorrect; };
+
+  /* Returns the number of instructions in the program */
+  int size() { return myInstructions.size(); };
+
+  /* Returns the instruction at index k, which passes may change */
+  Instruction &getInstruction(int k) { return myInstructions[k]; };
+
+  /* Returns the index of the instruction the control instruction at k may
+   * continue at other than k+1, or -1 if k is not a branch or jump or its
+   * target is outside the program. The end of the program is index size().
+   */
+  int getTarget(int k);
+
+  /* Returns the index of the first instruction of each basic block in
+   * increasing order, followed by size(). A block starts at the first
+   * instruction, at every label, at every branch or jump target and after
+   * every control instruction.
+   */
+  vector<int> getBlockStarts();
+
+  /* Writes the program to outputFile with the instruction at index order[k]
+   * in position k, as assembly if its extension is "asm" and as machine
+   * instructions if it is "mach". Labels of assembly input stay at the same
+   * positions. Returns false if the file could not be written.
+   */
+  bool write(string outputFile, const vector<int> &order);
+
+  /* Returns line without a label definition at its start, if it has one */
+  static string stripLabel(string line);
+
+
+ private:
+
+  bool myFormatCorrect;
+
+  // the program as read, and the labels defined at each instruction index
+  vector<Instruction> myInstructions;
+  map<int, vector<string> > myLabels;
+
+  OpcodeTable myOpcodes;
+
+};
+
+#endif
@@ -0,0 +1,177 @@
+// aalok sathe
+#include "ProgramCache.h"
+#include "Checkpoint.h"
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+ProgramCache::ProgramCache(string directory)
+/* Creates the cache kept in directory, making the directory if it does
+ * not exist yet.
+ */
+{
+    myDirectory = directory;
+    struct stat info;
+    myUsable = (mkdir(directory.c_str(), 0777) == 0 or errno == EEXIST)
+               and stat(directory.c_str(), &info) == 0 and S_ISDIR(info.st_mode);
+}
+
+
+string ProgramCache::getEntry(string inputFile, const SimOptions &options)
+/* Returns the name of the entry for inputFile read with options, or an
+ * empty string if inputFile cannot be read or the directory made.
+ */
+{
+    if (not myUsable)
+        return "";
+
+    vector<unsigned char> key;
+    FILE *in = fopen(inputFile.c_str(), "rb");
+    if (in == NULL)
+        return "";
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        key.insert(key.end(), buffer, buffer + got);
+    fclose(in);
+
+    // the options that decide which instructions are simulated, and the
+    // kind of file, which decides how it is parsed
+    char settings[64];
+    sprintf(settings, "|%d|%ld|", options.execute ? 1 : 0,
+            options.execute ? options.maxSteps : 0L);
+    string ext = inputFile.substr(inputFile.find_last_of('.')+1);
+    string tail = settings + ext;
+    key.insert(key.end(), tail.begin(), tail.end());
+
+    char name[32];
+    sprintf(name, "%016llx",
+            (unsigned long long)Checkpoint::getChecksum(key, key.size()));
+    return myDirectory + "/" + getVersion() + "-" + name + ".trace";
+}
+
+
+void ProgramCache::touch(string entry)
+/* Marks entry as just used, so that it is evicted last */
+{
+    utime(entry.c_str(), NULL);
+}
+
+
+int ProgramCache::evict(long limit)
+/* Removes the entries of other PIPESIM programs, then the least recently
+ * used ones until the entries take up at most limit bytes. Returns the
+ * number of entries removed.
+ */
+{
+    vector<Entry> entries;
+    getEntries(entries);
+
+    // stale entries first, then from the least recently used
+    vector<pair<pair<bool, long>, int> > order;
+    long size = 0;
+    for (unsigned int e = 0; e < entries.size(); e++)
+    {
+        order.push_back(make_pair(make_pair(entries[e].current, entries[e].used), e));
+        size += entries[e].size;
+    }
+    sort(order.begin(), order.end());
+
+    int removed = 0;
+    for (unsigned int k = 0; k < order.size(); k++)
+    {
+        Entry &entry = entries[order[k].second];
+        if (entry.current and size <= limit)
+            break;
+        if (remove((myDirectory + "/" + entry.name).c_str()) == 0)
+        {
+            size -= entry.size;
+            removed++;
+        }
+    }
+    return removed;
+}
+
+
+int ProgramCache::getEntryCount()
+/* Returns the number of entries */
+{
+    vector<Entry> entries;
+    getEntries(entries);
+    return entries.size();
+}
+
+
+long ProgramCache::getSize()
+/* Returns the bytes the entries take up */
+{
+    vector<Entry> entries;
+    getEntries(entries);
+    long size = 0;
+    for (unsigned int e = 0; e < entries.size(); e++)
+        size += entries[e].size;
+    return size;
+}
+
+
+void ProgramCache::getEntries(vector<Entry> &entries)
+/* Lists the entries in the directory */
+{
+    entries.clear();
+    DIR *directory = opendir(myDirectory.c_str());
+    if (directory == NULL)
+        return;
+
+    // entries are named VERSION-KEY.trace; other files are left alone,
+    // including those still being written
+    string version = getVersion();
+    struct dirent *file;
+    while ((file = readdir(directory)) != NULL)
+    {
+        string name = file->d_name;
+        string::size_type dash = name.find('-');
+        if (name.size() < 6 or name.substr(name.size() - 6) != ".trace"
+            or dash == string::npos)
+            continue;
+        struct stat info;
+        if (stat((myDirectory + "/" + name).c_str(), &info) != 0
+            or not S_ISREG(info.st_mode))
+            continue;
+        Entry entry;
+        entry.name = name;
+        entry.size = info.st_size;
+        entry.used = info.st_mtime;
+        entry.current = (name.substr(0, dash) == version);
+        entries.push_back(entry);
+    }
+    closedir(directory);
+}
+
+
+string ProgramCache::getVersion()
+/* Returns a hash of the running PIPESIM program, in hexadecimal */
+{
+    // the program does not change while it runs, so it is read only once
+    static string version;
+    if (not version.empty())
+        return version;
+
+    vector<unsigned char> program;
+    FILE *in = fopen("/proc/self/exe", "rb");
+    if (in != NULL)
+    {
+        unsigned char buffer[65536];
+        size_t got;
+        while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+            program.insert(program.end(), buffer, buffer + got);
+        fclose(in);
+    }
+    char name[32];
+    sprintf(name, "%016llx",
+            (unsigned long long)Checkpoint::getChecksum(program, program.size()));
+    version = name;
+    return version;
+}
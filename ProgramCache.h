@@ -0,0 +1,74 @@
+// aalok sathe
+#ifndef _PROGRAM_CACHE_H_
+#define _PROGRAM_CACHE_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include "SimOptions.h"
+
+
+/* This class keeps the programs read before, parsed, executed if asked to
+ * and with their dependences checked, as TraceFiles in a directory, so
+ * that a later run on the same input loads them rather than doing all of
+ * that again. An entry is named by a hash of what decides its contents:
+ * the bytes of the input file, whether and how far it is executed, and
+ * the PIPESIM program itself, so that a rebuilt PIPESIM never reads the
+ * entries of an older one. Entries are used in place of the input only,
+ * so changing the input or the program gives a new name and the old
+ * entry is never read again; evict removes such entries, then the least
+ * recently used ones, to keep the directory under a size limit.
+ */
+class ProgramCache{
+
+ public:
+
+  /* Creates the cache kept in directory, making the directory if it does
+   * not exist yet.
+   */
+  ProgramCache(string directory);
+
+  /* Returns the name of the entry for inputFile read with options, or an
+   * empty string if inputFile cannot be read or the directory made.
+   */
+  string getEntry(string inputFile, const SimOptions &options);
+
+  /* Marks entry as just used, so that it is evicted last */
+  void touch(string entry);
+
+  /* Removes the entries of other PIPESIM programs, then the least recently
+   * used ones until the entries take up at most limit bytes. Returns the
+   * number of entries removed.
+   */
+  int evict(long limit);
+
+  /* Returns the number of entries */
+  int getEntryCount();
+
+  /* Returns the bytes the entries take up */
+  long getSize();
+
+
+ private:
+
+  /* The name, size and last use of an entry */
+  struct Entry{
+    string name;
+    long size;
+    long used;
+    bool current;       // made by this PIPESIM program
+  };
+
+  /* Lists the entries in the directory */
+  void getEntries(vector<Entry> &entries);
+
+  /* Returns a hash of the running PIPESIM program, in hexadecimal */
+  static string getVersion();
+
+  string myDirectory;
+  bool myUsable;        // the directory exists
+
+};
+
+#endif
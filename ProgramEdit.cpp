@@ -0,0 +1,215 @@
+// aalok sathe
+#include "ProgramEdit.h"
+#include "MachLangParser.h"
+#include <cstdio>
+
+ProgramEdit::ProgramEdit(string inputFile)
+/* Reads inputFile, a MIPS assembly file if its extension is "asm" or a
+ * MIPS machine instruction file if it is "mach".
+ */
+{
+    myChangedLines = 0;
+    string ext = inputFile.substr(inputFile.find_last_of('.')+1);
+    myAssembly = (ext == "asm");
+    vector<string> lines;
+    myUsable = (myAssembly or ext == "mach") and readLines(inputFile, lines);
+    if (not myUsable)
+        return;
+
+    myHashes.resize(lines.size());
+    myBefore.assign(1, 0);
+    for (unsigned int k = 0; k < lines.size(); k++)
+    {
+        myHashes[k] = getHash(lines[k]);
+        bool instruction = true;
+        if (myAssembly)
+        {
+            string use;
+            string label = myParser.describeLine(lines[k], instruction, use);
+            if (not label.empty() and not myLabels.insert(make_pair(label, k)).second)
+                myUsable = false;
+            if (not use.empty())
+                myUses[k] = use;
+        }
+        myBefore.push_back(myBefore.back() + (instruction ? 1 : 0));
+    }
+}
+
+
+bool ProgramEdit::update(string inputFile, int &first, int &removed,
+                         vector<Instruction> &added,
+                         vector<pair<int, Instruction> > &relabeled)
+/* Reads inputFile, an edit of the file read last, and finds what
+ * changed: the removed instructions from first are replaced by added,
+ * and the instructions in relabeled, each with its index after the
+ * edit, are the same except for the address of a label they use.
+ * Returns false if it cannot be read, a changed line is not a supported
+ * instruction, or the edit cannot be followed, e.g. it uses a label
+ * that is not defined or defines one twice; the file must then be read
+ * as a whole, and nothing is changed.
+ */
+{
+    vector<string> lines;
+    if (not myUsable or not readLines(inputFile, lines))
+        return false;
+    int oldCount = myHashes.size();
+    int newCount = lines.size();
+    vector<uint64_t> hashes(newCount);
+    for (int k = 0; k < newCount; k++)
+        hashes[k] = getHash(lines[k]);
+
+    // the lines from same up to oldEnd were replaced by those up to newEnd
+    int same = 0;
+    while (same < oldCount and same < newCount and hashes[same] == myHashes[same])
+        same++;
+    int oldEnd = oldCount, newEnd = newCount;
+    while (oldEnd > same and newEnd > same and hashes[newEnd-1] == myHashes[oldEnd-1])
+    {
+        oldEnd--;
+        newEnd--;
+    }
+    int lineShift = newEnd - oldEnd;
+
+    // the changed lines' labels and instructions, and the labels and uses
+    // of the lines after them, moved
+    map<string, int> labels;
+    map<int, string> uses;
+    map<string, int>::iterator label;
+    map<int, string>::iterator use;
+    for (label = myLabels.begin(); label != myLabels.end(); label++)
+    {
+        if (label->second < same)
+            labels.insert(*label);
+        else if (label->second >= oldEnd)
+            labels.insert(make_pair(label->first, label->second + lineShift));
+    }
+    for (use = myUses.begin(); use != myUses.end(); use++)
+    {
+        if (use->first < same)
+            uses.insert(*use);
+        else if (use->first >= oldEnd)
+            uses.insert(make_pair(use->first + lineShift, use->second));
+    }
+    vector<int> before(myBefore.begin(), myBefore.begin() + same + 1);
+    before.reserve(newCount + 1);
+    for (int k = same; k < newEnd; k++)
+    {
+        bool instruction = true;
+        if (myAssembly)
+        {
+            string used;
+            string defined = myParser.describeLine(lines[k], instruction, used);
+            if (not defined.empty() and not labels.insert(make_pair(defined, k)).second)
+                return false;
+            if (not used.empty())
+                uses[k] = used;
+        }
+        before.push_back(before.back() + (instruction ? 1 : 0));
+    }
+    int shift = before.back() - myBefore[oldEnd];
+    for (int k = oldEnd + 1; k <= oldCount; k++)
+        before.push_back(myBefore[k] + shift);
+
+    first = myBefore[same];
+    removed = myBefore[oldEnd] - first;
+    added.clear();
+    relabeled.clear();
+
+    // only the changed lines are parsed, with the labels of the new file
+    if (myAssembly)
+    {
+        map<string, int> addresses;
+        for (label = labels.begin(); label != labels.end(); label++)
+            addresses[label->first] = before[label->second];
+        myParser.setLabels(addresses);
+        for (int k = same; k < newEnd; k++)
+        {
+            if (before[k+1] == before[k])
+                continue;
+            Instruction i;
+            if (not myParser.parseLineAt(lines[k], before[k], i))
+                return false;
+            added.push_back(i);
+        }
+
+        // a branch or jump elsewhere is parsed again if its label, or for a
+        // branch the branch itself, is at another address now
+        for (use = uses.begin(); use != uses.end(); use++)
+        {
+            int k = use->first;
+            if (k >= same and k < newEnd)
+                continue;
+            label = labels.find(use->second);
+            if (label == labels.end())
+                return false;
+            int oldLine = (k < same) ? k : k - lineShift;
+            map<string, int>::iterator old = myLabels.find(use->second);
+            if (old != myLabels.end() and myBefore[old->second] == before[label->second]
+                and myBefore[oldLine] == before[k])
+                continue;
+            Instruction i;
+            if (not myParser.parseLineAt(lines[k], before[k], i))
+                return false;
+            relabeled.push_back(make_pair(before[k], i));
+        }
+    }
+    else
+    {
+        string text;
+        for (int k = same; k < newEnd; k++)
+            text += lines[k] + "\n";
+        MachLangParser parser;
+        if (not text.empty() and not parser.parseBlock(text, added))
+            return false;
+    }
+
+    myChangedLines = max(oldEnd, newEnd) - same;
+    myHashes.swap(hashes);
+    myBefore.swap(before);
+    myLabels.swap(labels);
+    myUses.swap(uses);
+    return true;
+}
+
+
+bool ProgramEdit::readLines(string file, vector<string> &lines)
+/* Reads the lines of file into lines, as the parsers split them.
+ * Returns false if it cannot be read.
+ */
+{
+    FILE *in = fopen(file.c_str(), "rb");
+    if (in == NULL)
+        return false;
+    string text;
+    char buffer[1 << 16];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        text.append(buffer, got);
+    fclose(in);
+
+    // a newline ends a line, so there is no empty line after the last one
+    lines.clear();
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t newline = text.find('\n', pos);
+        if (newline == string::npos)
+            newline = text.size();
+        lines.push_back(text.substr(pos, newline - pos));
+        pos = newline + 1;
+    }
+    return true;
+}
+
+
+uint64_t ProgramEdit::getHash(const string &line)
+/* Returns the FNV-1a hash of line, as Checkpoint::getChecksum does */
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned int b = 0; b < line.size(); b++)
+    {
+        hash ^= (unsigned char)line[b];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,77 @@
+// aalok sathe
+#ifndef _PROGRAM_EDIT_H_
+#define _PROGRAM_EDIT_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "Instruction.h"
+#include "ASMParser.h"
+
+
+/* This class follows an input file that is edited between runs, so that
+ * a model can read only the lines that changed rather than the whole file
+ * again. It keeps a hash of each line, the number of instructions before
+ * it, and for an assembly file the line each label is defined on and the
+ * label each line branches or jumps to. update reads the file again and
+ * takes the lines that changed to be those between the longest beginning
+ * and the longest end that are the same as before; it parses only those,
+ * and the branches and jumps elsewhere whose label or own address moved.
+ */
+class ProgramEdit{
+
+ public:
+
+  /* Reads inputFile, a MIPS assembly file if its extension is "asm" or a
+   * MIPS machine instruction file if it is "mach".
+   */
+  ProgramEdit(string inputFile);
+
+  /* Returns true if the file could be read and its edits can be followed:
+   * it is of a kind above and defines no label twice.
+   */
+  bool isUsable() { return myUsable; };
+
+  /* Reads inputFile, an edit of the file read last, and finds what
+   * changed: the removed instructions from first are replaced by added,
+   * and the instructions in relabeled, each with its index after the
+   * edit, are the same except for the address of a label they use.
+   * Returns false if it cannot be read, a changed line is not a supported
+   * instruction, or the edit cannot be followed, e.g. it uses a label
+   * that is not defined or defines one twice; the file must then be read
+   * as a whole, and nothing is changed.
+   */
+  bool update(string inputFile, int &first, int &removed, vector<Instruction> &added,
+              vector<pair<int, Instruction> > &relabeled);
+
+  /* Returns the number of lines that changed in the last update */
+  int getChangedLines() { return myChangedLines; };
+
+
+ private:
+
+  /* Reads the lines of file into lines, as the parsers split them.
+   * Returns false if it cannot be read.
+   */
+  static bool readLines(string file, vector<string> &lines);
+
+  /* Returns the FNV-1a hash of line, as Checkpoint::getChecksum does */
+  static uint64_t getHash(const string &line);
+
+  bool myAssembly;
+  bool myUsable;
+  vector<uint64_t> myHashes;        // of each line
+  vector<int> myBefore;             // instructions before each line, and
+                                    // in the whole file
+  map<string, int> myLabels;        // the line each label is defined on
+  map<int, string> myUses;          // the label each line branches or
+                                    // jumps to, if it does
+  ASMParser myParser;
+  int myChangedLines;
+
+};
+
+#endif
@@ -0,0 +1,254 @@
+// aalok sathe
+#include "ProgramLoader.h"
+#include <algorithm>
+
+
+ProgramLoader::ProgramLoader(SimOptions options)
+/* Creates a loader for the instructions options ask for */
+{
+    myOptions = options;
+    myRangeFirst = -1;
+    myCached = false;
+    myParsed = false;
+}
+
+
+bool ProgramLoader::load(string inputFile)
+/* Reads the instructions of inputFile, a MIPS assembly, machine language
+ * or trace file. Returns false if its kind is not supported or it is not
+ * formatted correctly.
+ */
+{
+    // a trace holds the instructions to simulate, already executed and
+    // checked, so it is simulated as it is, without a data cache
+    string ext = inputFile.substr(inputFile.find_last_of('.')+1);
+    if (ext == "trace")
+    {
+        // with a range, only the chunks of the trace that hold it and its
+        // warm-up are read
+        int first = 0, end = -1;
+        if (myOptions.rangeEnd >= 0)
+        {
+            first = max(0, myOptions.rangeStart - max(0, myOptions.sampleWarmup));
+            end = myOptions.rangeEnd;
+        }
+        if (not loadTrace(inputFile, first, end))
+            return false;
+        if (myOptions.rangeEnd >= 0)
+            myRangeFirst = first;
+        return true;
+    }
+
+    // a program read before with the same options may be in the cache,
+    // unless loads need the addresses only executing it again gives
+    string entry;
+    if (not myOptions.cacheDir.empty() and not myOptions.dataCache)
+    {
+        ProgramCache cache(myOptions.cacheDir);
+        entry = cache.getEntry(inputFile, myOptions);
+        if (not entry.empty() and loadTrace(entry, 0, -1))
+        {
+            cache.touch(entry);
+            myCached = true;
+            selectRange();
+            return true;
+        }
+    }
+
+    // when streaming, the file is read and decoded on threads of their own
+    // while this one checks the dependences of the instructions decoded so
+    // far, unless they are only known once the program has been executed
+    vector<Instruction> program;
+    bool checked = false;
+    if (myOptions.stream)
+    {
+        checked = not (myOptions.execute or myOptions.dataCache);
+        if (not streamProgram(inputFile, program, checked))
+            return false;
+    }
+    else
+    {
+        // initialize a parser, and construct appropriate derived class based
+        // on input file kind
+        Parser* parser;
+        if (ext == "asm")
+            parser = new ASMParser(inputFile);
+        else if (ext == "mach")
+            parser = new MachLangParser(inputFile);
+        else
+            return false;
+
+        // check if parser is able to parse the input file correctly and
+        // exit if it is not able
+        if (not parser->isFormatCorrect())
+        {
+            delete parser;
+            return false;
+        }
+
+        // collect each instruction parsed by the parser
+        for (Instruction i = parser->getNextInstruction();
+             i.getOpcode() != UNDEFINED;
+             i = parser->getNextInstruction())
+            program.push_back(i);
+
+        // free allocated memory
+        delete parser;
+    }
+    setProgram(program, checked);
+
+    // keep what was read for the next run on the same input; a run that
+    // cannot write it just goes without
+    if (not entry.empty())
+    {
+        TraceFile trace(myProgram, myPcs, myChecker);
+        trace.write(entry);
+    }
+    selectRange();
+    return true;
+}
+
+
+bool ProgramLoader::load(const vector<Instruction> &program)
+/* Takes the instructions from program, a program already parsed, e.g.
+ * from a buffer in memory. Returns false if an instruction is not a
+ * supported one.
+ */
+{
+    vector<Instruction> copy(program);
+    for (unsigned int k = 0; k < copy.size(); k++)
+        if (copy[k].getOpcode() == UNDEFINED)
+            return false;
+    setProgram(copy, false);
+    selectRange();
+    return true;
+}
+
+
+bool ProgramLoader::loadTrace(string file, int from, int to)
+/* Reads the instructions to simulate, with their dependences, from the
+ * TraceFile file: those from from up to to, or all of them if to is
+ * negative. Returns false if it is not a trace or is damaged.
+ */
+{
+    TraceFile trace;
+    if (not trace.read(file, from, to))
+        return false;
+
+    myProgram = trace.getProgram();
+    myPcs = trace.getPcs();
+    myChecker.seed(trace.getRegisterState());
+    myChecker.addInstructions(myProgram, myPcs, trace.getDependences());
+    return true;
+}
+
+
+bool ProgramLoader::streamProgram(string inputFile, vector<Instruction> &program,
+                                  bool check)
+/* Reads the instructions of inputFile into program through an
+ * InstructionStream, and with check also into myProgram and the
+ * dependency checker, a batch at a time as they are decoded. Returns false
+ * if the file is not formatted correctly.
+ */
+{
+    InstructionStream stream(inputFile);
+    vector<Instruction> batch;
+    while (stream.getBatch(batch))
+    {
+        program.insert(program.end(), batch.begin(), batch.end());
+        if (check)
+        {
+            myProgram.insert(myProgram.end(), batch.begin(), batch.end());
+            myChecker.addInstructions(batch);
+        }
+    }
+    if (not stream.isFormatCorrect())
+        return false;
+
+    // only the labels of instructions change once the whole file is known,
+    // so the dependences found already stay as they are
+    vector<pair<int, Instruction> > changed;
+    stream.getChanges(changed);
+    for (unsigned int k = 0; k < changed.size(); k++)
+    {
+        program[changed[k].first] = changed[k].second;
+        if (check)
+            myProgram[changed[k].first] = changed[k].second;
+    }
+    return true;
+}
+
+
+void ProgramLoader::setProgram(vector<Instruction> &program, bool checked)
+/* Takes the instructions to simulate from program, the instructions of the
+ * file in order, executing it first if the options ask for it; checked
+ * says whether their dependences were checked already, as they were read.
+ */
+{
+    // add each instruction to be simulated into a container storing
+    // instructions, and into the dependency checker. when executing, these
+    // are the instructions in the order the program executes them. the
+    // program is also run when loads need their addresses for the cache
+    myParsed = true;
+    if (myOptions.execute or myOptions.dataCache)
+    {
+        Executor executor(program);
+        if (myOptions.execute)
+            executor.run(myOptions.maxSteps);
+        else
+            executor.runInOrder();
+
+        myProgram = program;
+        myPcs = executor.getTrace();
+        myChecker.addInstructions(myProgram, myPcs);
+
+        // one address per load, in the order they were executed
+        if (myOptions.dataCache)
+        {
+            const vector<unsigned int> &loads = executor.getLoadAddresses();
+            myAddresses.assign(myPcs.size(), 0);
+            unsigned int next = 0;
+            for (unsigned int k = 0; k < myPcs.size() and next < loads.size(); k++)
+                if (myProgram[myPcs[k]].getOpcode() == LW)
+                    myAddresses[k] = loads[next++];
+        }
+    }
+    else
+    {
+        if (not checked)
+        {
+            myProgram.swap(program);
+            myChecker.addInstructions(myProgram);
+        }
+        myPcs.resize(myProgram.size());
+        for (unsigned int k = 0; k < myPcs.size(); k++)
+            myPcs[k] = k;
+    }
+}
+
+
+void ProgramLoader::selectRange()
+/* If the options give a range, keeps only the instructions of the range
+ * and the warm-up before it, as if they were the whole run.
+ */
+{
+    if (myOptions.rangeEnd < 0)
+        return;
+
+    int n = myPcs.size();
+    int first = min(n, max(0, myOptions.rangeStart - max(0, myOptions.sampleWarmup)));
+    int end = max(first, min(n, myOptions.rangeEnd));
+    myPcs = vector<int>(myPcs.begin() + first, myPcs.begin() + end);
+    if (not myAddresses.empty())
+        myAddresses = vector<unsigned int>(myAddresses.begin() + first,
+                                           myAddresses.begin() + end);
+
+    // the instructions are checked from the last access to each register
+    // before the warm-up, so that their dependences on earlier ones are
+    // found and counted
+    vector<RegisterInfo> state = myChecker.getRegisterState(first);
+    myChecker = DependencyChecker();
+    myChecker.seed(state);
+    myChecker.addInstructions(myProgram, myPcs);
+    myRangeFirst = first;
+}
@@ -0,0 +1,114 @@
+// aalok sathe
+#ifndef _PROGRAM_LOADER_H_
+#define _PROGRAM_LOADER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include "ASMParser.h"
+#include "MachLangParser.h"
+#include "DependencyChecker.h"
+#include "Executor.h"
+#include "SimOptions.h"
+#include "InstructionStream.h"
+#include "TraceFile.h"
+#include "ProgramCache.h"
+
+
+/* This class reads the instructions a Pipeline simulates, so that the
+ * model itself only times them. From a trace it reads only the chunks the
+ * options' range needs; otherwise it looks for the program in the
+ * program cache, or parses the input file (through an InstructionStream
+ * if the options ask for it), executes it if they ask for that or a data
+ * cache needs the load addresses, and keeps it in the cache for the next
+ * run. It leaves the program, the index into it of each instruction
+ * simulated, a DependencyChecker that has checked them and, with a data
+ * cache, the address of each load, cut down to the range and its warm-up
+ * if the options give one.
+ */
+class ProgramLoader{
+
+ public:
+
+  /* Creates a loader for the instructions options ask for */
+  ProgramLoader(SimOptions options);
+
+  /* Reads the instructions of inputFile, a MIPS assembly, machine
+   * language or trace file. Returns false if its kind is not supported or
+   * it is not formatted correctly.
+   */
+  bool load(string inputFile);
+
+  /* Takes the instructions from program, a program already parsed, e.g.
+   * from a buffer in memory. Returns false if an instruction is not a
+   * supported one.
+   */
+  bool load(const vector<Instruction> &program);
+
+  /* Return the program, each instruction once, the index into it of each
+   * instruction to simulate, in order, and the checker that has checked
+   * them; the model takes them over by swapping them out.
+   */
+  vector<Instruction> &getProgram() { return myProgram; };
+  vector<int> &getPcs() { return myPcs; };
+  DependencyChecker &getDependencyChecker() { return myChecker; };
+
+  /* Returns the address of each instruction to simulate that is a load
+   * and 0 for the others, if the program was executed for a data cache,
+   * or an empty list.
+   */
+  vector<unsigned int> &getAddresses() { return myAddresses; };
+
+  /* Returns the number in the run of the first instruction to simulate,
+   * or -1 if the options give no range.
+   */
+  int getRangeFirst() { return myRangeFirst; };
+
+  /* Returns whether the instructions were loaded from the program cache */
+  bool isCached() { return myCached; };
+
+  /* Returns whether the instructions were parsed, rather than loaded from
+   * a trace or the program cache.
+   */
+  bool isParsed() { return myParsed; };
+
+
+ private:
+
+  /* Reads the instructions to simulate, with their dependences, from the
+   * TraceFile file: those from from up to to, or all of them if to is
+   * negative. Returns false if it is not a trace or is damaged.
+   */
+  bool loadTrace(string file, int from, int to);
+
+  /* Reads the instructions of inputFile into program through an
+   * InstructionStream, and with check also into myProgram and the
+   * dependency checker, a batch at a time as they are decoded. Returns
+   * false if the file is not formatted correctly.
+   */
+  bool streamProgram(string inputFile, vector<Instruction> &program, bool check);
+
+  /* Takes the instructions to simulate from program, the instructions of the
+   * file in order, executing it first if the options ask for it; checked
+   * says whether their dependences were checked already, as they were read.
+   */
+  void setProgram(vector<Instruction> &program, bool checked);
+
+  /* If the options give a range, keeps only the instructions of the range
+   * and the warm-up before it, as if they were the whole run.
+   */
+  void selectRange();
+
+  SimOptions myOptions;
+  vector<Instruction> myProgram;
+  vector<int> myPcs;
+  DependencyChecker myChecker;
+  vector<unsigned int> myAddresses;
+  int myRangeFirst;
+  bool myCached;
+  bool myParsed;
+
+};
+
+#endif
@@ -0,0 +1,357 @@
+// aalok sathe
+#include "RegisterRenamer.h"
+#include <sstream>
+
+RegisterRenamer::RegisterRenamer(string inputFile)
+    : myProgram(inputFile)
+/* Reads the program in inputFile, a MIPS assembly or machine instruction
+ * file, and renames the registers written by its instructions where that
+ * removes a WAR or WAW dependence.
+ */
+{
+    myNumWrites = myNumRenamed = 0;
+    myLiveIn = myAccessed = 0;
+    for (int t = 0; t < D_UNDEFINED; t++)
+        myBefore[t] = myAfter[t] = 0;
+    if (not myProgram.isFormatCorrect())
+        return;
+
+    // note where each register is used; the registers the program writes
+    // are its results, and the ones it reads first its inputs
+    int n = myProgram.size();
+    uint64_t written = (uint64_t)1 << DependencyChecker::HI_REGISTER;
+    myReferences.assign(DependencyChecker::HI_REGISTER + 1, vector<int>());
+    myNextReference.assign(DependencyChecker::HI_REGISTER + 1, 0);
+    for (int k = 0; k < n; k++)
+    {
+        int src[2], dst;
+        myDependencyChecker.getRegisters(myProgram.getInstruction(k), src, dst);
+        for (int j = 0; j < 2; j++)
+            if (src[j] >= 0 and (j == 0 or src[1] != src[0]))
+            {
+                myReferences[src[j]].push_back(k);
+                if (not ((written >> src[j]) & 1))
+                    myLiveIn |= (uint64_t)1 << src[j];
+            }
+        if (dst >= 0)
+        {
+            if (myReferences[dst].empty() or myReferences[dst].back() != k)
+                myReferences[dst].push_back(k);
+            written |= (uint64_t)1 << dst;
+            if (dst != (int)DependencyChecker::HI_REGISTER)
+                myNumWrites++;
+        }
+    }
+
+    countDependences(myBefore);
+
+    // each rename trades the write's own false dependence for at most one
+    // new one, but the program is kept as it was if the total still grows
+    Program original = myProgram;
+    vector<int> starts = myProgram.getBlockStarts();
+    vector<uint64_t> liveOut;
+    findLiveness(starts, written, liveOut);
+    for (unsigned int b = 0; b + 1 < starts.size(); b++)
+        renameBlock(starts[b], starts[b+1], liveOut[b]);
+
+    countDependences(myAfter);
+    if (myAfter[WAR] + myAfter[WAW] > myBefore[WAR] + myBefore[WAW])
+    {
+        myProgram = original;
+        myNumRenamed = 0;
+        for (int t = 0; t < D_UNDEFINED; t++)
+            myAfter[t] = myBefore[t];
+    }
+}
+
+
+void RegisterRenamer::findLiveness(const vector<int> &starts, uint64_t exitLive,
+                                   vector<uint64_t> &liveOut)
+/* Finds the registers whose values are needed when each basic block is
+ * left, into liveOut, for the blocks starting at starts. exitLive holds
+ * the registers needed when the program ends.
+ */
+{
+    int n = myProgram.size();
+    int numBlocks = starts.size() - 1;
+
+    // the block each instruction is in; the end of the program is block
+    // numBlocks, where exitLive is needed
+    vector<int> blockOf(n + 1, numBlocks);
+    for (int b = 0; b < numBlocks; b++)
+        for (int k = starts[b]; k < starts[b+1]; k++)
+            blockOf[k] = b;
+
+    // the registers each block reads before writing them, the ones it
+    // writes, and the blocks it may continue at
+    vector<uint64_t> used(numBlocks, 0), defined(numBlocks, 0);
+    vector<int> succ(2*numBlocks, -1);
+    for (int b = 0; b < numBlocks; b++)
+    {
+        for (int k = starts[b]; k < starts[b+1]; k++)
+        {
+            int src[2], dst;
+            myDependencyChecker.getRegisters(myProgram.getInstruction(k), src, dst);
+            for (int j = 0; j < 2; j++)
+                if (src[j] >= 0 and not ((defined[b] >> src[j]) & 1))
+                    used[b] |= (uint64_t)1 << src[j];
+            if (dst >= 0)
+                defined[b] |= (uint64_t)1 << dst;
+        }
+
+        int last = starts[b+1] - 1;
+        Opcode opc = myProgram.getInstruction(last).getOpcode();
+        if (opc != J)
+            succ[2*b] = blockOf[last + 1];
+        if (myOpcodes.getInstFunc(opc) == CONTROL_I)
+        {
+            int target = myProgram.getTarget(last);
+            succ[2*b + 1] = (target < 0) ? numBlocks : blockOf[target];
+        }
+    }
+
+    // values flow backwards, so go over the blocks from the last one until
+    // nothing changes; most programs need two or three passes
+    vector<uint64_t> liveIn(numBlocks + 1, 0);
+    liveIn[numBlocks] = exitLive;
+    liveOut.assign(numBlocks, 0);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int b = numBlocks - 1; b >= 0; b--)
+        {
+            uint64_t out = 0;
+            for (int s = 2*b; s < 2*b + 2; s++)
+                if (succ[s] >= 0)
+                    out |= liveIn[succ[s]];
+            uint64_t in = used[b] | (out & ~defined[b]);
+            if (out != liveOut[b] or in != liveIn[b])
+                changed = true;
+            liveOut[b] = out;
+            liveIn[b] = in;
+        }
+    }
+}
+
+
+void RegisterRenamer::renameBlock(int begin, int end, uint64_t liveOut)
+/* Renames the destinations of the instructions from begin up to, but not
+ * including, end, which form one basic block after which the registers
+ * in liveOut are needed.
+ */
+{
+    int m = end - begin;
+    const int numRegs = DependencyChecker::HI_REGISTER + 1;
+    const int hi = DependencyChecker::HI_REGISTER;
+
+    // walk backwards to find, for each instruction, the registers needed
+    // after it, the last instruction in the block that reads the value it
+    // writes (-1 if none), and whether that value is needed after the block
+    vector<uint64_t> liveAfter(m);
+    vector<int> lastUse(m, -1);
+    vector<bool> escapes(m, false);
+    vector<int> lastRead(numRegs, -1);
+    vector<bool> redefined(numRegs, false);
+    uint64_t live = liveOut;
+    for (int i = m - 1; i >= 0; i--)
+    {
+        liveAfter[i] = live;
+        int src[2], dst;
+        myDependencyChecker.getRegisters(myProgram.getInstruction(begin + i), src, dst);
+        if (dst >= 0)
+        {
+            lastUse[i] = lastRead[dst];
+            escapes[i] = not redefined[dst] and ((liveOut >> dst) & 1);
+            lastRead[dst] = -1;
+            redefined[dst] = true;
+            live &= ~((uint64_t)1 << dst);
+        }
+        for (int j = 0; j < 2; j++)
+            if (src[j] >= 0)
+            {
+                if (lastRead[src[j]] < 0)
+                    lastRead[src[j]] = i;
+                live |= (uint64_t)1 << src[j];
+            }
+    }
+
+    // walk forwards, reading each register under the name its current
+    // value was given. touched holds the registers accessed so far in the
+    // block under their new names, and busyUntil the last instruction that
+    // reads a value moved into a register
+    vector<int> name(numRegs, -1);
+    vector<int> busyUntil(numRegs, -1);
+    uint64_t touched = 0;
+    for (int i = 0; i < m; i++)
+    {
+        int k = begin + i;
+        Instruction &inst = myProgram.getInstruction(k);
+        int src[2], dst;
+        myDependencyChecker.getRegisters(inst, src, dst);
+
+        int newSrc[2];
+        for (int j = 0; j < 2; j++)
+        {
+            newSrc[j] = (src[j] >= 0 and name[src[j]] >= 0) ? name[src[j]] : src[j];
+            if (newSrc[j] >= 0)
+                touched |= (uint64_t)1 << newSrc[j];
+        }
+
+        int newDst = dst;
+        if (dst >= 0 and dst != hi)
+        {
+            name[dst] = -1;
+
+            // only a write that is ordered after an earlier access for no
+            // other reason than the register is renamed, and only if its
+            // value dies in the block. that removes the write's WAR or WAW
+            // dependence
+            if (((touched >> dst) & 1) and not escapes[i])
+            {
+                int last = begin + max(i, lastUse[i]);
+                int best = -1, bestCost = 4;
+                for (int f = 1; f < hi; f++)
+                {
+                    if (f == dst or ((liveAfter[i] >> f) & 1) or ((myLiveIn >> f) & 1)
+                        or busyUntil[f] >= k or getNextReference(f, k) <= last)
+                        continue;
+
+                    // the write gets a new false dependence on an earlier
+                    // access to the register anywhere in the program, or
+                    // else gives one to the next write of it; prefer
+                    // registers that avoid both, then ones the rest of
+                    // the block leaves alone
+                    int next = getNextReference(f, k);
+                    bool added = (((myAccessed | touched) >> f) & 1) or next < myProgram.size();
+                    int cost = (added ? 2 : 0) + (next < end ? 1 : 0);
+                    if (cost < bestCost)
+                    {
+                        best = f;
+                        bestCost = cost;
+                    }
+                }
+                if (best >= 0)
+                {
+                    name[dst] = newDst = best;
+                    busyUntil[best] = last;
+                    myNumRenamed++;
+                }
+            }
+        }
+        if (newDst >= 0)
+            touched |= (uint64_t)1 << newDst;
+
+        if (newSrc[0] == src[0] and newSrc[1] == src[1] and newDst == dst)
+            continue;
+
+        // put the new names into the fields they came from
+        int rs = inst.getRS(), rt = inst.getRT(), rd = inst.getRD();
+        if (src[0] >= 0 and src[0] != hi)
+            rs = newSrc[0];
+        if (src[1] >= 0)
+            rt = newSrc[1];
+        if (dst >= 0 and dst != hi)
+        {
+            if (inst.getInstType() == RTYPE)
+                rd = newDst;
+            else
+                rt = newDst;
+        }
+        rewrite(k, rs, rt, rd);
+    }
+    myAccessed |= touched;
+}
+
+
+int RegisterRenamer::getNextReference(int r, int k)
+/* Returns the index of the first instruction after k that reads or writes
+ * register r in the program as read, or the number of instructions if
+ * there is none. k must not decrease between calls for the same r.
+ */
+{
+    vector<int> &refs = myReferences[r];
+    unsigned int &p = myNextReference[r];
+    while (p < refs.size() and refs[p] <= k)
+        p++;
+    return p < refs.size() ? refs[p] : myProgram.size();
+}
+
+
+void RegisterRenamer::rewrite(int k, int rs, int rt, int rd)
+/* Changes the registers of the instruction at k to rs, rt and rd and
+ * gives it new assembly text and encoding.
+ */
+{
+    Instruction &inst = myProgram.getInstruction(k);
+    Opcode opc = inst.getOpcode();
+    inst.setValues(opc, rs, rt, rd, inst.getImmediate());
+
+    // the operands in the order they are written. a label operand is kept
+    // as it was written, from after the last comma
+    int numOperands = myOpcodes.numOperands(opc);
+    vector<string> operands(numOperands);
+    int fields[3] = {rs, rt, rd};
+    int posns[3] = {myOpcodes.RSposition(opc), myOpcodes.RTposition(opc),
+                    myOpcodes.RDposition(opc)};
+    for (int f = 0; f < 3; f++)
+        if (posns[f] >= 0)
+        {
+            ostringstream reg;
+            reg << "$" << fields[f];
+            operands[posns[f]] = reg.str();
+        }
+    int immPosn = myOpcodes.IMMposition(opc);
+    if (immPosn >= 0)
+    {
+        ostringstream imm;
+        if (myOpcodes.isIMMLabel(opc))
+        {
+            string text = Program::stripLabel(inst.getAssembly());
+            text = text.substr(0, text.find('#'));
+            text = text.substr(text.find_last_of(",") + 1);
+            string::size_type first = text.find_first_not_of(" \t");
+            string::size_type last = text.find_last_not_of(" \t\r");
+            imm << text.substr(first, last - first + 1);
+        }
+        else
+            imm << inst.getImmediate();
+        operands[immPosn] = imm.str();
+    }
+
+    ostringstream assembly;
+    assembly << myOpcodes.getName(opc) << " ";
+    if (myOpcodes.getInstFunc(opc) == MEMORY_I)
+        assembly << operands[myOpcodes.RTposition(opc)] << ", "
+                 << operands[immPosn] << "(" << operands[myOpcodes.RSposition(opc)] << ")";
+    else
+        for (int p = 0; p < numOperands; p++)
+            assembly << (p ? ", " : "") << operands[p];
+
+    inst.setAssembly(assembly.str());
+    inst.setEncoding(myEncoder.encode(inst));
+}
+
+
+bool RegisterRenamer::write(string outputFile)
+/* Writes the rewritten program to outputFile, as assembly if its
+ * extension is "asm" and as machine instructions if it is "mach".
+ * Returns false if the file could not be written.
+ */
+{
+    vector<int> order(myProgram.size());
+    for (unsigned int k = 0; k < order.size(); k++)
+        order[k] = k;
+    return myProgram.write(outputFile, order);
+}
+
+
+void RegisterRenamer::countDependences(int counts[])
+/* Counts the dependences of each type in the program into counts */
+{
+    DependencyChecker checker;
+    for (int k = 0; k < myProgram.size(); k++)
+        checker.addInstruction(myProgram.getInstruction(k));
+    for (int t = 0; t < D_UNDEFINED; t++)
+        counts[t] = checker.getDependences((DependenceType)t).size();
+}
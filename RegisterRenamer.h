@@ -0,0 +1,120 @@
+// aalok sathe
+#ifndef _REGISTER_RENAMER_H_
+#define _REGISTER_RENAMER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "Program.h"
+#include "DependencyChecker.h"
+
+
+/* This class rewrites a program so that fewer of its instructions have WAR
+ * or WAW dependences, which only exist because registers are reused. When
+ * an instruction writes a register that was already read or written earlier
+ * in its basic block, and the value it writes is not needed after the
+ * block, the value is moved into a free register: one whose current value
+ * is never read again, that nothing uses until the last read of the
+ * renamed value and that the program does not read before writing it.
+ * The instruction and those reads are changed to use it, unless that
+ * gives the program more WAR and WAW dependences than it takes away.
+ *
+ * Which registers hold values that are still needed is found with liveness
+ * analysis over the basic blocks. Registers the program writes are taken to
+ * be its results, so they are needed when it ends; registers it never
+ * writes are free once they are not read any more. HI is never renamed.
+ */
+class RegisterRenamer{
+
+ public:
+
+  /* Reads the program in inputFile, a MIPS assembly or machine instruction
+   * file, and renames the registers written by its instructions where that
+   * removes a WAR or WAW dependence.
+   */
+  RegisterRenamer(string inputFile);
+
+  /* Returns true if the input file was syntactically correct and only
+   * contained supported instructions.  Otherwise, returns false.
+   */
+  bool isFormatCorrect() { return myProgram.isFormatCorrect(); };
+
+  /* Writes the rewritten program to outputFile, as assembly if its
+   * extension is "asm" and as machine instructions if it is "mach".
+   * Returns false if the file could not be written.
+   */
+  bool write(string outputFile);
+
+  /* Returns the number of instructions that write a register other than HI */
+  int getNumWrites() { return myNumWrites; };
+
+  /* Returns the number of instructions whose destination was renamed */
+  int getNumRenamed() { return myNumRenamed; };
+
+  /* Returns the number of dependences of type depType DependencyChecker
+   * finds in the program before (renamed false) or after (renamed true)
+   * renaming.
+   */
+  int getNumDependences(DependenceType depType, bool renamed)
+    { return renamed ? myAfter[depType] : myBefore[depType]; };
+
+
+ private:
+
+  /* Finds the registers whose values are needed when each basic block is
+   * left, into liveOut, for the blocks starting at starts. exitLive holds
+   * the registers needed when the program ends.
+   */
+  void findLiveness(const vector<int> &starts, uint64_t exitLive,
+                    vector<uint64_t> &liveOut);
+
+  /* Renames the destinations of the instructions from begin up to, but not
+   * including, end, which form one basic block after which the registers
+   * in liveOut are needed.
+   */
+  void renameBlock(int begin, int end, uint64_t liveOut);
+
+  /* Returns the index of the first instruction after k that reads or writes
+   * register r in the program as read, or the number of instructions if
+   * there is none. k must not decrease between calls for the same r.
+   */
+  int getNextReference(int r, int k);
+
+  /* Changes the registers of the instruction at k to rs, rt and rd and
+   * gives it new assembly text and encoding.
+   */
+  void rewrite(int k, int rs, int rt, int rd);
+
+  /* Counts the dependences of each type in the program into counts */
+  void countDependences(int counts[]);
+
+  // the program, which is rewritten in place
+  Program myProgram;
+
+  // indices of the instructions that read or write each register in the
+  // program as read, and how far getNextReference has moved along them
+  vector<vector<int> > myReferences;
+  vector<unsigned int> myNextReference;
+
+  // the registers the program reads before it writes them, whose values
+  // come from before it starts, and the ones accessed so far under their
+  // new names by the blocks already renamed
+  uint64_t myLiveIn;
+  uint64_t myAccessed;
+
+  int myNumWrites;
+  int myNumRenamed;
+  int myBefore[D_UNDEFINED];
+  int myAfter[D_UNDEFINED];
+
+  // used for the registers each instruction reads and writes, for the
+  // names and operands of instructions, and to encode changed instructions
+  DependencyChecker myDependencyChecker;
+  OpcodeTable myOpcodes;
+  ASMParser myEncoder;
+
+};
+
+#endif
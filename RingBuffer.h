@@ -0,0 +1,109 @@
+// aalok sathe
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+
+using namespace std;
+
+#include <vector>
+#include <algorithm>
+#include <sched.h>
+
+
+/* This class passes items from one thread to another through a ring of a
+ * fixed number of slots, without locks: only the producing thread moves
+ * the tail and only the consuming thread moves the head, each publishing
+ * its move with a release store that the other reads with an acquire
+ * load. A producer that finds the ring full waits for the consumer to
+ * take an item, so a fast stage cannot run ahead of a slow one by more
+ * than the ring holds. Items are swapped in and out rather than copied,
+ * so large ones like strings and vectors cost nothing to pass.
+ */
+template <class T>
+class RingBuffer{
+
+ public:
+
+  /* Creates an empty ring of at least capacity slots */
+  RingBuffer(unsigned int capacity)
+  {
+    unsigned int size = 1;
+    while (size < capacity)
+      size *= 2;
+    mySlots.resize(size);
+    myMask = size - 1;
+    myHead = 0;
+    myTail = 0;
+    myClosed = false;
+  };
+
+  /* Swaps item into the next slot, waiting while the ring is full, and
+   * leaves item empty. Returns false, without passing item, if the ring
+   * was closed, i.e. the consumer has stopped taking items.
+   */
+  bool push(T &item)
+  {
+    unsigned long tail = myTail;
+    while (tail - __atomic_load_n(&myHead, __ATOMIC_ACQUIRE) > myMask)
+    {
+      if (isClosed())
+        return false;
+      sched_yield();
+    }
+    if (isClosed())
+      return false;
+    // a slot is left empty when its item is taken, so item comes back empty
+    swap(mySlots[tail & myMask], item);
+    __atomic_store_n(&myTail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  };
+
+  /* Swaps the next item into item, waiting while the ring is empty.
+   * Returns false once the ring is closed and every item pushed before
+   * has been taken.
+   */
+  bool pop(T &item)
+  {
+    unsigned long head = myHead;
+    for (;;)
+    {
+      // the items pushed before the ring was closed are all visible once
+      // it is seen closed
+      bool closed = isClosed();
+      if (__atomic_load_n(&myTail, __ATOMIC_ACQUIRE) != head)
+        break;
+      if (closed)
+        return false;
+      sched_yield();
+    }
+    swap(mySlots[head & myMask], item);
+    T().swap(mySlots[head & myMask]);
+    __atomic_store_n(&myHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+  };
+
+  /* Closes the ring: the producer calls this after its last item, and the
+   * consumer to stop the producer early.
+   */
+  void close() { __atomic_store_n(&myClosed, true, __ATOMIC_RELEASE); };
+
+  /* Returns true once either end closed the ring */
+  bool isClosed() { return __atomic_load_n(&myClosed, __ATOMIC_ACQUIRE); };
+
+
+ private:
+
+  vector<T> mySlots;
+  unsigned long myMask;     // slots - 1; the slots are a power of two
+
+  // items pushed and taken so far; the slot of item k is k & myMask
+  unsigned long myHead;
+  unsigned long myTail;
+  bool myClosed;
+
+  // not copied, since the threads on each end hold on to it
+  RingBuffer(const RingBuffer &);
+  RingBuffer &operator=(const RingBuffer &);
+
+};
+
+#endif
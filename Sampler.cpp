@@ -0,0 +1,359 @@
+// aalok sathe
+#include "Sampler.h"
+#include <cmath>
+#include <algorithm>
+
+Sampler::Sampler(string inputFile, SimOptions options)
+/* Reads the program in inputFile and, if options ask for it, executes it
+ * to find the instructions to time. Splits them into intervals of
+ * options.sampleUnit instructions and chooses the intervals to sample.
+ */
+{
+    myOptions = options;
+    myUnit = max(1, myOptions.sampleUnit);
+    myIntervals = 0;
+    mySeed = 12345;
+
+    Program program(inputFile);
+    myFormatCorrect = program.isFormatCorrect();
+    if (not myFormatCorrect)
+        return;
+    for (int k = 0; k < program.size(); k++)
+        myProgram.push_back(program.getInstruction(k));
+
+    // fast-forwarding is only executing the program; the pipeline state is
+    // rebuilt by the warm-up before each sample
+    if (myOptions.execute)
+    {
+        Executor executor(myProgram);
+        executor.run(myOptions.maxSteps);
+        myTrace = executor.getTrace();
+    }
+    else
+    {
+        for (unsigned int k = 0; k < myProgram.size(); k++)
+            myTrace.push_back(k);
+    }
+
+    int n = myTrace.size();
+    myIntervals = (n + myUnit - 1) / myUnit;
+    if (myIntervals == 0)
+        return;
+    if (myOptions.simpoints > 0)
+        chooseClusters();
+    else
+        choosePeriodic();
+}
+
+
+SimOptions Sampler::getModelOptions()
+/* Returns the options to construct the models to sample with: they do
+ * not execute the program themselves, have no caches or front end, take
+ * no checkpoints, simulate the whole run and do not follow edits.
+ */
+{
+    SimOptions options = myOptions;
+    options.execute = false;
+    options.dataCache = false;
+    options.frontEnd = false;
+    options.checkpointFile = "";
+    options.resumeFile = "";
+    options.rangeEnd = -1;
+    options.watch = false;
+    options.updateFile = "";
+    return options;
+}
+
+
+void Sampler::choosePeriodic()
+/* Chooses every myOptions.samplePeriod-th interval, in a random order */
+{
+    int period = max(1, myOptions.samplePeriod);
+
+    Stratum all;
+    all.population = myIntervals;
+    all.instructions = myTrace.size();
+    for (int k = period / 2; k < myIntervals; k += period)
+        all.order.push_back(k);
+    if (all.order.empty())
+        all.order.push_back(0);
+
+    for (int k = all.order.size() - 1; k > 0; k--)
+        swap(all.order[k], all.order[getRandom(k + 1)]);
+    myStrata.push_back(all);
+}
+
+
+void Sampler::chooseClusters()
+/* Clusters the intervals by the code they execute and makes each cluster
+ * a stratum, its intervals ordered by distance from its center.
+ */
+{
+    // describe each interval by how often it executes each instruction of
+    // the program, projected onto a few random directions as SimPoint does
+    const int most = 15;
+    int p = myProgram.size();
+    int dims = min(p, most);
+    vector<double> projection(p * dims);
+    for (int k = 0; k < p; k++)
+        for (int d = 0; d < dims; d++)
+            projection[k*dims + d] = (p <= most) ? (k == d)
+                                                 : getRandom(2001) / 1000.0 - 1;
+
+    int n = myTrace.size();
+    vector<double> points(myIntervals * dims, 0.0);
+    for (int k = 0; k < n; k++)
+        for (int d = 0; d < dims; d++)
+            points[(k / myUnit)*dims + d] += projection[myTrace[k]*dims + d];
+    for (int k = 0; k < myIntervals; k++)
+    {
+        int length = min(n, (k + 1) * myUnit) - k * myUnit;
+        for (int d = 0; d < dims; d++)
+            points[k*dims + d] /= length;
+    }
+
+    // k-means, started from centers that are as far apart as possible
+    int clusters = min(myOptions.simpoints, myIntervals);
+    vector<double> centers(clusters * dims);
+    vector<double> nearest(myIntervals, HUGE_VAL);
+    vector<int> member(myIntervals, 0);
+    int next = 0;
+    for (int c = 0; c < clusters; c++)
+    {
+        copy(points.begin() + next*dims, points.begin() + (next+1)*dims,
+             centers.begin() + c*dims);
+        for (int k = 0; k < myIntervals; k++)
+        {
+            double dist = getDistance(points, k, centers, c, dims);
+            if (dist < nearest[k])
+            {
+                nearest[k] = dist;
+                member[k] = c;
+            }
+        }
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+    }
+
+    const int iterations = 20;
+    for (int it = 0; it < iterations; it++)
+    {
+        vector<int> sizes(clusters, 0);
+        fill(centers.begin(), centers.end(), 0.0);
+        for (int k = 0; k < myIntervals; k++)
+        {
+            sizes[member[k]]++;
+            for (int d = 0; d < dims; d++)
+                centers[member[k]*dims + d] += points[k*dims + d];
+        }
+        for (int c = 0; c < clusters; c++)
+            for (int d = 0; d < dims; d++)
+                if (sizes[c] > 0)
+                    centers[c*dims + d] /= sizes[c];
+
+        bool changed = false;
+        for (int k = 0; k < myIntervals; k++)
+        {
+            int best = 0;
+            nearest[k] = HUGE_VAL;
+            for (int c = 0; c < clusters; c++)
+            {
+                double dist = getDistance(points, k, centers, c, dims);
+                if (dist < nearest[k])
+                {
+                    nearest[k] = dist;
+                    best = c;
+                }
+            }
+            changed = changed or (best != member[k]);
+            member[k] = best;
+        }
+        if (not changed)
+            break;
+    }
+
+    // each cluster is a stratum, sampled nearest its center first
+    for (int c = 0; c < clusters; c++)
+    {
+        vector<pair<double,int> > byDistance;
+        Stratum cluster;
+        cluster.instructions = 0;
+        for (int k = 0; k < myIntervals; k++)
+        {
+            if (member[k] != c)
+                continue;
+            byDistance.push_back(make_pair(nearest[k], k));
+            cluster.instructions += min(n, (k + 1) * myUnit) - k * myUnit;
+        }
+        if (byDistance.empty())
+            continue;
+        sort(byDistance.begin(), byDistance.end());
+        for (unsigned int k = 0; k < byDistance.size(); k++)
+            cluster.order.push_back(byDistance[k].second);
+        cluster.population = cluster.order.size();
+        myStrata.push_back(cluster);
+    }
+}
+
+
+double Sampler::getDistance(const vector<double> &points, int k,
+                            const vector<double> &centers, int c, int dims)
+/* Returns the squared distance between point k and center c, of dims
+ * coordinates each.
+ */
+{
+    double dist = 0;
+    for (int d = 0; d < dims; d++)
+        dist += pow(points[k*dims + d] - centers[c*dims + d], 2);
+    return dist;
+}
+
+
+double Sampler::sampleInterval(Pipeline &model, int k, long &simulated)
+/* Simulates interval k on model after its warm-up, adds the instructions
+ * simulated to simulated, and returns its CPI.
+ */
+{
+    int n = myTrace.size();
+    int start = k * myUnit;
+    int end = min(n, start + myUnit);
+    int first = max(0, start - max(0, myOptions.sampleWarmup));
+
+    vector<int> pcs(myTrace.begin() + first, myTrace.begin() + end);
+    model.setInstructions(myProgram, pcs);
+    model.execute();
+    simulated += end - first;
+
+    // the ticks of the interval are counted from the completion of the
+    // last warm-up instruction, or from when the first instruction of the
+    // run could have completed had the pipeline already been full
+    int before = (start > first) ? model.getCompletionTime(start - first - 1)
+                                 : NUM_STAGES - 1;
+    return (double)(model.getTotalTime() - before) / (end - start);
+}
+
+
+void Sampler::getEstimate(const vector<vector<double> > &samples, double &cpi,
+                          double &half)
+/* Given the CPIs sampled from each stratum, sets cpi to the estimated CPI
+ * and half to the half width of its 95% confidence interval, or -1 if
+ * there are too few samples to tell.
+ */
+{
+    // the variance within each stratum, and pooled over the strata, for
+    // those with a single sample
+    vector<double> means(samples.size(), 0.0), variances(samples.size(), -1.0);
+    double pooled = 0;
+    int freedom = 0;
+    for (unsigned int h = 0; h < samples.size(); h++)
+    {
+        int m = samples[h].size();
+        for (int k = 0; k < m; k++)
+            means[h] += samples[h][k];
+        if (m > 0)
+            means[h] /= m;
+        if (m < 2)
+            continue;
+        variances[h] = 0;
+        for (int k = 0; k < m; k++)
+            variances[h] += pow(samples[h][k] - means[h], 2) / (m - 1);
+        pooled += variances[h] * (m - 1);
+        freedom += m - 1;
+    }
+
+    cpi = 0;
+    double variance = 0;
+    bool known = true;
+    for (unsigned int h = 0; h < samples.size(); h++)
+    {
+        int m = samples[h].size();
+        if (m == 0)
+            continue;
+        double weight = (double)myStrata[h].instructions / myTrace.size();
+        cpi += weight * means[h];
+
+        // sampling every interval of a stratum leaves no error
+        double unsampled = 1 - (double)m / myStrata[h].population;
+        if (unsampled <= 0)
+            continue;
+        double s2 = variances[h];
+        if (s2 < 0 and freedom > 0)
+            s2 = pooled / freedom;
+        if (s2 < 0)
+            known = false;
+        variance += weight * weight * unsampled * s2 / m;
+    }
+    half = known ? 1.96 * sqrt(variance) : -1;
+}
+
+
+void Sampler::print(Pipeline &model)
+/* Times samples on model, built from the same file with getModelOptions,
+ * until the target error is reached or the chosen intervals run out, and
+ * prints the estimated CPI and total time with their 95% confidence
+ * intervals.
+ */
+{
+    cout << model.getPipelineType() << " sampled: " << endl;
+    int n = myTrace.size();
+    if (n == 0)
+    {
+        cout << "Estimated total time is 0" << endl << endl;
+        return;
+    }
+
+    // take the next interval of every stratum in turn. the error is only
+    // checked after a few samples, since the variance of fewer means little
+    const int fewest = 10;
+    vector<vector<double> > samples(myStrata.size());
+    long simulated = 0;
+    int taken = 0;
+    double cpi = 0, half = -1;
+    bool reached = false;
+    for (unsigned int round = 0; not reached; round++)
+    {
+        bool more = false;
+        for (unsigned int h = 0; h < myStrata.size(); h++)
+        {
+            if (round >= myStrata[h].order.size())
+                continue;
+            samples[h].push_back(sampleInterval(model, myStrata[h].order[round],
+                                                simulated));
+            taken++;
+            more = true;
+        }
+        if (not more)
+            break;
+
+        getEstimate(samples, cpi, half);
+        reached = (myOptions.targetError > 0 and taken >= fewest and half >= 0
+                   and half <= myOptions.targetError * cpi);
+    }
+
+    cout << "Sampled " << taken << " of " << myIntervals << " intervals of "
+         << myUnit << " instructions";
+    if (myOptions.simpoints > 0)
+        cout << " from " << myStrata.size() << " clusters";
+    cout << " (" << simulated << " instructions simulated with warm-up, of "
+         << n << " executed)" << endl;
+
+    cout << "Estimated CPI is " << cpi;
+    if (half >= 0)
+        cout << " +- " << half << " (95% confidence)";
+    cout << endl;
+    cout << "Estimated total time is " << (long)floor(NUM_STAGES - 1 + cpi * n + 0.5);
+    if (half >= 0)
+        cout << " +- " << (long)ceil(half * n);
+    cout << endl;
+    if (reached)
+        cout << "Stopped at the target error of " << 100 * myOptions.targetError
+             << "%" << endl;
+    cout << endl;
+}
+
+
+int Sampler::getRandom(int bound)
+/* Returns a pseudo-random number from 0 to bound-1, the same on every run */
+{
+    mySeed = mySeed * 1103515245 + 12345;
+    return (mySeed >> 8) % bound;
+}
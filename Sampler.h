@@ -0,0 +1,115 @@
+// aalok sathe
+#ifndef _SAMPLER_H_
+#define _SAMPLER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include "Pipeline.h"
+#include "Program.h"
+
+
+/* This class estimates the total time of a pipeline model on a long run
+ * from samples instead of simulating every instruction. The instructions
+ * executed are split into intervals of a fixed number of instructions. A
+ * few intervals are timed in detail, each after a short warm-up that fills
+ * the pipeline, and the instructions in between are only fast-forwarded,
+ * which costs nothing beyond executing the program.
+ *
+ * The intervals are either every so many-th one, taken in a random order
+ * so that stopping early still leaves a random sample, or, SimPoint style,
+ * chosen from clusters of intervals that execute similar code, the one
+ * nearest the center of each cluster first. The clusters are strata: the
+ * estimate weights the mean CPI of each by the instructions in it, and its
+ * variance gives a 95% confidence interval. Sampling stops once that
+ * interval is within the target error, or when the intervals run out.
+ */
+class Sampler{
+
+ public:
+
+  /* Reads the program in inputFile and, if options ask for it, executes it
+   * to find the instructions to time. Splits them into intervals of
+   * options.sampleUnit instructions and chooses the intervals to sample.
+   */
+  Sampler(string inputFile, SimOptions options);
+
+  /* Returns true if the input file was syntactically correct and only
+   * contained supported instructions.  Otherwise, returns false.
+   */
+  bool isFormatCorrect() { return myFormatCorrect; };
+
+  /* Returns the options to construct the models to sample with: they do
+   * not execute the program themselves, have no caches or front end, take
+   * no checkpoints, simulate the whole run and do not follow edits.
+   */
+  SimOptions getModelOptions();
+
+  /* Times samples on model, built from the same file with getModelOptions,
+   * until the target error is reached or the chosen intervals run out, and
+   * prints the estimated CPI and total time with their 95% confidence
+   * intervals.
+   */
+  void print(Pipeline &model);
+
+
+ private:
+
+  // a group of intervals sampled separately: the intervals in the order
+  // they are sampled in, and how many intervals and instructions it has
+  struct Stratum
+  {
+      vector<int> order;
+      int population;
+      long instructions;
+  };
+
+  /* Chooses every myOptions.samplePeriod-th interval, in a random order */
+  void choosePeriodic();
+
+  /* Clusters the intervals by the code they execute and makes each cluster
+   * a stratum, its intervals ordered by distance from its center.
+   */
+  void chooseClusters();
+
+  /* Returns the squared distance between point k and center c, of dims
+   * coordinates each.
+   */
+  double getDistance(const vector<double> &points, int k,
+                     const vector<double> &centers, int c, int dims);
+
+  /* Simulates interval k on model after its warm-up, adds the instructions
+   * simulated to simulated, and returns its CPI.
+   */
+  double sampleInterval(Pipeline &model, int k, long &simulated);
+
+  /* Given the CPIs sampled from each stratum, sets cpi to the estimated CPI
+   * and half to the half width of its 95% confidence interval, or -1 if
+   * there are too few samples to tell.
+   */
+  void getEstimate(const vector<vector<double> > &samples, double &cpi,
+                   double &half);
+
+  /* Returns a pseudo-random number from 0 to bound-1, the same on every run */
+  int getRandom(int bound);
+
+  bool myFormatCorrect;
+  SimOptions myOptions;
+
+  // the program, and the index into it of each instruction executed
+  vector<Instruction> myProgram;
+  vector<int> myTrace;
+
+  // instructions per interval, number of intervals, and how they are
+  // grouped for sampling
+  int myUnit;
+  int myIntervals;
+  vector<Stratum> myStrata;
+
+  // state of the pseudo-random numbers
+  unsigned int mySeed;
+
+};
+
+#endif
@@ -0,0 +1,167 @@
+// aalok sathe
+#ifndef _SIM_OPTIONS_H_
+#define _SIM_OPTIONS_H_
+
+using namespace std;
+
+#include "OpcodeTable.h"
+#include "Cache.h"
+#include <string>
+
+
+/* The shape of one cache level: its size and line size in bytes, and the
+ * number of lines in each set. A size of 0 means the level is not present.
+ */
+struct CacheConfig
+{
+    int size;
+    int lineSize;
+    int ways;
+
+    CacheConfig(int s = 0, int l = 32, int w = 1)
+    {
+        size = s;
+        lineSize = l;
+        ways = w;
+    }
+};
+
+
+/* A structure to hold the settings that a user may pass on the command line
+ * to change how a program is simulated. Every pipeline model is constructed
+ * with a copy of these settings; the defaults reproduce the original
+ * behavior of simulating each instruction of the input file exactly once.
+ */
+struct SimOptions
+{
+    bool execute;       // functionally execute the program and simulate the
+                        // dynamic instruction stream instead of the file
+    long maxSteps;      // most dynamic instructions to execute, so that
+                        // programs that never terminate still finish
+    bool outOfOrder;    // also simulate the out-of-order model
+    int robSize;        // entries in the out-of-order reorder buffer
+    int issueWidth;     // instructions fetched, issued and committed
+                        // together in each clock tick
+    int rsSize;         // reservation stations in the out-of-order model
+    bool superscalar;   // also simulate the in-order superscalar model
+    int latency[UNDEFINED];     // clock ticks each instruction spends on its
+                                // functional unit, in EXECUTE or MEMORY
+    bool pipelined[UNDEFINED];  // whether the unit can start another
+                                // instruction every tick (true) or is busy
+                                // until the instruction is done (false)
+    bool dataCache;     // look up loads in a data cache; an L1 hit takes
+                        // the LW latency, a miss the latency of the level
+                        // that holds the line
+    CacheConfig l1;     // the first level data cache
+    CacheConfig l2;     // the second level cache, if its size is not 0
+    ReplacementPolicy replacement;  // how both levels pick a line to replace
+    int l2Latency;      // clock ticks of a load that hits in the L2
+    int memLatency;     // clock ticks of a load that misses in every level
+    bool frontEnd;      // fetch through an instruction cache and a fetch
+                        // buffer instead of one instruction every tick
+    CacheConfig icache; // the instruction cache; a miss takes memLatency
+    int fetchWidth;     // bytes in the aligned block fetched each tick
+    int fetchBuffer;    // instructions the fetch buffer holds
+    bool criticalPath;  // report the dataflow limit of each model
+    bool estimate;      // estimate the in-order models in one pass over the
+                        // dependences instead of simulating them
+    bool extrapolate;   // time the iterations of a loop that repeat exactly
+                        // from the first repeat instead of simulating them
+    int blockCache;     // basic blocks whose timing is remembered, so that
+                        // blocks entered in the same pipeline state are not
+                        // simulated again; 0 remembers none
+    int sampleUnit;     // if not 0, estimate the totals from samples of
+                        // this many instructions instead of simulating all
+    int samplePeriod;   // sample every this many-th interval
+    int sampleWarmup;   // instructions simulated before each sample
+    int simpoints;      // if not 0, choose the samples from this many
+                        // clusters of intervals that run similar code
+    double targetError; // stop sampling once the 95% confidence interval
+                        // is within this fraction of the estimate; 0 does
+                        // not stop early
+    bool stream;            // read and decode the file on threads of their
+                            // own while its dependences are checked
+    int rangeStart;         // if rangeEnd is not negative, simulate only
+    int rangeEnd;           // the instructions from rangeStart up to
+                            // rangeEnd, after sampleWarmup before them
+    int threads;            // parts of the instructions to simulate at
+                            // the same time, each on a thread of its own
+    string checkpointFile;  // if not empty, write a checkpoint of each
+                            // in-order model to this name with the model's
+                            // name added, e.g. "run.stall"
+    long checkpointEvery;   // instructions completed between checkpoints
+    string resumeFile;      // if not empty, resume each model from its
+                            // checkpoint under this name, if it has one
+    string cacheDir;        // if not empty, keep the programs read in this
+                            // directory and load them from it when the
+                            // same input is read again
+    long cacheLimit;        // bytes the cache directory may take up
+    string traceFile;       // if not empty, write the instructions to
+                            // simulate to this file as a trace
+    string scheduleFile;    // if not empty, reorder the program to reduce
+                            // stalls and write it to this file
+    bool scheduleForStall;  // reorder for the stalling model rather than
+                            // the dataforwarding model
+    string renameFile;      // if not empty, rename registers to remove WAR
+                            // and WAW dependences and write the program to
+                            // this file; it is also what gets scheduled
+    string fillFile;        // if not empty, fill the stalling model's
+                            // bubbles and write the program to this file
+    bool watch;             // simulate the input again each time it is
+                            // saved, only from where it changed
+    string updateFile;      // if not empty, simulate the input, then this
+                            // edit of it, only from where it changed
+    string serveSocket;     // if not empty, serve requests on this Unix
+                            // domain socket instead of simulating a file
+    int workers;            // threads serving requests, 0 for one per
+                            // processor
+    long resultCache;       // answers the server keeps, to answer the same
+                            // request again without simulating it
+
+    SimOptions()
+    {
+        execute = false;
+        maxSteps = 1000000;
+        outOfOrder = false;
+        robSize = 32;
+        issueWidth = 1;
+        rsSize = 16;
+        superscalar = false;
+        dataCache = false;
+        l1 = CacheConfig(8192, 32, 2);
+        l2 = CacheConfig(0, 64, 8);
+        replacement = LRU;
+        l2Latency = 10;
+        memLatency = 100;
+        frontEnd = false;
+        icache = CacheConfig(8192, 32, 2);
+        fetchWidth = 16;
+        fetchBuffer = 8;
+        criticalPath = false;
+        estimate = false;
+        extrapolate = true;
+        blockCache = 0;
+        sampleUnit = 0;
+        samplePeriod = 10;
+        sampleWarmup = 100;
+        simpoints = 0;
+        targetError = 0;
+        checkpointEvery = 100000;
+        threads = 1;
+        stream = false;
+        rangeStart = 0;
+        rangeEnd = -1;
+        cacheLimit = 256L << 20;
+        scheduleForStall = false;
+        watch = false;
+        workers = 0;
+        resultCache = 4096;
+        for (int o = 0; o < UNDEFINED; o++)
+        {
+            latency[o] = 1;
+            pipelined[o] = true;
+        }
+    }
+};
+
+#endif
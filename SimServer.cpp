@@ -0,0 +1,528 @@
+// aalok sathe
+#include "SimServer.h"
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+SimServer::SimServer(string socketPath, SimOptions options)
+    : mySimulator(options)
+/* Creates a server of the models options give, to listen on the socket
+ * socketPath with options.workers worker threads (one per processor if
+ * 0).
+ */
+{
+    mySocketPath = socketPath;
+    myOptions = options;
+    myListener = -1;
+    myWake[0] = myWake[1] = -1;
+    myWorkers = options.workers;
+    if (myWorkers <= 0)
+        myWorkers = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    pthread_mutex_init(&myLock, NULL);
+    pthread_cond_init(&myReady, NULL);
+    myStopping = false;
+    myRequests = 0;
+    myHits = 0;
+    myMisses = 0;
+}
+
+
+SimServer::~SimServer()
+/* Closes the socket, if it is still open */
+{
+    if (myListener >= 0)
+        close(myListener);
+    for (int end = 0; end < 2; end++)
+        if (myWake[end] >= 0)
+            close(myWake[end]);
+    pthread_mutex_destroy(&myLock);
+    pthread_cond_destroy(&myReady);
+}
+
+
+bool SimServer::listen()
+/* Creates the socket, replacing any file of that name, and listens on
+ * it. Returns false if it cannot.
+ */
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (mySocketPath.empty() or mySocketPath.size() >= sizeof(address.sun_path))
+        return false;
+    strcpy(address.sun_path, mySocketPath.c_str());
+
+    myListener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (myListener < 0)
+        return false;
+    unlink(mySocketPath.c_str());
+    if (bind(myListener, (struct sockaddr *)&address, sizeof(address)) != 0
+        or ::listen(myListener, 128) != 0)
+    {
+        close(myListener);
+        myListener = -1;
+        return false;
+    }
+
+    // the workers wake the server through a pipe neither side blocks on
+    if (pipe(myWake) != 0)
+        return false;
+    for (int end = 0; end < 2; end++)
+        fcntl(myWake[end], F_SETFL, fcntl(myWake[end], F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+
+void SimServer::run()
+/* Serves connections, answering their requests on the worker threads,
+ * until a client asks the server to shut down, then removes the socket.
+ */
+{
+    vector<pthread_t> threads(myWorkers);
+    vector<bool> started(myWorkers);
+    for (int w = 0; w < myWorkers; w++)
+        started[w] = (pthread_create(&threads[w], NULL, work, this) == 0);
+
+    // one wait covers new connections, the workers handing connections
+    // back and every connection whose last request has been answered
+    vector<struct pollfd> waits;
+    while (true)
+    {
+        takeBack();
+        pthread_mutex_lock(&myLock);
+        bool stopping = myStopping;
+        pthread_mutex_unlock(&myLock);
+        if (stopping)
+            break;
+
+        waits.clear();
+        struct pollfd entry;
+        entry.events = POLLIN;
+        entry.revents = 0;
+        entry.fd = myListener;
+        waits.push_back(entry);
+        entry.fd = myWake[0];
+        waits.push_back(entry);
+        for (map<int, Connection>::iterator it = myOpen.begin(); it != myOpen.end(); it++)
+            if (not it->second.busy)
+            {
+                entry.fd = it->first;
+                waits.push_back(entry);
+            }
+        if (poll(&waits[0], waits.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (waits[0].revents != 0)
+            acceptConnection();
+        if (waits[1].revents != 0)
+        {
+            char drained[256];
+            while (read(myWake[0], drained, sizeof(drained)) > 0)
+                ;
+        }
+        for (unsigned int w = 2; w < waits.size(); w++)
+            if (waits[w].revents != 0
+                and (not receive(waits[w].fd) or not takeRequest(waits[w].fd)))
+                closeConnection(waits[w].fd);
+    }
+
+    stop();
+    for (int w = 0; w < myWorkers; w++)
+        if (started[w])
+            pthread_join(threads[w], NULL);
+    while (not myOpen.empty())
+        closeConnection(myOpen.begin()->first);
+    close(myListener);
+    myListener = -1;
+    unlink(mySocketPath.c_str());
+}
+
+
+void *SimServer::work(void *server)
+/* The body of a worker thread; server is the SimServer */
+{
+    SimServer *self = (SimServer *)server;
+    while (true)
+    {
+        pthread_mutex_lock(&self->myLock);
+        while (self->myPending.empty() and not self->myStopping)
+            pthread_cond_wait(&self->myReady, &self->myLock);
+        if (self->myStopping)
+        {
+            pthread_mutex_unlock(&self->myLock);
+            return NULL;
+        }
+        Request request = self->myPending.front();
+        self->myPending.pop_front();
+        self->myServing.insert(request.fd);
+        pthread_mutex_unlock(&self->myLock);
+
+        if (not self->serve(request))
+            self->stop();
+    }
+}
+
+
+void SimServer::acceptConnection()
+/* Accepts a connection, if one is waiting, and opens it */
+{
+    int fd = accept(myListener, NULL, NULL);
+    if (fd < 0)
+        return;
+    Connection &connection = myOpen[fd];
+    connection.buffer.clear();
+    connection.busy = false;
+}
+
+
+bool SimServer::receive(int fd)
+/* Reads what has arrived on the open connection fd. Returns false if the
+ * client closed it.
+ */
+{
+    char block[65536];
+    ssize_t got = read(fd, block, sizeof(block));
+
+    // an interrupted read is tried again on the next wait
+    if (got < 0 and errno == EINTR)
+        return true;
+    if (got <= 0)
+        return false;
+    myOpen[fd].buffer.append(block, got);
+    return true;
+}
+
+
+bool SimServer::takeRequest(int fd)
+/* Queues the request at the front of the open connection fd, if it has
+ * all arrived and the connection's last one has been answered. Returns
+ * false, having answered ERROR, if the request is malformed, and the
+ * connection is to be closed.
+ */
+{
+    Connection &connection = myOpen[fd];
+    if (connection.busy)
+        return true;
+    string &buffer = connection.buffer;
+    size_t newline = buffer.find('\n');
+    if ((newline == string::npos and buffer.size() > MAX_LINE)
+        or (newline != string::npos and newline > MAX_LINE))
+    {
+        writeAll(fd, "ERROR request line too long\n");
+        return false;
+    }
+    if (newline == string::npos)
+        return true;
+
+    Request request;
+    request.fd = fd;
+    istringstream split(buffer.substr(0, newline));
+    string word;
+    while (split >> word)
+        request.words.push_back(word);
+
+    // SIMULATE is followed by its program, which must all have arrived
+    // before the request is taken
+    size_t length = newline + 1;
+    if (not request.words.empty() and request.words[0] == "SIMULATE")
+    {
+        vector<string> &words = request.words;
+        char *end = NULL;
+        long bytes = (words.size() >= 3) ? strtol(words[2].c_str(), &end, 10) : -1;
+        if (end == NULL or *end != '\0' or bytes < 0 or bytes > MAX_PROGRAM)
+        {
+            writeAll(fd, "ERROR bad program size\n");
+            return false;
+        }
+        if (buffer.size() < length + (size_t)bytes)
+            return true;
+        request.program = buffer.substr(length, bytes);
+        length += bytes;
+    }
+    buffer.erase(0, length);
+
+    connection.busy = true;
+    pthread_mutex_lock(&myLock);
+    myPending.push_back(request);
+    pthread_cond_signal(&myReady);
+    pthread_mutex_unlock(&myLock);
+    return true;
+}
+
+
+bool SimServer::serve(Request &request)
+/* Answers request, on a worker thread, and hands its connection back.
+ * Returns false if the server is to shut down.
+ */
+{
+    bool last = (not request.words.empty() and request.words[0] == "SHUTDOWN");
+    bool written = writeAll(request.fd, last ? string("BYE\n")
+                                             : answer(request.words, request.program));
+    pthread_mutex_lock(&myLock);
+    myServing.erase(request.fd);
+    myAnswered.push_back(make_pair(request.fd, written));
+    pthread_mutex_unlock(&myLock);
+    wake();
+    return not last;
+}
+
+
+void SimServer::takeBack()
+/* Takes back the connections whose requests have been answered, closing
+ * those that failed, and queues their next requests.
+ */
+{
+    vector<pair<int, bool> > answered;
+    pthread_mutex_lock(&myLock);
+    answered.swap(myAnswered);
+    pthread_mutex_unlock(&myLock);
+
+    // a client may have sent its next request before the last was
+    // answered, so it is taken now rather than after the next wait
+    for (unsigned int a = 0; a < answered.size(); a++)
+    {
+        int fd = answered[a].first;
+        myOpen[fd].busy = false;
+        if (not answered[a].second or not takeRequest(fd))
+            closeConnection(fd);
+    }
+}
+
+
+void SimServer::closeConnection(int fd)
+/* Closes the open connection fd */
+{
+    myOpen.erase(fd);
+    close(fd);
+}
+
+
+string SimServer::answer(const vector<string> &words, const string &program)
+/* Returns the answer to the request whose words are words and whose
+ * program, for SIMULATE, is program.
+ */
+{
+    if (words.empty())
+        return "ERROR empty request\n";
+    if (words[0] == "PING")
+        return "PONG\n";
+    if (words[0] == "STATS")
+    {
+        ostringstream stats;
+        pthread_mutex_lock(&myLock);
+        stats << "STATS requests " << myRequests << " hits " << myHits << " misses "
+              << myMisses << " entries " << myResults.size() << " workers "
+              << myWorkers << "\n";
+        pthread_mutex_unlock(&myLock);
+        return stats.str();
+    }
+    if (words[0] != "SIMULATE")
+        return "ERROR unknown request " + words[0] + "\n";
+
+    // the models named, or the server's, and whether to give the times
+    vector<string> models;
+    bool times = false;
+    for (unsigned int w = 3; w < words.size(); w++)
+    {
+        if (words[w] == "TIMES")
+            times = true;
+        else
+            models.push_back(words[w]);
+    }
+    if (models.empty())
+        models = mySimulator.getModelTypes();
+
+    // an answer given before is given again as it was
+    string key = words[1];
+    for (unsigned int m = 0; m < models.size(); m++)
+        key += " " + models[m];
+    key += (times ? " TIMES\n" : "\n") + program;
+    string response;
+    pthread_mutex_lock(&myLock);
+    myRequests++;
+    map<string, list<pair<string, string> >::iterator>::iterator found = myIndex.find(key);
+    if (found != myIndex.end())
+    {
+        myResults.splice(myResults.begin(), myResults, found->second);
+        response = found->second->second;
+        myHits++;
+    }
+    else
+        myMisses++;
+    pthread_mutex_unlock(&myLock);
+    if (not response.empty())
+        return response;
+
+    // otherwise it is simulated, and kept unless it failed
+    response = simulate(words[1], models, times, program);
+    if (response.compare(0, 3, "OK ") != 0 or myOptions.resultCache <= 0)
+        return response;
+    pthread_mutex_lock(&myLock);
+    if (myIndex.find(key) == myIndex.end())
+    {
+        myResults.push_front(make_pair(key, response));
+        myIndex[key] = myResults.begin();
+        while ((long)myResults.size() > myOptions.resultCache)
+        {
+            myIndex.erase(myResults.back().first);
+            myResults.pop_back();
+        }
+    }
+    pthread_mutex_unlock(&myLock);
+    return response;
+}
+
+
+string SimServer::simulate(string format, const vector<string> &models, bool times,
+                           const string &program)
+/* Returns the answer to SIMULATE of program in format on models, with
+ * the completion times if times.
+ */
+{
+    if (format != "asm" and format != "mach")
+        return "ERROR unknown format " + format + "\n";
+    vector<Instruction> instructions;
+    if (not Simulator::parse(program, format, instructions))
+        return "ERROR input is not formatted correctly\n";
+
+    ostringstream out;
+    out << "OK " << models.size() << "\n";
+    for (unsigned int m = 0; m < models.size(); m++)
+    {
+        ModelResult result;
+        if (not mySimulator.simulateModel(instructions, models[m], result))
+            return "ERROR unknown model " + models[m] + "\n";
+        out << result.model << " " << result.totalTime << " " << result.instructions
+            << " " << result.ipc;
+        if (times)
+            for (unsigned int k = 0; k < result.completionTimes.size(); k++)
+                out << " " << result.completionTimes[k];
+        out << "\n";
+    }
+    return out.str();
+}
+
+
+void SimServer::stop()
+/* Stops taking connections and requests, and ends the answers being
+ * written.
+ */
+{
+    pthread_mutex_lock(&myLock);
+    myStopping = true;
+    pthread_cond_broadcast(&myReady);
+    for (set<int>::iterator fd = myServing.begin(); fd != myServing.end(); fd++)
+        shutdown(*fd, SHUT_RDWR);
+    myPending.clear();
+    pthread_mutex_unlock(&myLock);
+    wake();
+}
+
+
+void SimServer::wake()
+/* Wakes the thread waiting on the connections */
+{
+    // a full pipe already holds a wake-up, so a failed write is no loss
+    char byte = 0;
+    while (write(myWake[1], &byte, 1) < 0 and errno == EINTR)
+        ;
+}
+
+
+bool SimServer::request(string socketPath, const string &request, string &response)
+/* Sends request, the whole text of a request as above, to the server on
+ * socketPath and reads its answer into response. Returns false if the
+ * server cannot be reached or the answer is cut short.
+ */
+{
+    response.clear();
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        return false;
+    strcpy(address.sun_path, socketPath.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0
+        or not writeAll(fd, request))
+    {
+        close(fd);
+        return false;
+    }
+
+    // the first line says how many lines follow it
+    string buffer, line;
+    bool complete = readLine(fd, buffer, line, MAX_PROGRAM);
+    if (complete)
+    {
+        response = line + "\n";
+        int lines = 0;
+        if (line.compare(0, 3, "OK ") == 0)
+            lines = atoi(line.c_str() + 3);
+        for (int l = 0; l < lines and complete; l++)
+        {
+            complete = readLine(fd, buffer, line, MAX_PROGRAM);
+            response += line + "\n";
+        }
+    }
+    close(fd);
+    return complete;
+}
+
+
+bool SimServer::writeAll(int fd, const string &text)
+/* Writes all of text to fd. Returns false if the connection is gone. */
+{
+    size_t done = 0;
+    while (done < text.size())
+    {
+        // a client that went away must not end the server with SIGPIPE
+        ssize_t wrote = send(fd, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+        if (wrote < 0 and errno == EINTR)
+            continue;
+        if (wrote <= 0)
+            return false;
+        done += wrote;
+    }
+    return true;
+}
+
+
+bool SimServer::readLine(int fd, string &buffer, string &line, size_t limit)
+/* Reads from fd onto buffer until it holds a whole line of at most limit
+ * bytes. Returns false if the connection ends first or the line is
+ * longer.
+ */
+{
+    size_t newline;
+    while ((newline = buffer.find('\n')) == string::npos)
+    {
+        if (buffer.size() > limit)
+            return false;
+        char block[4096];
+        ssize_t got = read(fd, block, sizeof(block));
+        if (got < 0 and errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        buffer.append(block, got);
+    }
+    if (newline > limit)
+        return false;
+    line = buffer.substr(0, newline);
+    buffer.erase(0, newline + 1);
+    return true;
+}
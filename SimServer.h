@@ -0,0 +1,192 @@
+// aalok sathe
+#ifndef _SIM_SERVER_H_
+#define _SIM_SERVER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <pthread.h>
+#include "Simulator.h"
+
+
+/* This class is a simulation server: a long-running PIPESIM that listens
+ * on a Unix domain socket and answers requests with a Simulator, so that
+ * callers making many small queries pay neither for starting a process
+ * nor for formatting its output. The thread that runs the server waits on
+ * every open connection at once and reads what arrives on each; once a
+ * connection holds a whole request, the request is queued for a pool of
+ * worker threads. A worker answers one request and is free for the next,
+ * whichever connection it comes from, so a client that stays connected
+ * does not hold a worker while it is idle. A connection's requests are
+ * answered in order, one at a time. A request is a line of words, of at
+ * most MAX_LINE bytes, and for SIMULATE the program after it:
+ *
+ *   SIMULATE <asm|mach> <bytes> [<MODEL>...] [TIMES]   then <bytes> bytes
+ *   STATS
+ *   PING
+ *   SHUTDOWN
+ *
+ * SIMULATE answers "OK <n>" and then a line for each of the n models (the
+ * ones named, or those of the server's options): its name, total time,
+ * instructions and IPC, then with TIMES the completion time of each
+ * instruction. STATS answers with the requests served, the result cache
+ * hits and misses and its entries, PING with PONG, and SHUTDOWN with BYE
+ * before the server stops. Any error is a line "ERROR <reason>".
+ *
+ * The last answers are kept in a result cache of options.resultCache
+ * entries, keyed by the whole request, so a program asked about again is
+ * answered without being parsed or simulated; the least recently used
+ * answer is dropped first. The options, e.g. -x or the latencies, are
+ * those the server was started with and hold for every request.
+ */
+class SimServer{
+
+ public:
+
+  /* Creates a server of the models options give, to listen on the socket
+   * socketPath with options.workers worker threads (one per processor if
+   * 0).
+   */
+  SimServer(string socketPath, SimOptions options);
+
+  /* Closes the socket, if it is still open */
+  ~SimServer();
+
+  /* Creates the socket, replacing any file of that name, and listens on
+   * it. Returns false if it cannot.
+   */
+  bool listen();
+
+  /* Serves connections, answering their requests on the worker threads,
+   * until a client asks the server to shut down, then removes the socket.
+   */
+  void run();
+
+  /* Sends request, the whole text of a request as above, to the server on
+   * socketPath and reads its answer into response. Returns false if the
+   * server cannot be reached or the answer is cut short.
+   */
+  static bool request(string socketPath, const string &request, string &response);
+
+
+ private:
+
+  /* An open connection: what has been read from it and not taken as a
+   * request yet, and whether a worker has its last request.
+   */
+  struct Connection
+  {
+      string buffer;
+      bool busy;
+  };
+
+  /* A request taken from connection fd, for a worker to answer */
+  struct Request
+  {
+      int fd;
+      vector<string> words;
+      string program;
+  };
+
+  /* The body of a worker thread; server is the SimServer */
+  static void *work(void *server);
+
+  /* Accepts a connection, if one is waiting, and opens it */
+  void acceptConnection();
+
+  /* Reads what has arrived on the open connection fd. Returns false if
+   * the client closed it.
+   */
+  bool receive(int fd);
+
+  /* Queues the request at the front of the open connection fd, if it has
+   * all arrived and the connection's last one has been answered. Returns
+   * false, having answered ERROR, if the request is malformed, and the
+   * connection is to be closed.
+   */
+  bool takeRequest(int fd);
+
+  /* Answers request, on a worker thread, and hands its connection back.
+   * Returns false if the server is to shut down.
+   */
+  bool serve(Request &request);
+
+  /* Takes back the connections whose requests have been answered,
+   * closing those that failed, and queues their next requests.
+   */
+  void takeBack();
+
+  /* Closes the open connection fd */
+  void closeConnection(int fd);
+
+  /* Returns the answer to the request whose words are words and whose
+   * program, for SIMULATE, is program.
+   */
+  string answer(const vector<string> &words, const string &program);
+
+  /* Returns the answer to SIMULATE of program in format on models, with
+   * the completion times if times.
+   */
+  string simulate(string format, const vector<string> &models, bool times,
+                  const string &program);
+
+  /* Stops taking connections and requests, and ends the answers being
+   * written.
+   */
+  void stop();
+
+  /* Wakes the thread waiting on the connections */
+  void wake();
+
+  /* Writes all of text to fd. Returns false if the connection is gone. */
+  static bool writeAll(int fd, const string &text);
+
+  /* Reads from fd onto buffer until it holds a whole line of at most
+   * limit bytes. Returns false if the connection ends first or the line
+   * is longer.
+   */
+  static bool readLine(int fd, string &buffer, string &line, size_t limit);
+
+  // requests larger than this are refused, as are request lines longer
+  // than MAX_LINE
+  static const long MAX_PROGRAM = 64L << 20;
+  static const size_t MAX_LINE = 4096;
+
+  string mySocketPath;
+  SimOptions myOptions;
+  Simulator mySimulator;
+  int myListener;               // the listening socket, or -1
+  int myWorkers;
+
+  // the open connections, by socket, only used by the thread running
+  // the server; and a pipe the workers write to wake it
+  map<int, Connection> myOpen;
+  int myWake[2];
+
+  // requests not taken by a worker yet, the connections whose answers
+  // are being written, those answered and to be handed back (with
+  // whether they are still usable), and whether the server is stopping,
+  // all under myLock
+  pthread_mutex_t myLock;
+  pthread_cond_t myReady;
+  deque<Request> myPending;
+  set<int> myServing;
+  vector<pair<int, bool> > myAnswered;
+  bool myStopping;
+
+  // the result cache, from the most recently used answer, with an index
+  // by request, and what it saved, also under myLock
+  list<pair<string, string> > myResults;
+  map<string, list<pair<string, string> >::iterator> myIndex;
+  long myRequests;
+  long myHits;
+  long myMisses;
+
+};
+
+#endif
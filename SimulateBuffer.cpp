@@ -0,0 +1,48 @@
+#include "Simulator.h"
+#include <iostream>
+#include <iterator>
+#include <cstdlib>
+#include <sys/time.h>
+
+using namespace std;
+
+/* An example of using libpipesim: reads a program in the format given as
+ * the first argument ("asm" or "mach") from standard input into memory,
+ * simulates it through a Simulator, and prints the total time of each
+ * model as PIPESIM does. Given a number of calls as the second argument,
+ * it also simulates the program that many times more and prints the
+ * microseconds each call took on average.
+ */
+int main(int argc, char *argv[])
+{
+  if(argc < 2){
+    cerr << "Need to enter the input format " << endl;
+    exit(1);
+  }
+  string text((istreambuf_iterator<char>(cin)), istreambuf_iterator<char>());
+
+  Simulator simulator;
+  vector<Instruction> program;
+  vector<ModelResult> results;
+  if(!Simulator::parse(text, argv[1], program)
+     || !simulator.simulate(program.begin(), program.end(), results)){
+    cerr << "Input file is not formatted correctly " << endl;
+    exit(1);
+  }
+  for(unsigned int m = 0; m < results.size(); m++)
+    cout << results[m].model << " Total time is " << results[m].totalTime << endl;
+
+  // time calls from the text on, as a caller with the program in a buffer
+  // would make them
+  int calls = (argc > 2) ? atoi(argv[2]) : 0;
+  if(calls > 0){
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    for(int c = 0; c < calls; c++)
+      simulator.simulate(text.data(), text.size(), argv[1], results);
+    gettimeofday(&end, NULL);
+    double took = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec);
+    cout << "Microseconds per call: " << took / calls << endl;
+  }
+  return 0;
+}
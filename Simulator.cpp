@@ -0,0 +1,155 @@
+// aalok sathe
+#include "Simulator.h"
+#include "StallPipeline.h"
+#include "DataForwardPipeline.h"
+#include "SuperscalarPipeline.h"
+#include "OutOfOrderPipeline.h"
+#include "ASMParser.h"
+#include "MachLangParser.h"
+
+Simulator::Simulator(SimOptions options)
+/* Creates a simulator of the ideal, stalling and dataforwarding models,
+ * and the superscalar and out-of-order ones if options ask for them.
+ */
+{
+    myOptions = options;
+    myOptions.estimate = false;
+    myTypes.push_back("IDEAL");
+    myTypes.push_back("STALL");
+    myTypes.push_back("FORWARDING");
+    if (myOptions.superscalar)
+        myTypes.push_back("SUPERSCALAR");
+    if (myOptions.outOfOrder)
+        myTypes.push_back("OUT-OF-ORDER");
+}
+
+
+bool Simulator::parse(const char *buffer, size_t length, string format,
+                      vector<Instruction> &program)
+/* Parses length bytes from buffer, the lines of a MIPS assembly file if
+ * format is "asm" or of a MIPS machine instruction file if it is "mach",
+ * into program. Returns false if the format is neither or a line is not
+ * a supported instruction.
+ */
+{
+    program.clear();
+    string text(buffer, length);
+    if (format == "mach")
+    {
+        MachLangParser parser;
+        return parser.parseBlock(text, program);
+    }
+    if (format != "asm")
+        return false;
+
+    // the whole buffer is one block, so only branches and jumps to labels
+    // defined after them are parsed again
+    ASMParser parser;
+    if (not parser.parseBlock(text, program))
+        return false;
+    vector<pair<int, Instruction> > changed;
+    parser.finishBlocks(changed);
+    for (unsigned int c = 0; c < changed.size(); c++)
+        program[changed[c].first] = changed[c].second;
+    return true;
+}
+
+
+bool Simulator::simulate(const vector<Instruction> &program, vector<ModelResult> &results)
+/* Simulates program on each model, in the order PIPESIM prints them,
+ * replacing results with their timings. Returns false, with no results,
+ * if an instruction is not a supported one.
+ */
+{
+    results.assign(myTypes.size(), ModelResult());
+    for (unsigned int m = 0; m < myTypes.size(); m++)
+    {
+        if (not simulateModel(program, myTypes[m], results[m]))
+        {
+            results.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool Simulator::simulate(const char *buffer, size_t length, string format,
+                         vector<ModelResult> &results)
+/* Parses length bytes from buffer in format, as parse does, and
+ * simulates the program, as above. Returns false if it does not parse.
+ */
+{
+    vector<Instruction> program;
+    results.clear();
+    return parse(buffer, length, format, program) and simulate(program, results);
+}
+
+
+bool Simulator::simulateModel(const vector<Instruction> &program, string type,
+                              ModelResult &result)
+/* Simulates program on the one model named type, as getPipelineType
+ * names it, into result. Returns false if there is no such model or an
+ * instruction is not a supported one.
+ */
+{
+    Pipeline *model = createModel(type, program, myOptions);
+    bool simulated = (model != NULL and model->isFormatCorrect());
+    if (simulated)
+        getResult(*model, result);
+    delete model;
+    return simulated;
+}
+
+
+Pipeline *Simulator::createModel(string type, string inputFile, const SimOptions &options)
+/* Returns a new model of the kind type names, simulating inputFile with
+ * options, or NULL if there is no such model.
+ */
+{
+    if (type == "IDEAL")
+        return new Pipeline(inputFile, options);
+    if (type == "STALL")
+        return new StallPipeline(inputFile, options);
+    if (type == "FORWARDING")
+        return new DataForwardPipeline(inputFile, options);
+    if (type == "SUPERSCALAR")
+        return new SuperscalarPipeline(inputFile, options);
+    if (type == "OUT-OF-ORDER")
+        return new OutOfOrderPipeline(inputFile, options);
+    return NULL;
+}
+
+
+Pipeline *Simulator::createModel(string type, const vector<Instruction> &program,
+                                 const SimOptions &options)
+/* Returns a new model of the kind type names, simulating program with
+ * options, or NULL if there is no such model.
+ */
+{
+    if (type == "IDEAL")
+        return new Pipeline(program, options);
+    if (type == "STALL")
+        return new StallPipeline(program, options);
+    if (type == "FORWARDING")
+        return new DataForwardPipeline(program, options);
+    if (type == "SUPERSCALAR")
+        return new SuperscalarPipeline(program, options);
+    if (type == "OUT-OF-ORDER")
+        return new OutOfOrderPipeline(program, options);
+    return NULL;
+}
+
+
+void Simulator::getResult(Pipeline &model, ModelResult &result)
+/* Executes model and puts its timing into result */
+{
+    model.execute();
+    result.model = model.getPipelineType();
+    result.totalTime = model.getTotalTime();
+    result.instructions = model.getNumInstructions();
+    result.ipc = model.getIPC();
+    result.completionTimes.resize(result.instructions);
+    for (int k = 0; k < result.instructions; k++)
+        result.completionTimes[k] = model.getCompletionTime(k);
+}
@@ -0,0 +1,99 @@
+// aalok sathe
+#ifndef _SIMULATOR_H_
+#define _SIMULATOR_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Pipeline.h"
+
+
+/* The timing of a program on one pipeline model */
+struct ModelResult
+{
+    string model;                   // the model's name, e.g. "STALL"
+    int totalTime;                  // clock tick the last instruction
+                                    // completed in, 0 with no instructions
+    int instructions;               // instructions simulated
+    double ipc;                     // instructions completed per clock tick
+    vector<int> completionTimes;    // clock tick each instruction completed
+                                    // in, in the order they were simulated
+};
+
+
+/* This class is the entry point of libpipesim, for programs that simulate
+ * without files or a PIPESIM process: a compiler's cost model, say, or a
+ * server. It takes programs as text in memory, in either input format, or
+ * as Instructions from any iterator, simulates them on the models PIPESIM
+ * would with the same options, and returns the timings as ModelResults
+ * rather than printing them. Nothing is read from or written to a file,
+ * so the options that name files are not used, and neither is estimate.
+ * A Simulator keeps no state between calls other than its options, so
+ * one may be shared by threads.
+ */
+class Simulator{
+
+ public:
+
+  /* Creates a simulator of the ideal, stalling and dataforwarding models,
+   * and the superscalar and out-of-order ones if options ask for them.
+   */
+  Simulator(SimOptions options = SimOptions());
+
+  /* Parses length bytes from buffer, the lines of a MIPS assembly file if
+   * format is "asm" or of a MIPS machine instruction file if it is "mach",
+   * into program. Returns false if the format is neither or a line is not
+   * a supported instruction.
+   */
+  static bool parse(const char *buffer, size_t length, string format,
+                    vector<Instruction> &program);
+  static bool parse(const string &text, string format, vector<Instruction> &program)
+    { return parse(text.data(), text.size(), format, program); };
+
+  /* Simulates program on each model, in the order PIPESIM prints them,
+   * replacing results with their timings. Returns false, with no results,
+   * if an instruction is not a supported one.
+   */
+  bool simulate(const vector<Instruction> &program, vector<ModelResult> &results);
+
+  /* Simulates the Instructions from first up to last, as above */
+  template <class Iterator>
+  bool simulate(Iterator first, Iterator last, vector<ModelResult> &results)
+    { return simulate(vector<Instruction>(first, last), results); };
+
+  /* Parses length bytes from buffer in format, as parse does, and
+   * simulates the program, as above. Returns false if it does not parse.
+   */
+  bool simulate(const char *buffer, size_t length, string format,
+                vector<ModelResult> &results);
+
+  /* Simulates program on the one model named type, as getPipelineType
+   * names it, into result. Returns false if there is no such model or an
+   * instruction is not a supported one.
+   */
+  bool simulateModel(const vector<Instruction> &program, string type, ModelResult &result);
+
+  /* Returns the names of the models simulate simulates, in order */
+  const vector<string> &getModelTypes() { return myTypes; };
+
+  /* Return a new model of the kind type names, simulating inputFile or
+   * program with options, or NULL if there is no such model.
+   */
+  static Pipeline *createModel(string type, string inputFile, const SimOptions &options);
+  static Pipeline *createModel(string type, const vector<Instruction> &program,
+                               const SimOptions &options);
+
+
+ private:
+
+  /* Executes model and puts its timing into result */
+  static void getResult(Pipeline &model, ModelResult &result);
+
+  SimOptions myOptions;
+  vector<string> myTypes;     // the models to simulate, in order
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+// aalok sathe
+#include "SlotFiller.h"
+#include <algorithm>
+
+SlotFiller::SlotFiller(string inputFile, Pipeline &model)
+    : myProgram(inputFile)
+/* Reads the program in inputFile, a MIPS assembly or machine instruction
+ * file, and fills the bubbles model would insert in each basic block.
+ */
+{
+    myBubblesBefore = myBubblesAfter = myNumMoved = myControlBubbles = 0;
+    if (not myProgram.isFormatCorrect())
+        return;
+
+    int n = myProgram.size();
+    myOrder.resize(n);
+    mySources.resize(2*n);
+    myDests.resize(n);
+    myReads.assign(n, 0);
+    myStart.assign(n, 0);
+    myWrites.assign(n, 0);
+    for (int k = 0; k < n; k++)
+    {
+        myOrder[k] = k;
+        myDependencyChecker.getRegisters(myProgram.getInstruction(k),
+                                         &mySources[2*k], myDests[k]);
+        for (int j = 0; j < 2; j++)
+            if (mySources[2*k + j] >= 0)
+                myReads[k] |= (uint64_t)1 << mySources[2*k + j];
+        if (myDests[k] >= 0)
+            myWrites[k] |= (uint64_t)1 << myDests[k];
+
+        // the next instruction waits after a control instruction however
+        // the block before it is ordered
+        Opcode opc = myProgram.getInstruction(k).getOpcode();
+        if (k + 1 < n and myOpcodes.getInstFunc(opc) == CONTROL_I)
+            myControlBubbles += model.getControlDelay();
+    }
+
+    vector<int> starts = myProgram.getBlockStarts();
+    for (unsigned int b = 0; b + 1 < starts.size(); b++)
+        fillBlock(starts[b], starts[b+1], model);
+}
+
+
+void SlotFiller::fillBlock(int begin, int end, Pipeline &model)
+/* Fills the bubbles in the block of instructions from begin up to, but
+ * not including, end, and stores the new order in myOrder.
+ */
+{
+    int m = end - begin;
+    vector<int> order(myOrder.begin() + begin, myOrder.begin() + end);
+    myBubblesBefore += getBlockBubbles(order, model);
+
+    // a control instruction ending the block has to stay last
+    int limit = m;
+    if (m > 0 and myOpcodes.getInstFunc(myProgram.getInstruction(end - 1).getOpcode())
+                  == CONTROL_I)
+        limit = m - 1;
+
+    // writer holds the last placed instruction that writes each register
+    vector<int> writer(DependencyChecker::HI_REGISTER + 1, -1);
+    int t = -1;
+    for (int p = 0; p < m; p++)
+    {
+        // while the instruction at p would wait, move up the nearest one
+        // after it that can start in the next tick and that reads nothing
+        // the instructions it moves past write, and writes nothing they
+        // read or write
+        while (getReadyTime(order[p], writer, model) > t + 1)
+        {
+            uint64_t reads = myReads[order[p]], writes = myWrites[order[p]];
+            int found = -1;
+            for (int q = p + 1; q < min(limit, p + 1 + LOOKAHEAD); q++)
+            {
+                int x = order[q];
+                if (not (myReads[x] & writes) and not (myWrites[x] & (reads | writes))
+                    and getReadyTime(x, writer, model) <= t + 1)
+                {
+                    found = q;
+                    break;
+                }
+                reads |= myReads[x];
+                writes |= myWrites[x];
+            }
+            if (found < 0)
+                break;
+
+            rotate(order.begin() + p, order.begin() + found, order.begin() + found + 1);
+            int x = order[p++];
+            myStart[x] = ++t;
+            if (myDests[x] >= 0)
+                writer[myDests[x]] = x;
+            myNumMoved++;
+        }
+
+        int c = order[p];
+        myStart[c] = t = max(t + 1, getReadyTime(c, writer, model));
+        if (myDests[c] >= 0)
+            writer[myDests[c]] = c;
+    }
+
+    myBubblesAfter += getBlockBubbles(order, model);
+    copy(order.begin(), order.end(), myOrder.begin() + begin);
+}
+
+
+int SlotFiller::getBlockBubbles(const vector<int> &order, Pipeline &model)
+/* Returns the number of stall cycles the instructions of a block wait for
+ * values when they execute in the given order.
+ */
+{
+    vector<int> writer(DependencyChecker::HI_REGISTER + 1, -1);
+    int t = -1, bubbles = 0;
+    for (unsigned int p = 0; p < order.size(); p++)
+    {
+        int c = order[p];
+        int ready = getReadyTime(c, writer, model);
+        bubbles += max(0, ready - (t + 1));
+        myStart[c] = t = max(t + 1, ready);
+        if (myDests[c] >= 0)
+            writer[myDests[c]] = c;
+    }
+    return bubbles;
+}
+
+
+int SlotFiller::getReadyTime(int k, const vector<int> &writer, Pipeline &model)
+/* Returns the tick instruction k can start in given the last instruction
+ * placed so far to write each register (writer), or 0 if it reads none.
+ */
+{
+    int ready = 0;
+    Opcode opc = myProgram.getInstruction(k).getOpcode();
+    for (int j = 0; j < 2; j++)
+    {
+        int r = mySources[2*k + j];
+        if (r < 0 or writer[r] < 0)
+            continue;
+        int w = writer[r];
+        ready = max(ready, myStart[w] + model.getValueDelay(
+                        myProgram.getInstruction(w).getOpcode(), opc));
+    }
+    return ready;
+}
+
+
+bool SlotFiller::write(string outputFile)
+/* Writes the rewritten program to outputFile, as assembly if its
+ * extension is "asm" and as machine instructions if it is "mach".
+ * Returns false if the file could not be written.
+ */
+{
+    return myProgram.write(outputFile, myOrder);
+}
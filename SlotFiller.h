@@ -0,0 +1,110 @@
+// aalok sathe
+#ifndef _SLOT_FILLER_H_
+#define _SLOT_FILLER_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "Pipeline.h"
+#include "Program.h"
+
+
+/* This class fills the bubbles a pipeline model inserts with instructions
+ * that do not depend on the stalled one, the way a compiler fills delay
+ * slots. Going through each basic block in order, when an instruction
+ * would wait for a value, the nearest later instruction in the block that
+ * can start right away is moved up in front of it, as long as it has no
+ * RAW, WAR or WAW dependence with the instructions it moves past. Moving
+ * an instruction up never makes it or the ones after it start later, so a
+ * block only gets faster.
+ *
+ * The tick an instruction waits after a control instruction is counted but
+ * not filled: that would need a branch delay slot, which the instruction
+ * set does not have.
+ */
+class SlotFiller{
+
+ public:
+
+  /* Reads the program in inputFile, a MIPS assembly or machine instruction
+   * file, and fills the bubbles model would insert in each basic block.
+   */
+  SlotFiller(string inputFile, Pipeline &model);
+
+  /* Returns true if the input file was syntactically correct and only
+   * contained supported instructions.  Otherwise, returns false.
+   */
+  bool isFormatCorrect() { return myProgram.isFormatCorrect(); };
+
+  /* Writes the rewritten program to outputFile, as assembly if its
+   * extension is "asm" and as machine instructions if it is "mach".
+   * Returns false if the file could not be written.
+   */
+  bool write(string outputFile);
+
+  /* Returns the number of stall cycles from RAW dependences within basic
+   * blocks before filling (filled false) or after (filled true).
+   */
+  int getNumBubbles(bool filled)
+    { return filled ? myBubblesAfter : myBubblesBefore; };
+
+  /* Returns the number of instructions moved into bubbles */
+  int getNumMoved() { return myNumMoved; };
+
+  /* Returns the number of clock ticks lost after control instructions */
+  int getNumControlBubbles() { return myControlBubbles; };
+
+
+ private:
+
+  /* Fills the bubbles in the block of instructions from begin up to, but
+   * not including, end, and stores the new order in myOrder.
+   */
+  void fillBlock(int begin, int end, Pipeline &model);
+
+  /* Returns the number of stall cycles the instructions of a block wait for
+   * values when they execute in the given order.
+   */
+  int getBlockBubbles(const vector<int> &order, Pipeline &model);
+
+  /* Returns the tick instruction k can start in given the last instruction
+   * placed so far to write each register (writer), or 0 if it reads none.
+   */
+  int getReadyTime(int k, const vector<int> &writer, Pipeline &model);
+
+  // how far past a stalled instruction to look for one to move up
+  static const int LOOKAHEAD = 16;
+
+  // the program as read
+  Program myProgram;
+
+  // index into myProgram of the instruction placed at each position
+  vector<int> myOrder;
+
+  // the registers (and HI) each instruction reads, two per instruction,
+  // and writes, as DependencyChecker::getRegisters gives them, and the
+  // same as bitmasks
+  vector<int> mySources;
+  vector<int> myDests;
+  vector<uint64_t> myReads;
+  vector<uint64_t> myWrites;
+
+  // the tick each placed instruction starts in, counted from the start of
+  // its block
+  vector<int> myStart;
+
+  int myBubblesBefore;
+  int myBubblesAfter;
+  int myNumMoved;
+  int myControlBubbles;
+
+  // used for the registers each instruction reads and writes, and for
+  // the kind of each instruction
+  DependencyChecker myDependencyChecker;
+  OpcodeTable myOpcodes;
+
+};
+
+#endif
@@ -0,0 +1,49 @@
+// aalok sathe
+#include "StageRing.h"
+
+StageRing::StageRing()
+/* Creates an empty ring, with no instruction finished */
+{
+    // enough for the instructions of a pipeline a few instructions wide;
+    // a wider one grows it
+    mySlots.resize(32);
+    myMask = mySlots.size() - 1;
+    myFirst = myEnd = 0;
+}
+
+
+void StageRing::reset(int first)
+/* Empties the ring, with the instructions before first finished */
+{
+    myFirst = myEnd = first;
+}
+
+
+void StageRing::push(PipelineStages stage, int leave)
+/* Brings the next instruction, getEnd(), into the pipeline in stage, free
+ * to leave it from clock tick leave.
+ */
+{
+    // the instructions at the front that have finished make room
+    while (myEnd - myFirst > myMask and mySlots[myFirst & myMask].stage == NUM_STAGES)
+        myFirst++;
+    if (myEnd - myFirst > myMask)
+        grow();
+
+    Slot &slot = mySlots[myEnd & myMask];
+    slot.stage = stage;
+    slot.leave = leave;
+    myEnd++;
+}
+
+
+void StageRing::grow()
+/* Doubles the slots, keeping the instructions held */
+{
+    vector<Slot> slots(2 * mySlots.size());
+    int mask = slots.size() - 1;
+    for (int k = myFirst; k < myEnd; k++)
+        slots[k & mask] = mySlots[k & myMask];
+    mySlots.swap(slots);
+    myMask = mask;
+}
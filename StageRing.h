@@ -0,0 +1,88 @@
+// aalok sathe
+#ifndef _STAGE_RING_H_
+#define _STAGE_RING_H_
+
+using namespace std;
+
+#include <vector>
+
+
+/* The stages in the pipeline in the order they appear in the datapath */
+enum PipelineStages{
+  FETCH,
+  DECODE,
+  EXECUTE,
+  MEMORY,
+  WRITEBACK,
+  NUM_STAGES
+};
+
+
+
+/* This class holds the instructions in the pipeline: the stage each one
+ * is in and the clock tick from which it may leave the stage it does its
+ * work in, in a ring indexed by instruction number. Instructions come into
+ * the pipeline in order, so the ones it holds are those from the first it
+ * still keeps up to the last that came in; the ones before have finished
+ * and the ones after have not come in yet. A finished instruction is only
+ * let go of when there is no room for one coming in, so the ring holds
+ * about as many instructions as fit in the pipeline, however long the
+ * program, and finding an instruction is an index into it.
+ */
+class StageRing{
+
+ public:
+
+  /* Creates an empty ring, with no instruction finished */
+  StageRing();
+
+  /* Empties the ring, with the instructions before first finished */
+  void reset(int first);
+
+  /* Returns whether instruction k has come into the pipeline */
+  bool contains(int k) { return k < myEnd; };
+
+  /* Returns one past the last instruction that came into the pipeline */
+  int getEnd() { return myEnd; };
+
+  /* Returns the stage of instruction k, which has come into the pipeline:
+   * NUM_STAGES once it has finished.
+   */
+  PipelineStages operator[](int k)
+    { return k < myFirst ? NUM_STAGES : mySlots[k & myMask].stage; };
+
+  /* Moves instruction k, which is in the pipeline, into stage */
+  void setStage(int k, PipelineStages stage) { mySlots[k & myMask].stage = stage; };
+
+  /* Returns and sets the clock tick from which instruction k, which is in
+   * the pipeline, may leave the stage it does its work in.
+   */
+  int getLeaveTime(int k) { return k < myFirst ? 0 : mySlots[k & myMask].leave; };
+  void setLeaveTime(int k, int time) { mySlots[k & myMask].leave = time; };
+
+  /* Brings the next instruction, getEnd(), into the pipeline in stage,
+   * free to leave it from clock tick leave.
+   */
+  void push(PipelineStages stage, int leave = 0);
+
+
+ private:
+
+  /* Doubles the slots, keeping the instructions held */
+  void grow();
+
+  struct Slot
+  {
+      PipelineStages stage;
+      int leave;
+  };
+
+  // the slot of instruction k is k & myMask; the slots are a power of two
+  vector<Slot> mySlots;
+  int myMask;
+  int myFirst;          // the first instruction held
+  int myEnd;            // one past the last instruction held
+
+};
+
+#endif
@@ -1,13 +1,37 @@
 // aalok sathe
 #include "StallPipeline.h"
 
-StallPipeline::StallPipeline(string inputFile)
-    : Pipeline(inputFile)
+StallPipeline::StallPipeline(string inputFile, SimOptions options)
+    : Pipeline(inputFile, options)
 /* Default constructor for the StallPipeline class.
  * Uses the inherited constructor, and only sets the header title
  * to something else. Additionally initializes appropriate ValueSchedule
  * items into a map according to the pipeline model.
  */
+{
+    initializeModel();
+}
+
+
+StallPipeline::StallPipeline(const vector<Instruction> &program, SimOptions options)
+    : Pipeline(program, options)
+/* Constructs the model with program, instructions already parsed, as
+ * Pipeline does.
+ */
+{
+    initializeModel();
+}
+
+
+StallPipeline::StallPipeline(StallPipeline *whole, int first)
+    : Pipeline(whole, first)
+/* Constructs a part of whole, as Pipeline does */
+{
+    initializeModel();
+}
+
+void StallPipeline::initializeModel()
+/* Sets up what this model adds to Pipeline, for the constructors */
 {
     myOutput.myPipelineType = "STALL";
     
@@ -49,8 +73,7 @@ bool StallPipeline::checkControlDelay(int i)
 {
     if (i > 0)
     {
-        Instruction prevInst = myInstructions.at(i-1);
-        InstFunc prevFunc = myOpcodes.getInstFunc(prevInst.getOpcode());
+        InstFunc prevFunc = myOpcodes.getInstFunc(getOpcode(i-1));
         if (prevFunc == CONTROL_I and myPipeline[i-1] == DECODE+1)
             return true;
     }
@@ -66,17 +89,15 @@ bool StallPipeline::checkStallDelay(int i)
  */
 {
     // get the current instruction, its function, and when its data is needed
-    Instruction curInst = myInstructions.at(i);
-    InstFunc curFunc = myOpcodes.getInstFunc(curInst.getOpcode());
+    InstFunc curFunc = myOpcodes.getInstFunc(getOpcode(i));
     PipelineStages reqd = myDataSchedule[curFunc].required;
 
     // see if there's any RAW dependency of this instruction on a prior instruction
     // and if so, check for potential data hazard stalls required. 
-    int prev = myDependencyChecker.getPrevDep(i, RAW);
+    int prev = getProducer(i);
     if (prev>=0 and myPipeline[i] == reqd)
     {
-        Instruction depInst = myInstructions.at(prev);
-        InstFunc depFunc = myOpcodes.getInstFunc(depInst.getOpcode());
+        InstFunc depFunc = myOpcodes.getInstFunc(getOpcode(prev));
         PipelineStages prod = myDataSchedule[depFunc].produced;
 
         // no delay if value is needed after it is produced
@@ -95,3 +116,13 @@ bool StallPipeline::checkStallDelay(int i)
 }
 
 
+int StallPipeline::getValueDelay(Opcode prev, Opcode curr, int latency)
+/* Given the opcodes of two instructions, prev and curr, where curr reads
+ * a value prev writes after latency clock ticks on its unit, returns the
+ * least number of clock ticks between them starting to execute. One less
+ * than in Pipeline, since the value can be read in the same clock tick it
+ * is written.
+ */
+{
+    return max(0, Pipeline::getValueDelay(prev, curr, latency) - 1);
+}
@@ -29,11 +29,40 @@ class StallPipeline: public Pipeline{
    * the name of a MIPS machine instruction file.  If the input file is
    * not a valid input file (due to syntactical errors or unsupported
    * instructions being specified), the format is considered incorrect.
+   * options are passed on to the Pipeline constructor.
    */
-  StallPipeline(string inputFile);
+  StallPipeline(string inputFile, SimOptions options = SimOptions());
+
+  /* Constructs the model with program, instructions already parsed, as
+   * Pipeline does.
+   */
+  StallPipeline(const vector<Instruction> &program, SimOptions options = SimOptions());
+
+  /* Returns a part of this model, as Pipeline::makePart does */
+  Pipeline *makePart(int first) { return new StallPipeline(this, first); };
+
+  /* Given the opcodes of two instructions, prev and curr, where curr reads
+   * a value prev writes after latency clock ticks on its unit, returns the
+   * least number of clock ticks between them starting to execute. One less
+   * than in Pipeline, since the value can be read in the same clock tick it
+   * is written.
+   */
+  int getValueDelay(Opcode prev, Opcode curr, int latency);
+  using Pipeline::getValueDelay;
+
+  /* Returns the number of clock ticks the instruction after a control
+   * instruction is held back by: one, as checkControlDelay stalls it once.
+   */
+  int getControlDelay() { return 1; };
 
 
  private:
+
+ /* Constructs a part of whole, as Pipeline does */
+  StallPipeline(StallPipeline *whole, int first);
+
+ /* Sets up what this model adds to Pipeline, for the constructors */
+  void initializeModel();
  
  /* Although Pipeline::checkHazards is virtual, reuse it here since no
   * modiciation is necessary for this pipeline model
@@ -46,7 +75,7 @@ class StallPipeline: public Pipeline{
   * then add one more stall cycle. return if stall is needed (true) or not (false)
   */
   bool checkControlDelay(int i);
-  
+
 
  /* check if a data hazard-related stall exists. return if stall is needed (true)
   * or not (false)
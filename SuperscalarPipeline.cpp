@@ -0,0 +1,130 @@
+// aalok sathe
+#include "SuperscalarPipeline.h"
+
+SuperscalarPipeline::SuperscalarPipeline(string inputFile, SimOptions options)
+    : DataForwardPipeline(inputFile, options)
+/* Default constructor for the SuperscalarPipeline class.
+ * Uses the inherited constructor, which sets up the data forwarding
+ * ValueSchedule items, and only sets the header title and the number of
+ * instructions that move through each stage together.
+ */
+{
+    initializeModel();
+}
+
+
+SuperscalarPipeline::SuperscalarPipeline(const vector<Instruction> &program, SimOptions options)
+    : DataForwardPipeline(program, options)
+/* Constructs the model with program, instructions already parsed, as
+ * Pipeline does.
+ */
+{
+    initializeModel();
+}
+
+
+SuperscalarPipeline::SuperscalarPipeline(SuperscalarPipeline *whole, int first)
+    : DataForwardPipeline(whole, first)
+/* Constructs a part of whole, as Pipeline does */
+{
+    initializeModel();
+}
+
+void SuperscalarPipeline::initializeModel()
+/* Sets up what this model adds to Pipeline, for the constructors */
+{
+    myOutput.myPipelineType = "SUPERSCALAR";
+    myWidth = max(1, myOptions.issueWidth);
+    myPairingStalls.assign(getNumInstructions() - myFirst, false);
+}
+
+
+bool SuperscalarPipeline::checkPairing(int i)
+/* Given the index of an instruction, i, that is about to move into the
+ * same stage as the instructions right before it, determine if a pairing
+ * rule keeps it out of their group. returns whether it must wait.
+ */
+{
+    InstFunc curFunc = myOpcodes.getInstFunc(getOpcode(i));
+    PipelineStages stage = myPipeline[i-1];
+
+    // compare against every instruction of the group ahead
+    for (int k = i-1; k >= 0 and myPipeline[k] == stage; k--)
+    {
+        InstFunc func = myOpcodes.getInstFunc(getOpcode(k));
+
+        // there is no branch prediction, so a control instruction is
+        // always the last of its group; only one memory unit exists; and
+        // values cannot be forwarded between instructions of one group
+        if ((k == i-1 and func == CONTROL_I)
+            or (func == MEMORY_I and curFunc == MEMORY_I)
+            or hasDependence(k, i, RAW)
+            or hasDependence(k, i, WAW))
+        {
+            myPairingStalls[i - myFirst] = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void SuperscalarPipeline::printStatistics()
+/* Prints the issue width, how many instructions were kept out of a group
+ * by the pairing rules, and the achieved IPC, after the statistics of the
+ * in-order models.
+ */
+{
+    int held = 0;
+    for (unsigned int i = 0; i < myPairingStalls.size(); i++)
+        if (myPairingStalls[i])
+            held++;
+
+    Pipeline::printStatistics();
+    cout << "Issue width " << myWidth << endl;
+    cout << "Instructions held back by pairing rules: " << held << endl;
+    cout << "IPC is " << getIPC() << endl;
+}
+
+
+void SuperscalarPipeline::setInstructions(const vector<Instruction> &program,
+                                          const vector<int> &pcs)
+/* Replaces the instructions to simulate, as Pipeline does, and clears
+ * which of them pairing rules held back.
+ */
+{
+    Pipeline::setInstructions(program, pcs);
+    myPairingStalls.assign(getNumInstructions(), false);
+}
+
+
+int SuperscalarPipeline::getInstructionRecord(int k)
+/* Returns whether pairing rules held instruction k back, above what
+ * Pipeline records for it.
+ */
+{
+    return (Pipeline::getInstructionRecord(k) << 1) | (myPairingStalls[k - myFirst] ? 1 : 0);
+}
+
+
+void SuperscalarPipeline::setInstructionRecord(int k, int record)
+/* Sets whether pairing rules held instruction k back, above what Pipeline
+ * records for it.
+ */
+{
+    myPairingStalls[k - myFirst] = (record & 1);
+    Pipeline::setInstructionRecord(k, record >> 1);
+}
+
+
+void SuperscalarPipeline::spliceRecords(int first, int removed, int added)
+/* Moves whether pairing rules held each instruction back along with what
+ * Pipeline records, when instructions are replaced.
+ */
+{
+    myPairingStalls.erase(myPairingStalls.begin() + first,
+                          myPairingStalls.begin() + first + removed);
+    myPairingStalls.insert(myPairingStalls.begin() + first, added, false);
+    Pipeline::spliceRecords(first, removed, added);
+}
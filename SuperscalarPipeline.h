@@ -0,0 +1,80 @@
+// aalok sathe
+#ifndef _SUPERSCALAR_PIPELINE_H_
+#define _SUPERSCALAR_PIPELINE_H_
+
+#include "DataForwardPipeline.h"
+
+
+/* This class simulates an in-order superscalar pipeline with full data
+ * forwarding. Up to the issue width of instructions move through each stage
+ * together as a group, and each of them is held to the same RAW and control
+ * rules as in the DataForwardPipeline. An instruction may not join the group
+ * ahead of it if it depends (RAW or WAW) on an instruction in that group, if
+ * it is a memory instruction and the group already has one, or if the group
+ * ends with a control instruction.
+ */
+class SuperscalarPipeline: public DataForwardPipeline{
+
+
+ public:
+
+  /* The constructor is passed either the name of a MIPS assembly file or
+   * the name of a MIPS machine instruction file.  If the input file is
+   * not a valid input file (due to syntactical errors or unsupported
+   * instructions being specified), the format is considered incorrect.
+   * options give the issue width, and are passed on to the Pipeline
+   * constructor.
+   */
+  SuperscalarPipeline(string inputFile, SimOptions options = SimOptions());
+
+  /* Constructs the model with program, instructions already parsed, as
+   * Pipeline does.
+   */
+  SuperscalarPipeline(const vector<Instruction> &program, SimOptions options = SimOptions());
+
+  /* Returns a part of this model, as Pipeline::makePart does */
+  Pipeline *makePart(int first) { return new SuperscalarPipeline(this, first); };
+
+  /* Replaces the instructions to simulate, as Pipeline does, and clears
+   * which of them pairing rules held back.
+   */
+  void setInstructions(const vector<Instruction> &program,
+                       const vector<int> &pcs);
+
+
+ private:
+
+ /* Constructs a part of whole, as Pipeline does */
+  SuperscalarPipeline(SuperscalarPipeline *whole, int first);
+
+ /* Sets up what this model adds to Pipeline, for the constructors */
+  void initializeModel();
+
+ /* Given the index of an instruction, i, that is about to move into the
+  * same stage as the instructions right before it, determine if a pairing
+  * rule keeps it out of their group. returns whether it must wait.
+  */
+  bool checkPairing(int i);
+
+ /* Prints the issue width, how many instructions were kept out of a group
+  * by the pairing rules, and the achieved IPC.
+  */
+  void printStatistics();
+
+ /* Return and set whether pairing rules held instruction k back, above
+  * what Pipeline records for it.
+  */
+  int getInstructionRecord(int k);
+  void setInstructionRecord(int k, int record);
+
+ /* Moves whether pairing rules held each instruction back along with what
+  * Pipeline records, when instructions are replaced.
+  */
+  void spliceRecords(int first, int removed, int added);
+
+  // marks the instructions the pairing rules kept out of a group at least once
+  vector<bool> myPairingStalls;
+
+};
+
+#endif
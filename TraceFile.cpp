@@ -0,0 +1,393 @@
+// aalok sathe
+#include "TraceFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+TraceFile::TraceFile()
+/* Creates an empty trace, to read one into */
+{
+    mySize = 0;
+}
+
+
+TraceFile::TraceFile(const vector<Instruction> &program, const vector<int> &pcs,
+                     DependencyChecker &checker)
+/* Creates the trace of the instructions at indices pcs of program, with
+ * the dependences checker found in them.
+ */
+{
+    mySize = 0;
+    myProgram = program;
+    myPcs = pcs;
+    for (unsigned int k = 0; k < pcs.size(); k++)
+    {
+        vector<Dependence> deps = checker.getInstructionDependences(k);
+        myDependences.insert(myDependences.end(), deps.begin(), deps.end());
+    }
+}
+
+
+bool TraceFile::write(string file)
+/* Writes the trace to file. Returns false if it could not be written. */
+{
+    vector<unsigned char> data, block;
+
+    // the header: each instruction of the program that was run, as its
+    // encoding and kind, with its distance from the one before and whether
+    // its assembly follows in the same number. the fields and assembly are
+    // decoded from the encoding again, so the assembly is only kept where
+    // decoding does not give it back
+    vector<bool> run(myProgram.size(), false);
+    for (unsigned int k = 0; k < myPcs.size(); k++)
+        run[myPcs[k]] = true;
+    int count = 0;
+    for (unsigned int pc = 0; pc < run.size(); pc++)
+        if (run[pc])
+            count++;
+
+    Checkpoint header;
+    header.putString("PIPESIM trace");
+    header.putInt(3);
+    header.putInt(count);
+    int previous = -1;
+    for (unsigned int pc = 0; pc < run.size(); pc++)
+    {
+        if (not run[pc])
+            continue;
+        Instruction &i = myProgram[pc];
+        uint32_t word = (uint32_t)strtoul(i.getEncoding().c_str(), NULL, 2);
+        Instruction decoded;
+        bool same = (myDecoder.decodeWord(word, decoded)
+                     and decoded.getAssembly() == i.getAssembly());
+        InstFunc func = myOpcodes.getInstFunc(i.getOpcode());
+        header.putInt(((int64_t)(pc - previous - 1) * FUNCS + func) * 2 + not same);
+        header.putWord(word);
+        if (not same)
+            header.putString(i.getAssembly());
+        previous = pc;
+    }
+    header.putInt(myPcs.size());
+    header.seal(block);
+    data.insert(data.end(), block.begin(), block.end());
+
+    // the run, a chunk at a time, noting the last access to each register
+    // before each chunk: as the distance back to it, twice over and one
+    // more for a write, or 0 if there is none
+    int n = myPcs.size();
+    unsigned int dependence = 0;
+    myChunks.clear();
+    vector<RegisterInfo> state(DependencyChecker::HI_REGISTER + 1);
+    vector<int64_t> snapshots;
+    vector<pair<unsigned int, AccessType> > accesses;
+    for (int first = 0; first < n; first += CHUNK)
+    {
+        myChunks.push_back(data.size());
+        Checkpoint chunk;
+        int end = min(n, first + CHUNK);
+        if (not putChunk(chunk, first, end, dependence))
+            return false;
+        chunk.seal(block);
+        data.insert(data.end(), block.begin(), block.end());
+
+        for (unsigned int reg = 0; reg < state.size(); reg++)
+            snapshots.push_back(state[reg].accessType == A_UNDEFINED ? 0
+                : (int64_t)(first - state[reg].lastInstructionToAccess) * 2
+                  + (state[reg].accessType == WRITE));
+        for (int k = first; k < end; k++)
+        {
+            accesses.clear();
+            myChecker.getAccesses(myProgram[myPcs[k]], accesses);
+            for (unsigned int a = 0; a < accesses.size(); a++)
+            {
+                state[accesses[a].first].lastInstructionToAccess = k;
+                state[accesses[a].first].accessType = accesses[a].second;
+            }
+        }
+    }
+
+    // the index, and where it is
+    uint64_t place = data.size();
+    Checkpoint index;
+    index.putInt(myChunks.size());
+    for (unsigned int c = 0; c < myChunks.size(); c++)
+    {
+        index.putInt(myChunks[c]);
+        for (unsigned int reg = 0; reg < state.size(); reg++)
+            index.putInt(snapshots[c * state.size() + reg]);
+    }
+    index.seal(block);
+    data.insert(data.end(), block.begin(), block.end());
+    for (int b = 0; b < 8; b++)
+        data.push_back((unsigned char)(place >> (8*b)));
+
+    // written under a name of this process's own and then renamed, so
+    // that a reader never sees half a trace, even one written at the same
+    // time by another run
+    char suffix[32];
+    sprintf(suffix, ".tmp%d", (int)getpid());
+    string temporary = file + suffix;
+    FILE *out = fopen(temporary.c_str(), "wb");
+    if (out == NULL)
+        return false;
+    bool written = (fwrite(&data[0], 1, data.size(), out) == data.size());
+    written = (fclose(out) == 0) and written;
+    if (written)
+        written = (rename(temporary.c_str(), file.c_str()) == 0);
+    else
+        remove(temporary.c_str());
+    mySize = data.size();
+    return written;
+}
+
+
+bool TraceFile::read(string file, int from, int to)
+/* Replaces the trace with the one in file, or with to not negative only
+ * its instructions from from up to to, numbered from from, and their
+ * dependences on each other; only the chunks that hold them are read.
+ * Returns false if the file cannot be read, is not a trace or is damaged.
+ */
+{
+    myProgram.clear();
+    myPcs.clear();
+    myDependences.clear();
+    myChunks.clear();
+    myState.assign(DependencyChecker::HI_REGISTER + 1, RegisterInfo());
+    mySize = 0;
+
+    FILE *in = fopen(file.c_str(), "rb");
+    if (in == NULL)
+        return false;
+    bool found = readParts(in, from, to);
+    fclose(in);
+    return found;
+}
+
+
+bool TraceFile::readParts(FILE *in, int from, int to)
+/* Reads the index, the header and the chunks that hold the instructions
+ * from from up to to (all of them if to is negative) from in.
+ */
+{
+    // the index first, to find the header and chunks
+    vector<unsigned char> data;
+    if (fseek(in, 0, SEEK_END) != 0)
+        return false;
+    long size = ftell(in);
+    mySize = size;
+    if (size < 8 or not readBytes(in, size - 8, 8, data))
+        return false;
+    int64_t place = 0;
+    for (int b = 0; b < 8; b++)
+        place |= (int64_t)data[b] << (8*b);
+    Checkpoint index;
+    if (place < 0 or place > size - 8 or not readBytes(in, place, size - 8 - place, data)
+        or not index.load(data, 0, data.size()))
+        return false;
+    // with the last accesses before each chunk
+    int64_t chunks = index.getInt();
+    if (chunks < 0 or chunks > size)
+        return false;
+    vector<int64_t> snapshots;
+    for (int64_t c = 0; c < chunks; c++)
+    {
+        int64_t start = index.getInt();
+        if (start < (c == 0 ? 0 : myChunks.back()) or start > place)
+            return false;
+        myChunks.push_back(start);
+        for (unsigned int reg = 0; reg < myState.size(); reg++)
+            snapshots.push_back(index.getInt());
+    }
+    if (not index.isValid())
+        return false;
+    myChunks.push_back(place);
+
+    // the header, up to the first chunk
+    Checkpoint header;
+    if (not readBytes(in, 0, myChunks[0], data) or not header.load(data, 0, data.size())
+        or header.getString() != "PIPESIM trace" or header.getInt() != 3)
+        return false;
+    // the instructions, decoded from their words into their places in the
+    // program; each must be of the kind stored
+    int64_t count = header.getInt();
+    if (count < 0 or count > size)
+        return false;
+    int64_t pc = -1;
+    Instruction decoded;
+    for (int64_t k = 0; k < count and header.isValid(); k++)
+    {
+        int64_t place = header.getInt();
+        if (place < 0)
+            return false;
+        pc += place / 2 / FUNCS + 1;
+        if (not myDecoder.decodeWord(header.getWord(), decoded)
+            or myOpcodes.getInstFunc(decoded.getOpcode()) != place / 2 % FUNCS)
+            return false;
+        if (place % 2)
+            decoded.setAssembly(header.getString());
+        myProgram.resize(pc + 1);
+        myProgram[pc] = decoded;
+    }
+    int64_t n = header.getInt();
+    if (not header.isValid() or n < 0 or (n + CHUNK - 1) / CHUNK != chunks)
+        return false;
+
+    // the chunks of the run that hold the instructions asked for
+    if (to < 0 or to > n)
+        to = n;
+    from = max(0, min(from, to));
+    myPcs.reserve(to - from);
+
+    // the state before the first of them starts from the nearest snapshot
+    // and is followed through the instructions in between
+    int64_t seeded = from / CHUNK;
+    for (unsigned int reg = 0; seeded < chunks and reg < myState.size(); reg++)
+    {
+        int64_t code = snapshots[seeded * myState.size() + reg];
+        if (code <= 0)
+            continue;
+        if (code / 2 > seeded * CHUNK)
+            return false;
+        myState[reg].lastInstructionToAccess = seeded * CHUNK - code / 2;
+        myState[reg].accessType = (code % 2) ? WRITE : READ;
+    }
+    for (int c = from / CHUNK; c < chunks and c * CHUNK < to; c++)
+    {
+        Checkpoint chunk;
+        if (not readBytes(in, myChunks[c], myChunks[c+1] - myChunks[c], data)
+            or not chunk.load(data, 0, data.size())
+            or not getChunk(chunk, c * CHUNK, min(n, (int64_t)(c + 1) * CHUNK), from, to))
+            return false;
+    }
+    myChunks.pop_back();
+
+    // numbered from the first instruction read
+    for (unsigned int reg = 0; reg < myState.size(); reg++)
+        if (myState[reg].accessType != A_UNDEFINED)
+            myState[reg].lastInstructionToAccess -= from;
+    return true;
+}
+
+
+bool TraceFile::readBytes(FILE *in, long start, long length, vector<unsigned char> &data)
+/* Reads the length bytes of in from start into data. Returns false if
+ * there are not that many.
+ */
+{
+    data.resize(length);
+    return fseek(in, start, SEEK_SET) == 0
+           and (length == 0 or fread(&data[0], 1, length, in) == (size_t)length);
+}
+
+
+bool TraceFile::putChunk(Checkpoint &checkpoint, int first, int end,
+                         unsigned int &dependence)
+/* Appends the instructions of the run from first up to end, as a chunk,
+ * to checkpoint, with their dependences from myDependences[dependence]
+ * on, moving dependence past them. Returns false if a dependence is not
+ * made by one of its instruction's register accesses.
+ */
+{
+    checkpoint.putInt(first);
+    for (int k = first; k < end; k++)
+    {
+        // the first instruction of a chunk gives its index in full, so
+        // that the chunk can be read on its own; the number of its
+        // dependences goes in the same number
+        unsigned int last = dependence;
+        while (last < myDependences.size()
+               and myDependences[last].currentInstructionNumber == k)
+            last++;
+        if (last - dependence >= (unsigned int)ACCESSES)
+            return false;
+        int64_t delta = myPcs[k] - (k == first ? -1 : myPcs[k-1]) - 1;
+        checkpoint.putInt(delta * ACCESSES + (last - dependence));
+
+        // each dependence is made by one of the instruction's accesses,
+        // which gives its register and whether it is read after write; a
+        // write only has to tell write after read from write after write.
+        // with its distance, a close one takes a byte
+        Instruction &inst = myProgram[myPcs[k]];
+        for (; dependence < last; dependence++)
+        {
+            Dependence &d = myDependences[dependence];
+            int access = getAccess(inst, d);
+            if (access < 0)
+                return false;
+            checkpoint.putInt(((int64_t)(k - d.previousInstructionNumber) * ACCESSES + access) * 2
+                              + (d.dependenceType == WAW));
+        }
+    }
+    return true;
+}
+
+
+bool TraceFile::getChunk(Checkpoint &chunk, int first, int end, int from, int to)
+/* Reads the instructions of the run from first up to end from chunk,
+ * keeping those from from up to to and their dependences, and following
+ * the accesses of the ones before from in myState. Returns false if it
+ * does not hold them.
+ */
+{
+    if (chunk.getInt() != first)
+        return false;
+    int pc = -1;
+    vector<pair<unsigned int, AccessType> > accesses;
+    for (int k = first; k < end; k++)
+    {
+        // a jump back makes the difference negative, so the number of
+        // dependences is what is left over from the next lower multiple
+        int64_t place = chunk.getInt();
+        int count = (place % ACCESSES + ACCESSES) % ACCESSES;
+        pc += (place - count) / ACCESSES + 1;
+        if (pc < 0 or pc >= (int)myProgram.size() or myProgram[pc].getOpcode() == UNDEFINED)
+            return false;
+        bool kept = (k >= from and k < to);
+        if (kept)
+            myPcs.push_back(pc);
+
+        accesses.clear();
+        if (count > 0 or k < from)
+            myChecker.getAccesses(myProgram[pc], accesses);
+        for (unsigned int a = 0; k < from and a < accesses.size(); a++)
+        {
+            myState[accesses[a].first].lastInstructionToAccess = k;
+            myState[accesses[a].first].accessType = accesses[a].second;
+        }
+        for (int e = 0; e < count and chunk.isValid(); e++)
+        {
+            int64_t code = chunk.getInt();
+            int64_t distance = code / 2 / ACCESSES;
+            unsigned int access = code / 2 % ACCESSES;
+            if (code < 0 or access >= accesses.size() or distance < 0 or distance > k)
+                return false;
+            Dependence d;
+            d.registerNumber = accesses[access].first;
+            if (accesses[access].second == READ)
+                d.dependenceType = RAW;
+            else
+                d.dependenceType = (code % 2) ? WAW : WAR;
+            d.previousInstructionNumber = k - distance - from;
+            d.currentInstructionNumber = k - from;
+            if (kept)
+                myDependences.push_back(d);
+        }
+    }
+    return chunk.isValid() and chunk.isAtEnd();
+}
+
+
+int TraceFile::getAccess(Instruction &inst, const Dependence &d)
+/* Returns which of inst's register accesses, in the order
+ * DependencyChecker lists them, dependence d is made by, or -1 if none.
+ */
+{
+    vector<pair<unsigned int, AccessType> > accesses;
+    myChecker.getAccesses(inst, accesses);
+    AccessType type = (d.dependenceType == RAW) ? READ : WRITE;
+    for (unsigned int a = 0; a < accesses.size(); a++)
+        if (accesses[a].first == d.registerNumber and accesses[a].second == type)
+            return a;
+    return -1;
+}
+
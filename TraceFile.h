@@ -0,0 +1,138 @@
+// aalok sathe
+#ifndef _TRACE_FILE_H_
+#define _TRACE_FILE_H_
+
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "Instruction.h"
+#include "DependencyChecker.h"
+#include "Checkpoint.h"
+#include "MachLangParser.h"
+
+
+/* This class holds the instructions a model simulates, decoded and with
+ * their dependences, in a compact file that can be simulated again without
+ * parsing, executing or checking them. The file holds each instruction of
+ * the program once, as its encoding packed into a word and its kind
+ * (InstFunc), from which its fields and assembly text are decoded again
+ * straight from the bits; only text the decoding does not give back, such
+ * as labels, is kept too.
+ * Then the run, in chunks of CHUNK instructions, as the difference of each
+ * instruction's index in the program from the one after the last (0 in
+ * straight-line code) and its dependences, each as which of the
+ * instruction's register accesses makes it, its kind and its distance back
+ * to the instruction it depends on; then an index of where each chunk starts
+ * and the last access to each register before it, whose own place is in
+ * the last eight bytes. Numbers are stored as
+ * Checkpoint does, and the header, each chunk and the index are sealed
+ * with a checksum of their own, so a chunk can be read, and checked, on
+ * its own.
+ */
+class TraceFile{
+
+ public:
+
+  /* Creates an empty trace, to read one into */
+  TraceFile();
+
+  /* Creates the trace of the instructions at indices pcs of program, with
+   * the dependences checker found in them.
+   */
+  TraceFile(const vector<Instruction> &program, const vector<int> &pcs,
+            DependencyChecker &checker);
+
+  /* Writes the trace to file. Returns false if it could not be written. */
+  bool write(string file);
+
+  /* Replaces the trace with the one in file, or with to not negative only
+   * its instructions from from up to to, numbered from from, and their
+   * dependences, which reach before from (below 0) if the instructions
+   * depend on earlier ones; only the chunks that hold them are read.
+   * Returns false if the file cannot be read, is not a trace or is damaged.
+   */
+  bool read(string file, int from = 0, int to = -1);
+
+  /* Returns the index in the program of each instruction of the run */
+  const vector<int> &getPcs() { return myPcs; };
+
+  /* Returns the program, indexed by pc; the instructions that were not
+   * run are left UNDEFINED.
+   */
+  const vector<Instruction> &getProgram() { return myProgram; };
+
+  /* Returns the dependences of the run, in the order they were found */
+  const vector<Dependence> &getDependences() { return myDependences; };
+
+  /* Returns the last access to each register before the first instruction
+   * read, numbered from it (so below 0), to seed a DependencyChecker with.
+   */
+  const vector<RegisterInfo> &getRegisterState() { return myState; };
+
+  /* Returns the number of chunks the run is stored in */
+  int getChunkCount() { return myChunks.size(); };
+
+  /* Returns the size of the file last written or read, in bytes; only
+   * part of it may have been read.
+   */
+  long getSize() { return mySize; };
+
+
+ private:
+
+  /* Appends the instructions of the run from first up to end, as a chunk,
+   * to checkpoint, with their dependences from myDependences[dependence]
+   * on, moving dependence past them. Returns false if a dependence is not
+   * made by one of its instruction's register accesses.
+   */
+  bool putChunk(Checkpoint &checkpoint, int first, int end, unsigned int &dependence);
+
+  /* Reads the index, the header and the chunks that hold the instructions
+   * from from up to to (all of them if to is negative) from in.
+   */
+  bool readParts(FILE *in, int from, int to);
+
+  /* Reads the length bytes of in from start into data. Returns false if
+   * there are not that many.
+   */
+  static bool readBytes(FILE *in, long start, long length, vector<unsigned char> &data);
+
+  /* Reads the instructions of the run from first up to end from chunk,
+   * keeping those from from up to to and their dependences, and following
+   * the accesses of the ones before from in myState. Returns false if it
+   * does not hold them.
+   */
+  bool getChunk(Checkpoint &chunk, int first, int end, int from, int to);
+
+  /* Returns which of inst's register accesses, in the order
+   * DependencyChecker lists them, dependence d is made by, or -1 if none.
+   */
+  int getAccess(Instruction &inst, const Dependence &d);
+
+  // instructions of the run stored in each chunk
+  static const int CHUNK = 1 << 16;
+
+  // kinds of instruction, by which the distance between instructions of
+  // the program is multiplied to store both in one number
+  static const int FUNCS = CONTROL_I + 1;
+
+  // register accesses an instruction makes at most, and so dependences it
+  // has at most, by which numbers stored with them are multiplied
+  static const int ACCESSES = 4;
+
+  vector<Instruction> myProgram;      // indexed by pc
+  vector<int> myPcs;
+  vector<Dependence> myDependences;
+  vector<long> myChunks;               // where each chunk starts in the file
+  vector<RegisterInfo> myState;        // the last accesses before the first
+  long mySize;
+
+  OpcodeTable myOpcodes;
+  DependencyChecker myChecker;        // lists the registers each accesses
+  MachLangParser myDecoder;           // decodes the encoding words
+
+};
+
+#endif
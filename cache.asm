@@ -0,0 +1,10 @@
+addi $1, $0, 8
+addi $2, $0, 0
+loop:
+lw $3, 0($2)
+addi $2, $2, 4
+addi $1, $1, -1
+beq $1, $0, done
+j loop
+done: lw $4, 0($0)
+lw $5, 32($0)
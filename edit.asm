@@ -0,0 +1,22 @@
+addi $1, $0, 300
+addi $2, $0, 12345
+addi $9, $0, 30000
+loop: mult $2, $9
+mfhi $3
+addi $9, $9, 1
+add $2, $2, $3
+add $2, $2, $1
+srl $4, $2, 7
+srl $5, $4, 1
+add $5, $4, $3
+sub $6, $4, $5
+beq $6, $0, even
+add $7, $7, $4
+sub $8, $8, $6
+j next
+even: addi $8, $8, 1
+sra $7, $7, 1
+next: addi $1, $1, -1
+beq $1, $0, done
+j loop
+done: add $10, $7, $8
@@ -0,0 +1,15 @@
+sub $9, $5, $5
+mult $5, $3
+sra $3, $5, 2
+beq $3, $0, skip
+add $7, $4, $9
+mfhi $6
+slti $8, $4, 7
+add $6, $8, $6
+add $7, $6, $9
+addi $1, $6, 1
+addi $2, $1, 1
+addi $3, $2, 1
+addi $4, $3, 1
+skip:
+addi $2, $7, 1
@@ -0,0 +1,8 @@
+addi $1, $0, 3
+addi $2, $0, 0
+loop:
+addi $2, $2, 5
+addi $1, $1, -1
+beq $1, $0, done
+j loop
+done: lw $3, 4($2)
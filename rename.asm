@@ -0,0 +1,9 @@
+j label
+lw $4, 0($1)
+add $3, $4, $8
+addi $5, $2, 100
+mult $2, $3
+mfhi $6
+sra $3, $2, 10
+slti $7, $3, 1023
+lw $1, 100($3)
@@ -0,0 +1,9 @@
+addi $1, $0, 30
+loop:
+lw $2, 0($3)
+add $4, $2, $4
+addi $3, $3, 4
+addi $1, $1, -1
+beq $1, $0, done
+j loop
+done: add $5, $4, $0
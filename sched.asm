@@ -0,0 +1,9 @@
+j label
+lw $4, 0($1)
+addi $1, $2, 100
+add $3, $4, $8
+mult $2, $3
+sra $3, $2, 10
+mfhi $1
+slti $1, $3, 1023
+lw $1, 100($3)